@@ -0,0 +1,166 @@
+/**
+ *@file aec.h
+ *
+ *@brief
+ *  - acoustic echo canceller on the capture path: the far end played
+ *    by audio TX is picked up again by the microphone, an adaptive
+ *    FIR estimate of the echo is subtracted before the chunk is coded
+ *
+ *  Normalized LMS, fixed point: Q15 samples, Q30 32 bit taps (the
+ *  filter uses their upper 16 bits). The chunk is processed in blocks
+ *  of AEC_BLOCK samples, per block
+ *  - the far end window is fetched from the reference ring, aligned to
+ *    the capture time of the block (see aec_process)
+ *  - Geigel double talk detection: near end talk if the microphone
+ *    peak reaches half the far end peak over the taps; adaptation
+ *    stops for AEC_HANGOVER blocks, the echo is still subtracted
+ *  - the step size is normalized by the far end energy once
+ *  - no far end (peak under AEC_FAR_MIN): nothing to cancel, the
+ *    block passes untouched
+ *
+ *  The far end reference is written by audio TX for every chunk put,
+ *  at the absolute sample position it is played at. Frame times
+ *  audio TX conceals have no reference (zeros).
+ *
+ *  Budget: AEC_CYCLES_PER_SAMPLE, a 20 ms chunk (160 samples) gets
+ *  240000 cycles, 2 % of the core at 600 MHz. tools/aecbench checks
+ *  convergence and cost on recorded or generated echo scenarios.
+ *
+ * Target:   TLL6527v1-0
+ * Compiler: VDSP++     Output format: VDSP++ "*.dxe"
+ *
+ *******************************************************************************/
+#ifndef _AEC_H_
+#define _AEC_H_
+
+#include "chunk.h"
+
+/***************************************************
+            DEFINES
+***************************************************/
+/**
+ * @def AEC_TAPS
+ * @brief filter length, echo tail covered (32 ms at 8 kHz), even
+ */
+#define AEC_TAPS	(256)
+
+/**
+ * @def AEC_BLOCK
+ * @brief samples per block: double talk decision and step size
+ */
+#define AEC_BLOCK	(16)
+
+/**
+ * @def AEC_REF_SIZE
+ * @brief far end reference ring [samples], power of 2; covers the
+ * chunks queued in audio TX plus the captured chunk and the taps
+ */
+#define AEC_REF_SIZE	(8192)
+
+/**
+ * @def AEC_DELAY
+ * @brief bulk delay from playback to capture ahead of the first tap
+ * [samples], DAC + ADC; 0 leaves it to the taps
+ */
+#define AEC_DELAY	(0)
+
+/**
+ * @def AEC_MU
+ * @brief NLMS step size, Q15 (0.5)
+ */
+#define AEC_MU	(16384)
+
+/**
+ * @def AEC_FAR_MIN
+ * @brief far end peak under which there is no echo to cancel (-54 dBFS)
+ */
+#define AEC_FAR_MIN	(64)
+
+/**
+ * @def AEC_HANGOVER
+ * @brief blocks adaptation stays off after double talk (30 ms)
+ */
+#define AEC_HANGOVER	(15)
+
+/**
+ * @def AEC_CYCLES_PER_SAMPLE
+ * @brief cycle budget of aec_process per sample
+ */
+#define AEC_CYCLES_PER_SAMPLE	(1500)
+
+
+/***************************************************
+            DATA TYPES
+***************************************************/
+
+/** statistics since the last aec_report
+ */
+typedef struct {
+  unsigned int        blocks;     /* blocks processed */
+  unsigned int        farIdle;    /* no far end, passed untouched */
+  unsigned int        doubleTalk; /* adaptation held by the detector */
+  unsigned long long  micEnergy;  /* adapted blocks: microphone, x*x >> 8 */
+  unsigned long long  errEnergy;  /* adapted blocks: echo left */
+} aec_stats_t;
+
+/** echo canceller object
+ */
+typedef struct {
+  int            w[AEC_TAPS];     /* echo path estimate, Q30, oldest tap first */
+  short          x[AEC_TAPS + AEC_BLOCK]; /* far end of the block and the taps, oldest first */
+  short          ref[AEC_REF_SIZE]; /* far end by absolute sample position */
+  unsigned int   refEnd;          /* position after the last sample written */
+  int            hangover;        /* blocks left without adaptation */
+  aec_stats_t    stats;
+} aec_t;
+
+
+/***************************************************
+            Access Methods
+***************************************************/
+
+/** Initialize the echo canceller, no echo path known yet
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int aec_init(aec_t *pThis);
+
+/** far end reference, the samples of a chunk put for playback
+ *   the positions skipped since the last chunk are silence
+ *
+ * Parameters:
+ * @param pThis  pointer to own object, nothing done if NULL
+ * @param pChunk  chunk of 16 bit PCM
+ * @param pos  absolute sample position its first sample plays at
+ *
+ * @return void
+ */
+void aec_reference(aec_t *pThis, chunk_t *pChunk, unsigned int pos);
+
+/** cancel the echo in a captured chunk, in place
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pChunk  chunk of 16 bit PCM
+ * @param pos  far end position playing when its first sample was
+ *             captured (see audioTx_position)
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int aec_process(aec_t *pThis, chunk_t *pChunk, unsigned int pos);
+
+/** print the statistics since the last report, then restart them
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return void
+ */
+void aec_report(aec_t *pThis);
+
+#endif
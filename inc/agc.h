@@ -0,0 +1,145 @@
+/**
+ *@file agc.h
+ *
+ *@brief
+ *  - automatic gain control of the transmit path with noise gate
+ *
+ *  Per block of AGC_BLOCK samples the peak is taken into a level
+ *  envelope: up at the attack rate, down at the release rate. The gain
+ *  aimed at brings the envelope to the target level, within the
+ *  limits; the block peak itself never goes over full scale. With the
+ *  envelope under the gate threshold the gate closes, the gain goes
+ *  to the gate gain instead. The gain ramps linearly from one block
+ *  to the next, per sample that is one multiply.
+ *
+ * Target:   TLL6527v1-0
+ * Compiler: VDSP++     Output format: VDSP++ "*.dxe"
+ *
+ *******************************************************************************/
+#ifndef _AGC_H_
+#define _AGC_H_
+
+#include "chunk.h"
+
+/***************************************************
+            DEFINES
+***************************************************/
+/**
+ * @def AGC_BLOCK
+ * @brief samples per gain step (2 ms)
+ */
+#define AGC_BLOCK	(16)
+
+/**
+ * @def AGC_UNITY
+ * @brief gain 1.0, gains are Q12 (up to 8, +18 dB)
+ */
+#define AGC_UNITY	(4096)
+
+/**
+ * @def AGC_TARGET_DEFAULT
+ * @brief level aimed at, peak envelope (-12 dBFS)
+ */
+#define AGC_TARGET_DEFAULT	(8192)
+
+/**
+ * @def AGC_GAIN_MAX_DEFAULT
+ * @brief largest gain, Q12 (+18 dB)
+ */
+#define AGC_GAIN_MAX_DEFAULT	(32767)
+
+/**
+ * @def AGC_GAIN_MIN_DEFAULT
+ * @brief smallest gain, Q12 (-12 dB)
+ */
+#define AGC_GAIN_MIN_DEFAULT	(1024)
+
+/**
+ * @def AGC_GATE_DEFAULT
+ * @brief envelope under which the gate closes (-42 dBFS)
+ */
+#define AGC_GATE_DEFAULT	(256)
+
+/**
+ * @def AGC_GATE_GAIN_DEFAULT
+ * @brief gain with the gate closed, Q12 (-6 dB)
+ */
+#define AGC_GATE_GAIN_DEFAULT	(2048)
+
+/**
+ * @def AGC_ATTACK_MS_DEFAULT
+ * @brief time constant of a rising level [ms]
+ */
+#define AGC_ATTACK_MS_DEFAULT	(5)
+
+/**
+ * @def AGC_RELEASE_MS_DEFAULT
+ * @brief time constant of a falling level [ms]
+ */
+#define AGC_RELEASE_MS_DEFAULT	(500)
+
+
+/***************************************************
+            DATA TYPES
+***************************************************/
+
+/** target level and limits, may change at run time
+ */
+typedef struct {
+  int            target;    /* peak envelope aimed at */
+  int            gainMax;   /* largest gain, Q12 */
+  int            gainMin;   /* smallest gain, Q12 */
+  int            gate;      /* envelope under which the gate closes, 0 off */
+  int            gateGain;  /* gain with the gate closed, Q12 */
+  int            attackMs;  /* time constant of a rising level */
+  int            releaseMs; /* time constant of a falling level */
+} agc_config_t;
+
+/** AGC object
+ */
+typedef struct {
+  const agc_config_t *pConfig; /* target level and limits */
+  int            envelope;  /* level, peak envelope */
+  int            gain;      /* gain at the end of the last block, Q12 */
+  unsigned int   gated;     /* blocks with the gate closed */
+  unsigned int   limited;   /* blocks the peak held the gain down */
+} agc_t;
+
+
+/***************************************************
+            Access Methods
+***************************************************/
+
+/** Initialize the AGC, unity gain
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pConfig  target level and limits, read per chunk
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int agc_init(agc_t *pThis, const agc_config_t *pConfig);
+
+/** check a configuration
+ *
+ * Parameters:
+ * @param pConfig  target level and limits
+ *
+ * @return Zero if valid.
+ * Negative value otherwise.
+ */
+int agc_check(const agc_config_t *pConfig);
+
+/** level a captured chunk, in place
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pChunk  chunk of 16 bit PCM
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int agc_process(agc_t *pThis, chunk_t *pChunk);
+
+#endif
@@ -23,9 +23,42 @@
 #include <audioTx.h>
 #include <uartRx.h>
 #include <uartTx.h>
+#include <compression.h>
+#include <decompression.h>
+#include <jitterBuffer.h>
+#include <vad.h>
+#include <cng.h>
+#include <event.h>
+#include <latency.h>
+#include <resample.h>
+#include <aec.h>
+#include <ns.h>
+#include <agc.h>
+#include <mixer.h>
 #include <ssm2602.h>
 
+/**
+ * @def AP_BYTES_PER_MS
+ * @brief bytes of audio per ms, 8 kHz 16 bit mono
+ */
+#define AP_BYTES_PER_MS		(16)
+
+/**
+ * @def AP_FRAME_MS_DEFAULT
+ * @brief frame duration after init [ms]
+ */
+#define AP_FRAME_MS_DEFAULT	(20)
+
+
 
+/** telemetry of all paths, see telemetry.h
+ */
+typedef struct {
+  telemetry_t		audioRx;	/* capture */
+  telemetry_t		uartTx;		/* link transmit */
+  telemetry_t		uartRx;		/* link receive */
+  telemetry_t		audioTx;	/* playback */
+} audioPlayer_telemetry_t;
 
 /** audioPlayer object
  */
@@ -34,9 +67,28 @@ typedef struct {
   audioTx_t      	tx;  /* transmit object */
   uartRx_t			uartRx;
   uartTx_t			uartTx;
+  compression_t		comp;	/* encoder for the UART transmit path */
+  decompression_t	decomp;	/* decoder for the UART receive path */
+  vad_t				vad;	/* silence suppression on the UART transmit path */
+  cng_t				cng;	/* comfort noise on the UART receive path */
+  jitterBuffer_t	jb;		/* playout buffer for the UART receive path */
+  event_t			event;	/* ISRs wake the main loop */
+  latency_t			latency;	/* mouth to ear measurement over the link */
+  resample_t		down;	/* decimator in front of the encoder */
+  resample_t		up;		/* interpolator behind the decoder */
+  aec_t				aec;	/* echo of the playback out of the capture */
+  ns_t				ns;		/* noise suppression in front of the encoder */
+  int				nsEnabled;	/* ns on, see audioPlayer_setNoiseSuppression */
+  agc_t				agc;	/* level of the capture */
+  agc_config_t		agcConfig;	/* AGC target level and limits, see audioPlayer_setAgc */
+  mixer_t			mixer;	/* volume and sidetone in front of audio TX */
+  unsigned int		scheduled;	/* frame times handed to audio TX (incl. lost) */
+  int				frameMs;	/* frame duration [ms], chunk size of the pool */
+  int				started;	/* audioPlayer_start was called */
+  audioPlayer_telemetry_t	telemetryBase;	/* counters at the last telemetry reset */
   bufferPool_t   	bp;  /* buffer pool */
   isrDisp_t      	isrDisp; /* dispatcher for Rx Tx ISR */
-  int 					volume;	/* Volume of the audio player */
+  int 					volume;	/* Volume of the audio player, the codec keeps the one of init */
   eSsm2602SampleFreq 	frequency;	/* Frequency of the audio player */
   chunk_t            *pReceiveChunk;  /* Chunk for copy */
   chunk_t			*pTransmitChunk;
@@ -59,12 +111,140 @@ int audioPlayer_init(audioPlayer_t *pThis);
 int audioPlayer_start(audioPlayer_t *pThis);
 
 /** main loop of audio player does not terminate
+ *   sleeps in idle until an ISR posts an event (see event.h)
  *@param pThis  pointer to own object 
  *
  *@return 0 success, non-zero otherwise
  **/
 void audioPlayer_run(audioPlayer_t *pThis);
 
+/** select the codec used on the UART link
+ *   switches the encoder, the receiver takes the frame length from
+ *   the frame header and the codec from the codec header
+ *@param pThis  pointer to own object
+ *@param codec  COMPRESSION_CODEC_xxx
+ *
+ *@return 0 success, non-zero otherwise
+ **/
+int audioPlayer_setCodec(audioPlayer_t *pThis, int codec);
+
+/** select the sample rate on the UART link
+ *   the transmit path decimates by the ratio in front of the encoder,
+ *   the receiver takes the ratio from the frame header and
+ *   interpolates back to 8 kHz; may be called at run time
+ *@param pThis  pointer to own object
+ *@param ratio  1 (8 kHz), 2 (4 kHz) or 4 (2 kHz)
+ *
+ *@return 0 success, non-zero otherwise
+ **/
+int audioPlayer_setRatio(audioPlayer_t *pThis, int ratio);
+
+/** set the AGC target level and limits of the transmit path
+ *   taken from the next captured chunk on; the defaults are the
+ *   AGC_xxx_DEFAULT of agc.h
+ *@param pThis  pointer to own object
+ *@param pConfig  target level, gain limits, gate, attack and release
+ *
+ *@return 0 success, non-zero otherwise
+ **/
+int audioPlayer_setAgc(audioPlayer_t *pThis, const agc_config_t *pConfig);
+
+/** set the playback volume
+ *   a digital gain in front of audio TX, 1 dB per step like the
+ *   headphone volume of the codec (which stays at VOLUME_MAX); ramped
+ *   to over a few ms, no I2C traffic
+ *@param pThis  pointer to own object
+ *@param volume  VOLUME_MIN (-80 dB) .. VOLUME_MAX (unity gain)
+ *
+ *@return 0 success, non-zero otherwise
+ **/
+int audioPlayer_setVolume(audioPlayer_t *pThis, int volume);
+
+/** playback volume up by VOLUME_CHANGE_STEP, up to VOLUME_MAX
+ *@param pThis  pointer to own object
+ *
+ *@return the volume now
+ **/
+int audioPlayer_volumeUp(audioPlayer_t *pThis);
+
+/** playback volume down by VOLUME_CHANGE_STEP, down to VOLUME_MIN
+ *@param pThis  pointer to own object
+ *
+ *@return the volume now
+ **/
+int audioPlayer_volumeDown(audioPlayer_t *pThis);
+
+/** set the sidetone, the local capture mixed into the playback
+ *   after the AEC, NS and AGC, it lags by one to two frames
+ *@param pThis  pointer to own object
+ *@param attenuation  level under the capture [dB], 12 or more; 0 off
+ *
+ *@return 0 success, non-zero otherwise
+ **/
+int audioPlayer_setSidetone(audioPlayer_t *pThis, int attenuation);
+
+/** switch the noise suppression of the transmit path
+ *   off, the capture bypasses it and its NS_FFT samples (16 ms) of
+ *   delay; on again, it starts over from silence; may be called at
+ *   run time
+ *@param pThis  pointer to own object
+ *@param enable  1 on (the default), 0 off
+ *
+ *@return 0 success, non-zero otherwise
+ **/
+int audioPlayer_setNoiseSuppression(audioPlayer_t *pThis, int enable);
+
+/** switch the latency measurement mode
+ *   on: every frame sent carries a timing trailer (see latency.h), the
+ *   far end has to be in latency mode too for the round trip and the
+ *   one way latency to be measured here
+ *@param pThis  pointer to own object
+ *@param enable  1 on, 0 off
+ *
+ *@return void
+ **/
+void audioPlayer_setLatencyMode(audioPlayer_t *pThis, int enable);
+
+/** print the latency distributions since the last report, then
+ *   restart them
+ *   - one way: far end capture to local playback start (mouth to ear)
+ *   - round trip: on the UART link, frame sent to its echo received
+ *@param pThis  pointer to own object
+ *
+ *@return void
+ **/
+void audioPlayer_latencyReport(audioPlayer_t *pThis);
+
+/** select the frame duration of all paths
+ *   re-carves the buffer pool into chunks of one frame; audio RX
+ *   captures, audio TX plays and the codecs code one chunk at a time,
+ *   the UART frames are as long as the coded chunk
+ *   only before audioPlayer_start, both ends have to use the same
+ *@param pThis  pointer to own object
+ *@param ms  frame duration, up to SAMPLE_SIZE / AP_BYTES_PER_MS (128)
+ *
+ *@return 0 success, non-zero otherwise
+ **/
+int audioPlayer_setFrameDuration(audioPlayer_t *pThis, int ms);
+
+/** counters of all paths since the last reset
+ *   copies a few words per path, callable any time from the main loop
+ *@param pThis  pointer to own object
+ *@param pSnap  filled with the counters
+ *
+ *@return void
+ **/
+void audioPlayer_telemetrySnapshot(audioPlayer_t *pThis, audioPlayer_telemetry_t *pSnap);
+
+/** restart the counters of all paths
+ *   the live counters are not cleared (ISRs keep writing them), a
+ *   baseline is taken instead
+ *@param pThis  pointer to own object
+ *
+ *@return void
+ **/
+void audioPlayer_telemetryReset(audioPlayer_t *pThis);
+
 int UARTStart(void);
 
 int UARTStop(void);
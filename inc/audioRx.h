@@ -17,18 +17,28 @@
 #ifndef _AUDIO_RX_H_
 #define _AUDIO_RX_H_
 
-#include "queue.h"
+#include "spscRing.h"
 #include "bufferPool.h"
 #include "isrDisp.h"
+#include "event.h"
+#include "telemetry.h"
+#include "dmaDesc.h"
+#include "cycles.h"
 
 /***************************************************
             DEFINES
 ***************************************************/   
 /**
  * @def AUDIORX_QUEUE_DEPTH
- * @brief rx queue depth
+ * @brief rx queue depth, a power of two
  */
-#define AUDIORX_QUEUE_DEPTH 7
+#define AUDIORX_QUEUE_DEPTH 8
+
+/**
+ * @def AUDIORX_CYCLES_PER_SAMPLE
+ * @brief core cycles per sample, 8 kHz
+ */
+#define AUDIORX_CYCLES_PER_SAMPLE (CYCLES_PER_MS / 8)
 
 
 /***************************************************
@@ -36,11 +46,17 @@
 ***************************************************/
 
 /** audio RX object
+ *   two descriptors linked to a ring (ping-pong): while one chunk is
+ *   being filled the next one is already linked, the DMA never stops
  */
 typedef struct {
-  queue_t        queue;  /* queue for received buffers */
-  chunk_t        *pPending; /* pointer to pending chunk just in receiving */
+  spscRing_t     queue;  /* received buffers, ISR to main loop */
+  dmaDesc_t      desc[2];   /* descriptor ring */
+  chunk_t        *pFilling[2]; /* chunk behind each descriptor */
+  int            done;   /* descriptor completing next */
   bufferPool_t   *pBuffP; /* pointer to buffer pool */
+  event_t        *pEvent; /* EVENT_AUDIO_RX per chunk queued */
+  telemetry_t    stats;  /* chunks captured / taken / dropped */
 } audioRx_t;
 
 
@@ -59,18 +75,19 @@ typedef struct {
  * @param pThis  pointer to own object
  * @param pBuffP  pointer to buffer pool to take and return chunks from
  * @param pIsrDisp   pointer to interrupt dispatcher to get ISR registered
+ * @param pEvent  events to post to the main loop, NULL for none
  *
  * @return Zero on success.
  * Negative value on failure.
  */
 int audioRx_init(audioRx_t *pThis, bufferPool_t *pBuffP,
-                 isrDisp_t *pIsrDisp);
+                 isrDisp_t *pIsrDisp, event_t *pEvent);
 
 /** start audio rx
  *    - start receiving first chunk from DMA
- *      - acqurie chunk from pool 
- *      - config DMA 
- *      - start DMA + SPORT
+ *      - acquire a chunk for each descriptor
+ *      - link the descriptor ring, start DMA in descriptor mode
+ *      - start SPORT
  * Parameters:
  * @param pThis  pointer to own object
  *
@@ -81,6 +98,12 @@ int audioRx_start(audioRx_t *pThis);
 
 
 /** audio rx isr  (to be called from dispatcher) 
+ *   - the DMA already continues in the other descriptor
+ *   - queue the filled chunk, put a fresh one behind its descriptor
+ *     (or leave it to be overwritten if queue or pool are exhausted)
+ *   - stamp the chunk with the capture time of its first sample
+ *   - post EVENT_AUDIO_RX when a chunk was queued
+ *   - no DMA register is touched but the IRQ status
 
  * Parameters:
  * @param pThis  pointer to own object
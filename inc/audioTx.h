@@ -17,18 +17,37 @@
 #ifndef _AUDIO_TX_H_
 #define _AUDIO_TX_H_
 
-#include "queue.h"
+#include "aec.h"
 #include "bufferPool.h"
+#include "cycles.h"
+#include "dmaDesc.h"
 #include "isrDisp.h"
+#include "event.h"
+#include "latency.h"
+#include "plc.h"
+#include "telemetry.h"
 
 /***************************************************
             DEFINES
 ***************************************************/   
 /**
- * @def AUDIOTX_QUEUE_DEPTH
- * @brief tx queue depth
+ * @def AUDIOTX_RING
+ * @brief number of DMA descriptors chained into the tx ring (power of 2)
  */
-#define AUDIOTX_QUEUE_DEPTH 7
+#define AUDIOTX_RING 4
+
+/**
+ * @def AUDIOTX_FIRST
+ * @brief first descriptor open to audioTx_putNc, counted from the playing
+ * one: the next descriptor is already fetched by the DMA
+ */
+#define AUDIOTX_FIRST 2
+
+/**
+ * @def AUDIOTX_CYCLES_PER_SAMPLE
+ * @brief core cycles per sample played at 8 kHz
+ */
+#define AUDIOTX_CYCLES_PER_SAMPLE (CYCLES_PER_MS / 8)
 
 /***************************************************
             DATA TYPES
@@ -37,10 +56,19 @@
 /** audio RX object
  */
 typedef struct {
-  queue_t       queue;  /* queue for received buffers */
-  chunk_t       *pPending; /* pointer to pending chunk just in receiving */
+  dmaDesc_t     desc[AUDIOTX_RING];   /* DMA4 descriptor ring */
+  chunk_t       *pChunk[AUDIOTX_RING]; /* chunk linked into each descriptor */
+  volatile unsigned int filled[AUDIOTX_RING]; /* descriptor count a chunk was put for */
   bufferPool_t  *pBuffP; /* pointer to buffer pool */
-  int              running; /* DMA is Running */
+  event_t       *pEvent; /* EVENT_AUDIO_TX per descriptor played */
+  int              running; /* a chunk was put, underruns are counted */
+  volatile unsigned int played; /* descriptors played (incl. concealment), ISR counted */
+  volatile unsigned int playStamp; /* cycle count descriptor 'played' started at */
+  unsigned int     next;    /* descriptor count the next chunk is put for */
+  plc_t            plc;     /* replaces chunks missing at their playout time */
+  telemetry_t      stats;   /* chunks queued / played / dropped, underruns */
+  latency_hist_t   latency; /* mouth to ear of chunks stamped by the far end */
+  aec_t            *pAec;   /* far end reference of every chunk put, NULL for none */
 } audioTx_t;
 
 
@@ -51,21 +79,23 @@ typedef struct {
 /** Initialize audio tx
  *    - get pointer to buffer pool
  *    - register interrupt handler
- *    - initialize TX queue
+ *    - link the descriptor ring
 
  * Parameters:
  * @param pThis  pointer to own object
  * @param pBuffP  pointer to buffer pool to take and return chunks from
  * @param pIsrDisp   pointer to interrupt dispatcher to get ISR registered
+ * @param pEvent  events to post to the main loop, NULL for none
+ * @param pAec  echo canceller to hand the far end to, NULL for none
  *
  * @return Zero on success.
  * Negative value on failure.
  */
 int audioTx_init(audioTx_t *pThis, bufferPool_t *pBuffP,
-                 isrDisp_t *pIsrDisp);
+                 isrDisp_t *pIsrDisp, event_t *pEvent, aec_t *pAec);
 
 /** start audio tx
- *   - empthy for now
+ *   - start the descriptor ring, plays silence until chunks are put
  * Parameters:
  * @param pThis  pointer to own object
  *
@@ -75,11 +105,13 @@ int audioTx_init(audioTx_t *pThis, bufferPool_t *pBuffP,
 int audioTx_start(audioTx_t *pThis);
 
 
-/** audio rtx isr  (to be called from dispatcher) 
- *   - get chunk from tx queue
- *    - if valid, release old pending chunk to buffer pool 
- *    - configure DMA 
- *    - if not valide, configure DMA to replay same chunk again
+/** audio tx isr  (to be called from dispatcher) 
+ *   - release the chunk of the finished descriptor to buffer pool 
+ *   - finalize the descriptor after the one playing, if no chunk
+ *     was put for it link a concealment frame
+ *   - the DMA runs on through the ring, it is never reconfigured
+ *   - a stamped chunk starting to play adds a one way latency sample
+ *   - post EVENT_AUDIO_TX, there is room for the next frame
  * Parameters:
  * @param pThis  pointer to own object
  *
@@ -87,9 +119,9 @@ int audioTx_start(audioTx_t *pThis);
  */
 void audioTx_isr(void *pThis);
 
-/** audio rx put
- *   copyies filled pChunk into the TX queue for transmission
- *    if queue is full, then chunk is dropped 
+/** audio tx put
+ *   copies filled pChunk into a pool chunk and links it into the ring
+ *    if the ring is full, then chunk is dropped 
  * Parameters:
  * @param pThis  pointer to own object
  *
@@ -98,5 +130,41 @@ void audioTx_isr(void *pThis);
  */
 int audioTx_put(audioTx_t *pThis, chunk_t *pChunk);
 
+/** audio tx put
+ *    no copy
+ *    ownership of pChunk passes to audioTx, the ISR releases it
+ *    to the buffer pool once played (or right away when dropped)
+ *    feeds the concealment, which may cross-fade the chunk start
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pChunk  chunk acquired from the buffer pool
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int audioTx_putNc(audioTx_t *pThis, chunk_t *pChunk);
+
+/** audio tx skip
+ *   a frame time passes without a chunk (lost frame),
+ *   the ISR plays a concealment frame in its place
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return void
+ */
+void audioTx_skip(audioTx_t *pThis);
+
+/** audio tx position
+ *   absolute sample position played at a given time, as written to the
+ *   echo canceller: descriptor count times the frame samples
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param stamp  time [cycles], within a few frames of now
+ *
+ * @return sample position
+ */
+unsigned int audioTx_position(audioTx_t *pThis, unsigned int stamp);
+
 
 #endif
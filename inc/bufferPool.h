@@ -26,20 +26,65 @@
 ***************************************************/   
 /**
  * @def CHUNK_NUM_MAX
- * @brief maximum number of chunks managed in this buffer pool
+ * @brief maximum number of chunks per size class
  * since we use static allocation, one number for all
+ *
+ * Each class has a queue_t of the board library as its free list, one
+ * entry per chunk. Its capacity is not documented and its source is not
+ * in this tree; 32 is the depth the pool has always used, so a class is
+ * kept to that. Raise it only with the queue_t capacity known.
  */
 #define CHUNK_NUM_MAX (32)
 
+/**
+ * @def BP_SMALL_SIZE
+ * @brief data bytes of a small chunk (SID frames, control messages),
+ * with room for the latency timing trailer
+ */
+#define BP_SMALL_SIZE (32)
+
+/**
+ * @def BP_CODED_SIZE
+ * @brief data bytes of a coded chunk for a frame of size bytes: half a
+ * frame (G.711, ADPCM needs a quarter) plus room for the codec header
+ */
+#define BP_CODED_SIZE(size) ((size) / 2 + BP_SMALL_SIZE)
+
+/**
+ * @def BP_POOL_WORDS
+ * @brief storage carved into chunks, 32 chunks of SAMPLE_SIZE
+ */
+#define BP_POOL_WORDS (32 * CHUNK_WORDS(SAMPLE_SIZE))
+
 /***************************************************
-            DATA TYPESt
+            DATA TYPES
 ***************************************************/
 
-/** bufferPool object
+/** size classes, ascending size
+ */
+typedef enum {
+  BP_CLASS_SMALL,	/* BP_SMALL_SIZE bytes */
+  BP_CLASS_CODED,	/* BP_CODED_SIZE(frame) bytes, a compressed frame */
+  BP_CLASS_FRAME,	/* a frame of 16 bit PCM */
+  BP_CLASS_NUM
+} bufferPool_class_t;
+
+/** chunks of one size class
  */
 typedef struct {
   queue_t    freeList;  /* List of free chunks */
-  chunk_t    buffer[CHUNK_NUM_MAX];
+  int        size;      /* data bytes per chunk */
+  int        first;     /* index of the first chunk in buffer[] */
+  int        num;       /* chunks carved */
+} bufferPool_sizeClass_t;
+
+/** bufferPool object
+ */
+typedef struct {
+  bufferPool_sizeClass_t cls[BP_CLASS_NUM]; /* free lists by size */
+  chunk_t    buffer[BP_CLASS_NUM * CHUNK_NUM_MAX];
+  unsigned int mem[BP_POOL_WORDS];  /* storage behind the chunks */
+  int        frameSize; /* data bytes of a frame chunk */
   isrDisp_t  isrDisp; /* dispatcher for Rx Tx ISR */
 } bufferPool_t;
 
@@ -49,18 +94,24 @@ typedef struct {
 ***************************************************/
 
 /** Initialize buffer pool 
- *    - initialize freeList, populate with chunks
+ *    - carve the storage into the size classes: CHUNK_NUM_MAX small
+ *      chunks, then frame and coded chunks from one half of the rest
+ *      each, CHUNK_NUM_MAX at most per class
+ *    - initialize a freeList per class, populate with chunks; a class
+ *      holds the chunks its freeList took
+ *    - may be called again to re-carve while no chunk is acquired
   *
  * Parameters:
  * @param pThis  pointer to buffer pool
+ * @param size  data bytes of a frame chunk, SAMPLE_SIZE at most
  *
  * @return Zero on success.
  * Negative value on failure.
  */
-int bufferPool_init(bufferPool_t *pThis);
+int bufferPool_init(bufferPool_t *pThis, int size);
 
 
-/** Get a chunk from the  buffer pool 
+/** Get a frame chunk from the  buffer pool 
  *
  * Parameters:
  * @param pThis    pointer to queue data structure
@@ -71,7 +122,21 @@ int bufferPool_init(bufferPool_t *pThis);
  */
 int bufferPool_acquire(bufferPool_t *pThis, chunk_t **ppChunk);
 
-/** Release chunk into the free list 
+/** Get a chunk of at least size bytes from the  buffer pool 
+ *    - from the smallest class that fits, the next larger one if
+ *      that class is empty
+ *
+ * Parameters:
+ * @param pThis    pointer to queue data structure
+ * @param size     data bytes needed
+ * @param ppChunk  pointer pointer to chunk acquired (null if empty)
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int bufferPool_acquireSize(bufferPool_t *pThis, int size, chunk_t **ppChunk);
+
+/** Release chunk into the free list of its class
  *    - non blocking 
  *    - error on null passed 
   *
@@ -84,7 +149,7 @@ int bufferPool_acquire(bufferPool_t *pThis, chunk_t **ppChunk);
  */
 int bufferPool_release(bufferPool_t *pThis, chunk_t *pChunk);
 
-/** Returns true if buffer pool is empty
+/** Returns true if buffer pool has no frame chunk left
  *
  *
  * Parameters:
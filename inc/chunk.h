@@ -22,10 +22,25 @@
 
 /**
  * @def SAMPLE_SIZE
- * @brief Size of one chunk
+ * @brief Size of the largest chunk, 128 ms of 8 kHz 16 bit mono; the
+ * chunks of the buffer pool are carved to the frame duration in use
  */
 #define SAMPLE_SIZE		(1024*2)
 
+/**
+ * @def CHUNK_HDR_SIZE
+ * @brief headroom in front of the data for a link header
+ * multiple of 4 so the data behind it stays word aligned and
+ * header + data form one contiguous block for DMA
+ */
+#define CHUNK_HDR_SIZE	(12)
+
+/**
+ * @def CHUNK_WORDS
+ * @brief 32 bit words of storage for a chunk of size bytes, header included
+ */
+#define CHUNK_WORDS(size)	((CHUNK_HDR_SIZE + (size) + 3) / 4)
+
 /**
  * Chunk status enumeration 
  */ 
@@ -41,29 +56,34 @@ typedef enum {
 /** Chunk Object
  */
 typedef struct {
+  unsigned char       *hdr; /** link header, directly in front of the data */
   /* define a union to have different access to same data in chunk */
   union {
-    unsigned char       u08_buff[SAMPLE_SIZE];  /** Unsigned Data Chunk */
-    unsigned short      u16_buff[SAMPLE_SIZE/2];
-    unsigned int        u32_buff[SAMPLE_SIZE/4];
-    signed char         s08_buff[SAMPLE_SIZE];  /** Signed Data Chunk */
-    signed short        s16_buff[SAMPLE_SIZE/2];
-    signed int          s32_buff[SAMPLE_SIZE/4];
+    unsigned char       *u08_buff;  /** Unsigned Data Chunk */
+    unsigned short      *u16_buff;
+    unsigned int        *u32_buff;
+    signed char         *s08_buff;  /** Signed Data Chunk */
+    signed short        *s16_buff;
+    signed int          *s32_buff;
   };
   int                 size;         /** total number bytes in chunk */ 
   int                 len;          /**  used bytes in chunk (fill level) */ 
+  unsigned int        stamp;        /** capture time of the first sample [cycles] */
+  unsigned int        flags;        /** FRAME_FLAG_xxx of the link frame */
   e_buff_status_t     e_status;     /** status */ 
   
 } chunk_t;
 
 /** initialize chunk 
- *  - reset size of chunk to maximum 
+ *  - attach the storage, header first and data behind it
  *  - does NOT zero the buffer !
  *@param pThis  pointer to own object 
+ *@param pMem  CHUNK_WORDS(size) words of storage
+ *@param size  data bytes of the chunk
  *
  *@return 0 success, non-zero otherwise
  **/
-int chunk_init(chunk_t *pThis); 
+int chunk_init(chunk_t *pThis, unsigned int *pMem, int size); 
 
 
 
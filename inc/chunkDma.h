@@ -0,0 +1,93 @@
+/**
+ *@file chunkDma.h
+ *
+ *@brief
+ *  - asynchronous chunk copy on memory DMA stream 0
+ *  - nothing in the player calls it yet, its chunks are handed on by
+ *    pointer; tools/copybench measures it against chunk_copy
+ *
+ * Target:   TLL6527v1-0
+ * Compiler: VDSP++     Output format: VDSP++ "*.dxe"
+ *
+ *******************************************************************************/
+#ifndef _CHUNK_DMA_H_
+#define _CHUNK_DMA_H_
+
+#include <chunk.h>
+
+/***************************************************
+            DATA TYPES
+***************************************************/
+
+/** completion callback, called with the filled destination chunk */
+typedef void (*chunkDma_callback_t)(void *pArg, chunk_t *pDst);
+
+/** chunk DMA object
+ */
+typedef struct {
+  chunk_t               *pSrc;       /* chunk being copied from */
+  chunk_t               *pDst;       /* chunk being copied to */
+  chunkDma_callback_t   callback;    /* called when the copy completed */
+  void                  *pCallbackArg; /* first argument to callback */
+  int                   busy;        /* MDMA stream owned by a copy */
+} chunkDma_t;
+
+
+/***************************************************
+            Access Methods
+***************************************************/
+
+/** Initialize chunk DMA
+ *    - stop memory DMA stream 0
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int chunkDma_init(chunkDma_t *pThis);
+
+/** start copying pSrc into pDst
+ *    - non blocking, returns once the MDMA is started
+ *    - whole words go through the MDMA, a 1..3 byte tail is copied
+ *      by the core before returning
+ *    - neither chunk may be touched until the callback ran
+ *    - fails if the data does not fit pDst, the MDMA is not started
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pSrc  pointer to source chunk
+ * @param pDst  pointer to destination chunk
+ * @param callback  called from chunkDma_poll() on completion, may be NULL
+ * @param pArg  first argument passed to callback
+ *
+ * @return Zero on success.
+ * Negative value on failure (a copy is still in flight, or the data
+ * does not fit pDst).
+ */
+int chunkDma_copy(chunkDma_t *pThis, chunk_t *pSrc, chunk_t *pDst,
+                  chunkDma_callback_t callback, void *pArg);
+
+/** poll for completion
+ *    - to be called from the main loop
+ *    - on completion the callback is invoked and the MDMA is free again
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return Zero if a copy completed during this call.
+ * Negative value otherwise.
+ */
+int chunkDma_poll(chunkDma_t *pThis);
+
+/** Returns true if a copy is in flight
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return true (non-zero) if busy, 0 if idle
+ */
+int chunkDma_isBusy(chunkDma_t *pThis);
+
+#endif
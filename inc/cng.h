@@ -0,0 +1,78 @@
+/**
+ *@file cng.h
+ *
+ *@brief
+ *  - comfort noise generation for the receive path
+ *  - fills frame times left out by the far end VAD with noise at the
+ *    level of the last SID frame
+ *
+ * Target:   TLL6527v1-0
+ * Compiler: VDSP++     Output format: VDSP++ "*.dxe"
+ *
+ *******************************************************************************/
+#ifndef _CNG_H_
+#define _CNG_H_
+
+#include <chunk.h>
+
+/***************************************************
+            DATA TYPES
+***************************************************/
+
+/** comfort noise generator object
+ */
+typedef struct {
+  int           active;     /* far end is silent, fill with noise */
+  int           level;      /* mean magnitude from the last SID */
+  int           len;        /* bytes per generated frame */
+  unsigned int  seed;       /* noise generator state */
+  unsigned int  frames;     /* comfort noise frames generated */
+} cng_t;
+
+
+/***************************************************
+            Access Methods
+***************************************************/
+
+/** Initialize comfort noise generation
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int cng_init(cng_t *pThis);
+
+/** a SID frame was received, start or update comfort noise
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pChunk  SID frame (codec header only)
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int cng_sid(cng_t *pThis, chunk_t *pChunk);
+
+/** a speech frame is played, stop comfort noise
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param len  bytes of 16 bit PCM in the frame, used for noise frames
+ *
+ * @return void
+ */
+void cng_speech(cng_t *pThis, int len);
+
+/** fill a chunk with one frame of comfort noise
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pChunk  chunk to fill
+ *
+ * @return void
+ */
+void cng_generate(cng_t *pThis, chunk_t *pChunk);
+
+#endif
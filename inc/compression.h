@@ -1,16 +1,129 @@
 #ifndef _COMPRESSION_H_
 #define _COMPRESSION_H_
 
-//#include
+#include <chunk.h>
 
 /** Defines **/
-//#define
+/**
+ * @def COMPRESSION_HDR_SIZE
+ * @brief bytes of codec header in front of every compressed chunk
+ *  [0] codec id, [1] ADPCM step index, [2..3] ADPCM predictor (LE)
+ *  (bytes 1..3 are zero for G.711)
+ * 4 bytes keeps the payload behind it 32 bit aligned
+ */
+#define COMPRESSION_HDR_SIZE	(4)
+
+/**
+ * @def COMPRESSION_CODEC_ADPCM
+ * @brief codec id: IMA ADPCM, 4 bit per 16 bit sample
+ */
+#define COMPRESSION_CODEC_ADPCM	(1)
+
+/**
+ * @def COMPRESSION_CODEC_ULAW
+ * @brief codec id: G.711 mu-law, 8 bit per 16 bit sample
+ */
+#define COMPRESSION_CODEC_ULAW	(2)
+
+/**
+ * @def COMPRESSION_CODEC_ALAW
+ * @brief codec id: G.711 A-law, 8 bit per 16 bit sample
+ */
+#define COMPRESSION_CODEC_ALAW	(3)
+
+/**
+ * @def COMPRESSION_CODEC_SID
+ * @brief codec id: silence descriptor, no payload behind the header
+ *  [2..3] background noise level (mean magnitude, LE)
+ *  sent by the VAD instead of silent chunks, see vad.h / cng.h
+ */
+#define COMPRESSION_CODEC_SID	(4)
+
+/**
+ * @def COMPRESSION_ADPCM_LEN
+ * @brief compressed length (bytes) of a chunk holding len bytes of PCM
+ */
+#define COMPRESSION_ADPCM_LEN(len)	(COMPRESSION_HDR_SIZE + (len)/4)
+
+/**
+ * @def COMPRESSION_G711_LEN
+ * @brief compressed length (bytes) of a chunk holding len bytes of PCM
+ */
+#define COMPRESSION_G711_LEN(len)	(COMPRESSION_HDR_SIZE + (len)/2)
 
 /** Data Types **/
-typedef char compression_t;
+/** compression object
+ * holds the selected codec and the ADPCM encoder state which is
+ * carried across chunks
+ */
+typedef struct {
+  int		codec;		/* COMPRESSION_CODEC_xxx used for the next chunk */
+  int		predictor;	/* last reconstructed sample */
+  int		stepIndex;	/* index into adpcm_stepTable */
+} compression_t;
+
+/** IMA ADPCM tables shared by encoder and decoder */
+extern const short adpcm_stepTable[89];
+extern const signed char adpcm_indexTable[16];
 
 /** Access Methods **/
+/** Configures a blank state structure
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return Zero on success.
+ * 			Negative value on failure.
+ */
+int compression_init(compression_t *pThis);
+
+/** Select the codec for the following chunks
+ *   may be called at run time, the decoder follows the codec id
+ *   in each chunk header
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param codec  COMPRESSION_CODEC_xxx
+ *
+ * @return Zero on success.
+ * 			Negative value on failure.
+ */
+int compression_setCodec(compression_t *pThis, int codec);
+
+/** Compressed length of a chunk
+ *
+ * Parameters:
+ * @param codec  COMPRESSION_CODEC_xxx
+ * @param len  bytes of 16 bit PCM
+ *
+ * @return compressed length in bytes, Negative value on unknown codec
+ */
+int compression_chunkLen(int codec, int len);
+
+/** Takes a chunk of 16 bit PCM and compresses it in place
+ *    - pchunk->len is updated to the compressed length
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pchunk  chunk to compress
+ *
+ * @return Zero on success.
+ * 			Negative value on failure.
+ */
 int compressData(compression_t *pThis, chunk_t *pchunk );
 
-#endif
+/** Takes a chunk of 16 bit PCM and compresses it into another chunk
+ *    - pDst->len is set to the compressed length
+ *    - fails if the compressed data does not fit pDst->size
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pSrc  chunk of 16 bit PCM (not modified unless it is pDst)
+ * @param pDst  chunk to compress into, may be pSrc
+ *
+ * @return Zero on success.
+ * 			Negative value on failure.
+ */
+int compressDataTo(compression_t *pThis, chunk_t *pSrc, chunk_t *pDst );
 
+#endif
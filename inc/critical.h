@@ -0,0 +1,74 @@
+/**
+ *@file critical.h
+ *
+ *@brief
+ *  - short critical sections against the ISRs (main loop only)
+ *
+ * Target:   TLL6527v1-0
+ * Compiler: VDSP++     Output format: VDSP++ "*.dxe"
+ *
+ *******************************************************************************/
+#ifndef _CRITICAL_H_
+#define _CRITICAL_H_
+
+#if defined(TLL_SIM)
+/* host simulation (tools/sim): the interrupts are a signal */
+unsigned int sim_cli(void);
+void sim_sti(unsigned int mask);
+void sim_idle(unsigned int mask);
+#endif
+
+/** disable interrupts
+ *
+ * @return interrupt mask to restore with critical_exit
+ */
+static inline unsigned int critical_enter(void)
+{
+	unsigned int mask = 0;
+#if defined(__ADSPBLACKFIN__) || defined(__bfin__)
+	asm volatile("cli %0;" : "=d" (mask));
+#elif defined(TLL_SIM)
+	mask = sim_cli();
+#endif
+	return mask;
+}
+
+/** restore interrupts
+ *
+ * @param mask  value returned by critical_enter
+ *
+ * @return void
+ */
+static inline void critical_exit(unsigned int mask)
+{
+#if defined(__ADSPBLACKFIN__) || defined(__bfin__)
+	asm volatile("sti %0;" : : "d" (mask));
+#elif defined(TLL_SIM)
+	sim_sti(mask);
+#else
+	(void) mask;
+#endif
+}
+
+/** sleep until an interrupt is taken (main loop only)
+ *   enables interrupts and idles from one aligned fetch block, so an
+ *   interrupt arriving in between still ends the idle instead of
+ *   being serviced before it; returns with interrupts enabled after
+ *   the ISR ran
+ *
+ * @param mask  value returned by critical_enter
+ *
+ * @return void
+ */
+static inline void critical_idle(unsigned int mask)
+{
+#if defined(__ADSPBLACKFIN__) || defined(__bfin__)
+	asm volatile(".align 8;\n\tsti %0;\n\tidle;" : : "d" (mask));
+#elif defined(TLL_SIM)
+	sim_idle(mask);
+#else
+	(void) mask;
+#endif
+}
+
+#endif
@@ -0,0 +1,46 @@
+/**
+ *@file cycles.h
+ *
+ *@brief
+ *  - free running core cycle counter as time base
+ *
+ * Target:   TLL6527v1-0
+ * Compiler: VDSP++     Output format: VDSP++ "*.dxe"
+ *
+ *******************************************************************************/
+#ifndef _CYCLES_H_
+#define _CYCLES_H_
+
+#if !defined(__ADSPBLACKFIN__) && !defined(__bfin__)
+#include <time.h>
+#endif
+
+/**
+ * @def CYCLES_PER_MS
+ * @brief core cycles per ms, 600 MHz core clock
+ */
+#define CYCLES_PER_MS	(600000)
+
+/** read the low 32 bit of the core cycle counter
+ *   wraps after 2^32 cycles, use differences only
+ *   off target the monotonic clock, scaled to cycles of the core
+ *
+ * @return cycle count
+ */
+static inline unsigned int cycles_read(void)
+{
+#if defined(__ADSPBLACKFIN__) || defined(__bfin__)
+	unsigned int cycles;
+
+	asm volatile("%0 = CYCLES;" : "=d" (cycles));
+	return cycles;
+#else
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (unsigned int) (now.tv_sec * (unsigned long long) CYCLES_PER_MS * 1000
+	                       + now.tv_nsec * (unsigned long long) CYCLES_PER_MS / 1000000);
+#endif
+}
+
+#endif
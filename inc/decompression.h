@@ -1,16 +1,63 @@
 #ifndef _DECOMPRESSION_H_
 #define _DECOMPRESSION_H_
 
-//#include
+#include <chunk.h>
+#include <compression.h>
 
 /** Defines **/
 //#define
 
 /** Data Types **/
-typedef char decompression_t;
+/** decompression object
+ * holds the ADPCM decoder state, re-seeded from every chunk header
+ */
+typedef struct {
+  int		predictor;	/* last reconstructed sample */
+  int		stepIndex;	/* index into adpcm_stepTable */
+} decompression_t;
 
 /** Access Methods **/
+/** Configures a blank state structure
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return Zero on success.
+ * 			Negative value on failure.
+ */
+int decompression_init(decompression_t *pThis);
+
+/** G.711 decode tables, indexed by the code byte */
+extern const short g711_ulawTable[256];
+extern const short g711_alawTable[256];
+
+/** Receive a chunk and decompress it in place
+ *    - codec is taken from the chunk header
+ *    - pchunk->len is updated to the decompressed length
+ *    - fails if the decompressed data does not fit pchunk->size
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pchunk  chunk to decompress
+ *
+ * @return Zero on success.
+ * 			Negative value on failure.
+ */
 int decompressData(decompression_t *pThis, chunk_t *pchunk );
 
-#endif
+/** Receive a chunk and decompress it into another chunk
+ *    - codec is taken from the chunk header
+ *    - pDst->len is set to the decompressed length
+ *    - fails if the decompressed data does not fit pDst->size
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pSrc  chunk to decompress (not modified unless it is pDst)
+ * @param pDst  chunk to decompress into, may be pSrc
+ *
+ * @return Zero on success.
+ * 			Negative value on failure.
+ */
+int decompressDataTo(decompression_t *pThis, chunk_t *pSrc, chunk_t *pDst );
 
+#endif
@@ -0,0 +1,25 @@
+/**
+ *@file dmaDesc.h
+ *
+ *@brief
+ *  - DMA descriptor for descriptor list mode, large model
+ *
+ * Target:   TLL6527v1-0
+ * Compiler: VDSP++     Output format: VDSP++ "*.dxe"
+ *
+ *******************************************************************************/
+#ifndef _DMA_DESC_H_
+#define _DMA_DESC_H_
+
+/** DMA descriptor, large model as fetched with NDSIZE_7
+ *   (next pointer, start address, config, x count, x modify)
+ */
+typedef struct dmaDesc_s {
+  struct dmaDesc_s *pNext;   /* NDPL/NDPH: descriptor fetched next */
+  void           *pStart;    /* SAL/SAH: buffer start address */
+  unsigned short config;     /* DMACFG */
+  unsigned short xCount;     /* XCNT: elements */
+  short          xModify;    /* XMOD: bytes per element */
+} dmaDesc_t;
+
+#endif
@@ -0,0 +1,106 @@
+/**
+ *@file event.h
+ *
+ *@brief
+ *  - event flags from the ISRs to the main loop, the main loop sleeps
+ *    in idle until one is posted
+ *
+ *  Every event has its own flag word with a single writer per side: the
+ *  ISR sets it, the main loop clears it with interrupts disabled. An
+ *  event only says that work may be ready, the main loop drains its
+ *  queue, so a post merging with an earlier one loses nothing.
+ *
+ * Target:   TLL6527v1-0
+ * Compiler: VDSP++     Output format: VDSP++ "*.dxe"
+ *
+ *******************************************************************************/
+#ifndef _EVENT_H_
+#define _EVENT_H_
+
+/***************************************************
+            DATA TYPES
+***************************************************/
+
+/** events posted by the ISRs
+ */
+typedef enum {
+  EVENT_AUDIO_RX,   /* captured chunk queued */
+  EVENT_AUDIO_TX,   /* descriptor played, room for the next frame */
+  EVENT_UART_RX,    /* UART RX ring row filled, or bytes received within a
+                       core timer tick (UARTRX_TICK_CYCLES, 1 ms), which
+                       bounds the wait of a frame shorter than a row */
+  EVENT_NUM
+} event_id_t;
+
+/**
+ * @def EVENT_MASK
+ * @brief bit of an event in the set returned by event_wait
+ */
+#define EVENT_MASK(id)	(1u << (id))
+
+/** sleep and wakeup statistics, main loop only
+ */
+typedef struct {
+  unsigned long long  cycles;       /* cycles measured */
+  unsigned long long  idleCycles;   /* of those, asleep in idle */
+  unsigned int        wakeups;      /* idle ended by a posted event */
+  unsigned int        latencySum;   /* post to main loop running [cycles] */
+  unsigned int        latencyMax;
+} event_stats_t;
+
+/** event object
+ */
+typedef struct {
+  volatile unsigned int pending[EVENT_NUM]; /* set by the ISR, cleared by event_wait */
+  volatile unsigned int posted[EVENT_NUM];  /* cycle count of the last post */
+  unsigned int          last;               /* cycle count at the last event_wait */
+  event_stats_t         stats;
+} event_t;
+
+
+/***************************************************
+            Access Methods
+***************************************************/
+
+/** Initialize events, none pending
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int event_init(event_t *pThis);
+
+/** post an event (ISR)
+ *
+ * Parameters:
+ * @param pThis  pointer to own object, no event if NULL
+ * @param id  event to post
+ *
+ * @return void
+ */
+void event_post(event_t *pThis, event_id_t id);
+
+/** wait for events (main loop)
+ *   returns right away if events are pending, sleeps in idle otherwise
+ *   clears the events returned
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return set of EVENT_MASK() bits
+ */
+unsigned int event_wait(event_t *pThis);
+
+/** print idle fraction, wakeups and wakeup latency since the last
+ *   report, then restart the statistics
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return void
+ */
+void event_report(event_t *pThis);
+
+#endif
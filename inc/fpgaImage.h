@@ -0,0 +1,138 @@
+/**
+ *@file fpgaImage.h
+ *
+ *@brief
+ *  - streaming decompression of the packed FPGA bitstream
+ *
+ *  Packed format (tools/fpgapack generates it):
+ *
+ *  offset  size  field
+ *    0      2    magic 'F' 'Z'
+ *    2      1    format version (1)
+ *    3      1    reserved (0)
+ *    4      4    unpacked size (LE)
+ *    8      ...  tokens
+ *
+ *  token 0x00..0x7F  literal: token + 1 bytes follow
+ *  token 0x80..0xFF  match: (token & 0x7F) + FPGAIMAGE_MATCH_MIN bytes
+ *                    copied from distance bytes back, distance - 1 in
+ *                    the next 2 bytes (LE); for token 0xFF an extra
+ *                    length (LE, 2 bytes) comes first and is added
+ *
+ *  A match may overlap the bytes it produces (distance 1 repeats a
+ *  byte), the distance is at most FPGAIMAGE_WINDOW. Only that window
+ *  of the output is kept, the image is produced block by block.
+ *
+ *  The blocks could go to the FPGA as they are produced, but
+ *  fpga_programmer of the board library takes the whole bitstream in
+ *  one buffer and has no entry point to continue a configuration. So
+ *  main.c still unpacks into a buffer of the full size; it is taken
+ *  from the heap and freed once the FPGA is programmed, the player
+ *  runs without it. Programming block by block needs a streaming
+ *  programmer in the board library.
+ *
+ * Target:   TLL6527v1-0
+ * Compiler: VDSP++     Output format: VDSP++ "*.dxe"
+ *
+ *******************************************************************************/
+#ifndef _FPGA_IMAGE_H_
+#define _FPGA_IMAGE_H_
+
+/***************************************************
+            DEFINES
+***************************************************/
+/**
+ * @def FPGAIMAGE_HDR_SIZE
+ * @brief bytes of the packed header
+ */
+#define FPGAIMAGE_HDR_SIZE	(8)
+
+/**
+ * @def FPGAIMAGE_VERSION
+ * @brief packed format version
+ */
+#define FPGAIMAGE_VERSION	(1)
+
+/**
+ * @def FPGAIMAGE_WINDOW
+ * @brief longest match distance, a power of two
+ */
+#define FPGAIMAGE_WINDOW	(4096)
+
+/**
+ * @def FPGAIMAGE_MATCH_MIN
+ * @brief shortest match
+ */
+#define FPGAIMAGE_MATCH_MIN	(3)
+
+/**
+ * @def FPGAIMAGE_MATCH_EXT
+ * @brief match token followed by an extra length
+ */
+#define FPGAIMAGE_MATCH_EXT	(0xFF)
+
+/**
+ * @def FPGAIMAGE_BLOCK
+ * @brief bytes unpacked per fpgaImage_read call at boot
+ */
+#define FPGAIMAGE_BLOCK	(512)
+
+
+/***************************************************
+            DATA TYPES
+***************************************************/
+
+/** decompressor object
+ */
+typedef struct {
+  const unsigned char *pSrc;    /* packed image */
+  int                 srcLen;
+  int                 srcPos;   /* next packed byte */
+  unsigned int        size;     /* unpacked bytes */
+  unsigned int        done;     /* unpacked bytes produced */
+  unsigned int        literal;  /* literal bytes left in the token */
+  unsigned int        match;    /* match bytes left in the token */
+  unsigned int        dist;     /* distance of the match */
+  unsigned char       window[FPGAIMAGE_WINDOW]; /* last bytes produced */
+} fpgaImage_t;
+
+
+/***************************************************
+            Access Methods
+***************************************************/
+
+/** Initialize the decompressor on a packed image
+ *    - checks the header
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pSrc  packed image
+ * @param srcLen  bytes of the packed image
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int fpgaImage_init(fpgaImage_t *pThis, const unsigned char *pSrc, int srcLen);
+
+/** unpacked size of the image
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return bytes
+ */
+unsigned int fpgaImage_size(fpgaImage_t *pThis);
+
+/** produce the next block of the image
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pDst  block to fill
+ * @param max  size of the block
+ *
+ * @return bytes produced, zero at the end of the image.
+ * Negative value on a corrupt image.
+ */
+int fpgaImage_read(fpgaImage_t *pThis, unsigned char *pDst, int max);
+
+#endif
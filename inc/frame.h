@@ -0,0 +1,147 @@
+/**
+ *@file frame.h
+ *
+ *@brief
+ *  - framing of chunks on the UART link
+ *
+ *  Every chunk travels as a frame: a 12 byte header in the chunk
+ *  headroom followed by chunk->len bytes of payload.
+ *
+ *  offset  size  field
+ *    0      2    sync word 0xA5 0x5A
+ *    2      2    sequence number (LE), +1 per frame sent
+ *    4      1    codec id (first byte of the compressed payload)
+ *    5      1    flags (FRAME_FLAG_xxx, from chunk->flags)
+ *    6      2    payload length (LE)
+ *    8      2    inverted payload length, validates the header
+ *   10      2    CRC-16/CCITT over bytes 2..9 and the payload (LE)
+ *
+ * Target:   TLL6527v1-0
+ * Compiler: VDSP++     Output format: VDSP++ "*.dxe"
+ *
+ *******************************************************************************/
+#ifndef _FRAME_H_
+#define _FRAME_H_
+
+#include <chunk.h>
+
+/***************************************************
+            DEFINES
+***************************************************/
+/**
+ * @def FRAME_HDR_SIZE
+ * @brief size of the frame header, fills the chunk headroom
+ */
+#define FRAME_HDR_SIZE      (CHUNK_HDR_SIZE)
+
+/**
+ * @def FRAME_SYNC0
+ * @brief first sync byte
+ */
+#define FRAME_SYNC0         (0xA5)
+
+/**
+ * @def FRAME_SYNC1
+ * @brief second sync byte
+ */
+#define FRAME_SYNC1         (0x5A)
+
+/**
+ * @def FRAME_FLAG_TIMING
+ * @brief payload ends in a latency timing trailer (latency.h)
+ */
+#define FRAME_FLAG_TIMING   (0x01)
+
+/**
+ * @def FRAME_FLAG_RATIO
+ * @brief log2 of the resample ratio of the payload (resample.h), 0 for
+ * full rate
+ */
+#define FRAME_FLAG_RATIO_SHIFT  (1)
+#define FRAME_FLAG_RATIO_MASK   (0x06)
+
+/* header field offsets */
+#define FRAME_OFS_SEQ       (2)
+#define FRAME_OFS_CODEC     (4)
+#define FRAME_OFS_FLAGS     (5)
+#define FRAME_OFS_LEN       (6)
+#define FRAME_OFS_LENINV    (8)
+#define FRAME_OFS_CRC       (10)
+
+
+/***************************************************
+            Access Methods
+***************************************************/
+
+/** CRC-16/CCITT (poly 0x1021), table driven
+ *
+ * Parameters:
+ * @param crc  running CRC, 0xFFFF to start
+ * @param pData  bytes to add
+ * @param len  number of bytes
+ *
+ * @return updated CRC
+ */
+unsigned short frame_crc16(unsigned short crc, const unsigned char *pData, int len);
+
+/** build the frame header in the chunk headroom
+ *
+ * Parameters:
+ * @param pChunk  chunk holding the payload in u08_buff[0 .. len-1]
+ * @param seq  sequence number of this frame
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int frame_build(chunk_t *pChunk, unsigned short seq);
+
+/** validate a received frame header
+ *    - sync word and length / inverted length
+ *
+ * Parameters:
+ * @param pHdr  FRAME_HDR_SIZE header bytes
+ * @param maxLen  largest acceptable payload
+ *
+ * @return payload length on success.
+ * Negative value on failure.
+ */
+int frame_checkHeader(const unsigned char *pHdr, int maxLen);
+
+/** verify the CRC of a received frame
+ *
+ * Parameters:
+ * @param pChunk  chunk with header in hdr[] and len bytes of payload
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int frame_checkCrc(chunk_t *pChunk);
+
+/** sequence number of a framed chunk
+ *
+ * Parameters:
+ * @param pChunk  chunk with a frame header
+ *
+ * @return sequence number
+ */
+unsigned short frame_seq(chunk_t *pChunk);
+
+/** codec id of a framed chunk
+ *
+ * Parameters:
+ * @param pChunk  chunk with a frame header
+ *
+ * @return codec id (COMPRESSION_CODEC_xxx)
+ */
+int frame_codec(chunk_t *pChunk);
+
+/** flags of a framed chunk
+ *
+ * Parameters:
+ * @param pChunk  chunk with a frame header
+ *
+ * @return FRAME_FLAG_xxx
+ */
+unsigned int frame_flags(chunk_t *pChunk);
+
+#endif
@@ -0,0 +1,172 @@
+/**
+ *@file jitterBuffer.h
+ *
+ *@brief
+ *  - adaptive jitter buffer between UART receive and audio playback
+ *  - frames are reordered by their sequence number
+ *  - playout delay follows the observed inter-arrival jitter
+ *
+ * Target:   TLL6527v1-0
+ * Compiler: VDSP++     Output format: VDSP++ "*.dxe"
+ *
+ *******************************************************************************/
+#ifndef _JITTER_BUFFER_H_
+#define _JITTER_BUFFER_H_
+
+#include "bufferPool.h"
+
+/***************************************************
+            DEFINES
+***************************************************/
+/**
+ * @def JB_SLOTS
+ * @brief frames held at most, power of two (slot = seq & (JB_SLOTS-1))
+ */
+#define JB_SLOTS            (8)
+
+/**
+ * @def JB_MIN_DEPTH
+ * @brief smallest playout delay in frames
+ */
+#define JB_MIN_DEPTH        (1)
+
+/**
+ * @def JB_MAX_DEPTH
+ * @brief largest playout delay in frames, leaves room for reordering
+ */
+#define JB_MAX_DEPTH        (JB_SLOTS - 2)
+
+/**
+ * @def JB_RESYNC_GAP
+ * @brief sequence jump (either way) taken as a restart of the far end
+ */
+#define JB_RESYNC_GAP       (4 * JB_SLOTS)
+
+/**
+ * @def JB_JITTER_MULT
+ * @brief playout delay covers this many times the mean jitter
+ */
+#define JB_JITTER_MULT      (3)
+
+/**
+ * @def JB_BOOST_DECAY
+ * @brief frames played without underrun before the underrun boost
+ * of the target depth is lowered again by one frame
+ */
+#define JB_BOOST_DECAY      (256)
+
+/**
+ * @def JB_SHRINK_INTERVAL
+ * @brief frames played between two frames discarded to shrink the delay
+ */
+#define JB_SHRINK_INTERVAL  (32)
+
+
+/***************************************************
+            DATA TYPES
+***************************************************/
+
+/** jitter buffer object
+ */
+typedef struct {
+  chunk_t        *slots[JB_SLOTS]; /* frames waiting, indexed by seq */
+  bufferPool_t   *pBuffP;       /* pool to release dropped frames to */
+  int            seqValid;      /* nextSeq is valid (first frame seen) */
+  int            playing;       /* target depth reached, playout running */
+  int            dtx;           /* far end suppresses silence from dtxSeq on */
+  unsigned short dtxSeq;        /* sequence number of the last SID */
+  unsigned short nextSeq;       /* sequence number played next */
+  unsigned short lastSeq;       /* sequence number of the last arrival */
+  unsigned int   lastArrival;   /* cycles at the last arrival */
+  unsigned int   period;        /* mean inter-arrival time per frame [cycles] */
+  unsigned int   jitter;        /* mean deviation from period [cycles] */
+  int            depth;         /* frames buffered at or after nextSeq */
+  int            target;        /* current playout delay [frames] */
+  int            boost;         /* target increase after underruns [frames] */
+  int            sinceUnderrun; /* frames played since the last boost change */
+  int            sinceShrink;   /* frames played since the last discard */
+  unsigned int   late;          /* arrived after their playout time */
+  unsigned int   lost;          /* not arrived at their playout time */
+  unsigned int   underruns;     /* buffer ran empty during playout */
+  unsigned int   discarded;     /* dropped: duplicate, overflow, shrink */
+} jitterBuffer_t;
+
+
+/***************************************************
+            Access Methods
+***************************************************/
+
+/** Initialize jitter buffer
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pBuffP  pointer to buffer pool to return dropped chunks to
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int jitterBuffer_init(jitterBuffer_t *pThis, bufferPool_t *pBuffP);
+
+/** put a received frame
+ *    - ownership of pChunk passes to the jitter buffer
+ *    - late, duplicate and out of window frames are released
+ *    - updates the jitter estimate and the target depth
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pChunk  framed chunk (see frame.h)
+ *
+ * @return Zero on success.
+ * Negative value on failure (chunk dropped).
+ */
+int jitterBuffer_put(jitterBuffer_t *pThis, chunk_t *pChunk);
+
+/** the far end went silent (SID frame received)
+ *    - missing frames from seq on are suppressed silence, not lost
+ *    - the next talkspurt starts with a freshly filled buffer
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param seq  sequence number of the SID frame
+ *
+ * @return void
+ */
+void jitterBuffer_silence(jitterBuffer_t *pThis, unsigned short seq);
+
+/** get the frame due for playout
+ *    - call once per frame the sink needs
+ *    - ownership of the returned chunk passes to the caller
+ *    - a frame missing at its playout time is counted lost (unless
+ *      the far end is silent), *ppChunk is set to NULL and the frame
+ *      time is consumed
+ *    - an empty buffer is counted as underrun, playout then waits until
+ *      the target depth is buffered again
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param ppChunk  pointer pointer to the frame, NULL for a lost frame
+ *
+ * @return Zero if a frame time was consumed.
+ * Negative value if playout is (re)buffering.
+ */
+int jitterBuffer_get(jitterBuffer_t *pThis, chunk_t **ppChunk);
+
+/** frames currently buffered
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return number of frames
+ */
+int jitterBuffer_depth(jitterBuffer_t *pThis);
+
+/** current playout delay
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return target depth in frames
+ */
+int jitterBuffer_target(jitterBuffer_t *pThis);
+
+#endif
@@ -0,0 +1,178 @@
+/**
+ *@file latency.h
+ *
+ *@brief
+ *  - mouth to ear latency measurement over the UART link
+ *
+ *  Every captured chunk carries its capture time (chunk->stamp, cycles
+ *  of the local core, first sample). In latency mode the encoder side
+ *  appends a timing trailer to the payload and sets FRAME_FLAG_TIMING:
+ *
+ *  offset  size  field (LE, cycles of the sender)
+ *    0      4    capture time of the first sample
+ *    4      4    send time of this frame
+ *    8      4    echo: send time of the last frame received
+ *   12      4    hold: time since that frame was received,
+ *                LATENCY_NO_ECHO if none was
+ *
+ *  The echo gives the link round trip (NTP style): a frame sent at T1
+ *  is echoed in a frame sent at T3 after holding it for T3 - T2 and
+ *  received at T4, so rtt = T4 - T1 - hold and the far clock is ahead
+ *  by T3 - T4 + rtt / 2. The offset of the round trip with the
+ *  smallest rtt in a window of LATENCY_WINDOW is used, queueing delay
+ *  only ever adds to the rtt. Audio TX records the one way latency
+ *  when a stamped chunk starts playing (capture time converted to the
+ *  local clock).
+ *
+ *  Send time and hold are taken as the trailer is appended, right
+ *  after encoding, and receive time as the frame is parsed (at most a
+ *  UART RX tick after its last byte). The wait in the UART TX queue,
+ *  the time on the wire and the parse delay therefore count as link
+ *  time each way. They cancel out when both directions see the same,
+ *  as on a loopback; otherwise the offset is off by half the
+ *  difference between the two directions, at most rtt / 2 of the
+ *  round trip it was taken from. The one way latency carries the
+ *  same error.
+ *
+ * Target:   TLL6527v1-0
+ * Compiler: VDSP++     Output format: VDSP++ "*.dxe"
+ *
+ *******************************************************************************/
+#ifndef _LATENCY_H_
+#define _LATENCY_H_
+
+#include "chunk.h"
+
+/***************************************************
+            DEFINES
+***************************************************/
+/**
+ * @def LATENCY_TRAILER_SIZE
+ * @brief bytes of the timing trailer behind the payload
+ */
+#define LATENCY_TRAILER_SIZE	(16)
+
+/**
+ * @def LATENCY_NO_ECHO
+ * @brief hold of a trailer without echo
+ */
+#define LATENCY_NO_ECHO		(0xFFFFFFFF)
+
+/**
+ * @def LATENCY_WINDOW
+ * @brief round trips per clock offset estimate
+ */
+#define LATENCY_WINDOW		(16)
+
+/**
+ * @def LATENCY_BIN_MS
+ * @brief histogram bin width [ms]
+ */
+#define LATENCY_BIN_MS		(5)
+
+/**
+ * @def LATENCY_BINS
+ * @brief histogram bins, the last one takes everything above
+ */
+#define LATENCY_BINS		(40)
+
+
+/***************************************************
+            DATA TYPES
+***************************************************/
+
+/** latency distribution
+ */
+typedef struct {
+  unsigned int       count;
+  unsigned int       min;     /* [cycles] */
+  unsigned int       max;
+  unsigned long long sum;
+  unsigned int       hist[LATENCY_BINS];
+} latency_hist_t;
+
+/** latency measurement object, main loop only
+ */
+typedef struct {
+  int                enabled;     /* stamp frames sent */
+  unsigned int       echoStamp;   /* far send time of the last frame received */
+  unsigned int       echoRx;      /* local time it was received */
+  int                echoValid;
+  unsigned int       offset;      /* far clock - local clock [cycles], wraps: negative if behind */
+  int                offsetValid;
+  unsigned int       bestRtt;     /* smallest rtt of the window */
+  unsigned int       bestOffset;  /* offset of that round trip */
+  int                samples;     /* round trips in the window */
+  latency_hist_t     rtt;         /* link round trip */
+} latency_t;
+
+
+/***************************************************
+            Access Methods
+***************************************************/
+
+/** Initialize latency measurement, off
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int latency_init(latency_t *pThis);
+
+/** clear a distribution
+ *
+ * Parameters:
+ * @param pHist  distribution
+ *
+ * @return void
+ */
+void latency_histInit(latency_hist_t *pHist);
+
+/** add a sample to a distribution (ISR or main loop, one writer)
+ *
+ * Parameters:
+ * @param pHist  distribution
+ * @param cycles  latency [cycles]
+ *
+ * @return void
+ */
+void latency_histRecord(latency_hist_t *pHist, unsigned int cycles);
+
+/** append the timing trailer to a chunk about to be sent
+ *   nothing if latency mode is off or the trailer does not fit
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pChunk  coded chunk, stamp holds the capture time
+ *
+ * @return void
+ */
+void latency_tx(latency_t *pThis, chunk_t *pChunk);
+
+/** take the timing trailer off a received chunk
+ *   updates the round trip and the clock offset; the chunk keeps
+ *   FRAME_FLAG_TIMING and the capture time in the local clock only
+ *   once the offset is known
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pChunk  received chunk
+ *
+ * @return void
+ */
+void latency_rx(latency_t *pThis, chunk_t *pChunk);
+
+/** print a distribution: count, min / mean / max and the non-empty
+ *   bins [ms]
+ *
+ * Parameters:
+ * @param pName  name printed
+ * @param pHist  distribution
+ *
+ * @return void
+ */
+void latency_histReport(const char *pName, latency_hist_t *pHist);
+
+#endif
@@ -0,0 +1,148 @@
+/**
+ *@file mixer.h
+ *
+ *@brief
+ *  - digital mixer in front of audio TX: playback volume and sidetone
+ *
+ *  The volume is a gain on the samples, the codec keeps the level it
+ *  was set to at init (no I2C traffic per change). A new gain is not
+ *  taken at once: per block of MIXER_BLOCK samples the gain moves by
+ *  up to MIXER_RAMP towards it, within the block it is interpolated,
+ *  so a change does not click. The sidetone adds the local capture
+ *  at a low level, it lags by one to two frames (the capture reaches
+ *  the playback a chunk at a time).
+ *
+ *  The samples are taken two at a time, one 32 bit word, with the
+ *  packed 16 bit arithmetic of the Blackfin: both halves multiplied
+ *  by the gain in one instruction (fractional, rounded, saturated),
+ *  the sidetone added with a saturating dual add. At unity gain with
+ *  the sidetone off a chunk is not touched.
+ *
+ * Target:   TLL6527v1-0
+ * Compiler: VDSP++     Output format: VDSP++ "*.dxe"
+ *
+ *******************************************************************************/
+#ifndef _MIXER_H_
+#define _MIXER_H_
+
+#include "chunk.h"
+
+/***************************************************
+            DEFINES
+***************************************************/
+/**
+ * @def MIXER_BLOCK
+ * @brief samples per gain step (2 ms)
+ */
+#define MIXER_BLOCK	(16)
+
+/**
+ * @def MIXER_UNITY
+ * @brief gain 1.0, gains are Q15
+ */
+#define MIXER_UNITY	(32767)
+
+/**
+ * @def MIXER_RAMP
+ * @brief largest gain change per block, full scale in 16 blocks (32 ms)
+ */
+#define MIXER_RAMP	(MIXER_UNITY / 16)
+
+/**
+ * @def MIXER_SIDETONE_MAX
+ * @brief loudest sidetone, Q15 (-12 dB)
+ */
+#define MIXER_SIDETONE_MAX	(8231)
+
+/**
+ * @def MIXER_SIDE_PAIRS
+ * @brief sidetone buffer, sample pairs (two frames of 128 ms)
+ */
+#define MIXER_SIDE_PAIRS	(1024)
+
+
+/***************************************************
+            DATA TYPES
+***************************************************/
+
+/** mixer object
+ */
+typedef struct {
+  int            gain;      /* gain at the end of the last block, Q15 */
+  int            target;    /* gain ramped to, Q15 */
+  int            sidetone;  /* level of the local capture, Q15, 0 off */
+  unsigned int   side[MIXER_SIDE_PAIRS]; /* local capture, two samples per word */
+  unsigned int   sideIn;    /* pairs written */
+  unsigned int   sideOut;   /* pairs mixed or dropped */
+} mixer_t;
+
+
+/***************************************************
+            Access Methods
+***************************************************/
+
+/** Initialize the mixer, unity gain, sidetone off
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int mixer_init(mixer_t *pThis);
+
+/** gain of an attenuation in dB
+ *
+ * Parameters:
+ * @param db  attenuation [dB], 0 or more
+ *
+ * @return gain, Q15
+ */
+int mixer_gainDb(int db);
+
+/** set the playback gain, ramped to from the next chunk on
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param gain  gain, Q15, 0 .. MIXER_UNITY
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int mixer_setGain(mixer_t *pThis, int gain);
+
+/** set the sidetone level
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param level  level of the local capture, Q15, 0 (off) .. MIXER_SIDETONE_MAX
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int mixer_setSidetone(mixer_t *pThis, int level);
+
+/** keep a captured chunk for the sidetone
+ *   nothing is kept with the sidetone off
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pChunk  chunk of 16 bit PCM, not changed
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int mixer_sidetone(mixer_t *pThis, const chunk_t *pChunk);
+
+/** gain and sidetone on a chunk for audio TX, in place
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pChunk  chunk of 16 bit PCM
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int mixer_process(mixer_t *pThis, chunk_t *pChunk);
+
+#endif
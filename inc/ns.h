@@ -0,0 +1,134 @@
+/**
+ *@file ns.h
+ *
+ *@brief
+ *  - noise suppression on the capture path: spectral subtraction with
+ *    a minimum statistics noise estimate
+ *
+ *  The capture is cut into frames of NS_FFT samples, overlapping by
+ *  half (sqrt Hann window before the FFT and again after the inverse,
+ *  overlap-add); the chunk boundaries do not matter, the output lags
+ *  the input by NS_FFT samples (16 ms). Per frame
+ *  - in place fixed point FFT, radix 4 stages plus one radix 2 stage,
+ *    block floating point (a stage scales down only if it could
+ *    overflow); the inverse runs the transposed stages on the spectrum
+ *    as the forward left it, no bit reversal
+ *  - noise power per bin: minimum of the smoothed power over the last
+ *    NS_SUBS sub windows of NS_SUB_FRAMES frames (1.5 s), times a bias
+ *  - gain per bin 1 - NS_OVER noise / power, at least NS_GAIN_MIN,
+ *    averaged with the gain of the frame before (less musical noise)
+ *
+ * Target:   TLL6527v1-0
+ * Compiler: VDSP++     Output format: VDSP++ "*.dxe"
+ *
+ *******************************************************************************/
+#ifndef _NS_H_
+#define _NS_H_
+
+#include "chunk.h"
+
+/***************************************************
+            DEFINES
+***************************************************/
+/**
+ * @def NS_LOG2
+ * @brief log2 of the frame length
+ */
+#define NS_LOG2	(7)
+
+/**
+ * @def NS_FFT
+ * @brief frame length, FFT points
+ */
+#define NS_FFT	(1 << NS_LOG2)
+
+/**
+ * @def NS_HOP
+ * @brief frame advance, half a frame (8 ms)
+ */
+#define NS_HOP	(NS_FFT / 2)
+
+/**
+ * @def NS_BINS
+ * @brief bins of the real spectrum, DC to Nyquist
+ */
+#define NS_BINS	(NS_FFT / 2 + 1)
+
+/**
+ * @def NS_SUB_FRAMES
+ * @brief frames per sub window of the minimum search
+ */
+#define NS_SUB_FRAMES	(24)
+
+/**
+ * @def NS_SUBS
+ * @brief sub windows of the minimum search, 1.5 s in all
+ */
+#define NS_SUBS	(8)
+
+/**
+ * @def NS_OVER
+ * @brief over-subtraction factor
+ */
+#define NS_OVER	(2)
+
+/**
+ * @def NS_GAIN_MIN
+ * @brief gain floor, Q15 (-15 dB)
+ */
+#define NS_GAIN_MIN	(5827)
+
+
+/***************************************************
+            DATA TYPES
+***************************************************/
+
+/** noise suppressor object
+ */
+typedef struct {
+  short          in[NS_FFT];      /* analysis frame, oldest sample first */
+  short          ola[NS_FFT];     /* overlap-add of the synthesis frames */
+  short          out[NS_HOP];     /* output, read while the next hop comes in */
+  int            fill;            /* samples of the hop taken */
+  short          fft[2 * NS_FFT]; /* transform, re and im interleaved */
+  short          win[NS_FFT];     /* sqrt Hann, Q15 */
+  short          twCos[NS_FFT];   /* cos (2 pi k / NS_FFT), Q15 */
+  short          twSin[NS_FFT];   /* sin (2 pi k / NS_FFT), Q15 */
+  unsigned char  pos[NS_FFT];     /* fft[] position of bin k after the forward FFT */
+  unsigned long long power[NS_BINS];  /* smoothed power */
+  unsigned long long minCur[NS_BINS]; /* minimum of the sub window in progress */
+  unsigned long long minSub[NS_SUBS][NS_BINS]; /* minimum of the last sub windows */
+  short          gain[NS_BINS];   /* gain of the last frame, Q15 */
+  int            frames;          /* frames into the sub window in progress */
+  int            sub;             /* sub window written next */
+  unsigned int   count;           /* frames processed */
+} ns_t;
+
+
+/***************************************************
+            Access Methods
+***************************************************/
+
+/** Initialize the noise suppressor, no noise known yet
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int ns_init(ns_t *pThis);
+
+/** suppress the noise in a captured chunk, in place
+ *   any number of samples, the output lags by NS_FFT samples
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pChunk  chunk of 16 bit PCM
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int ns_process(ns_t *pThis, chunk_t *pChunk);
+
+#endif
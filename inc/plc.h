@@ -0,0 +1,150 @@
+/**
+ *@file plc.h
+ *
+ *@brief
+ *  - packet loss concealment for the audio TX path
+ *  - pitch period waveform substitution with progressive attenuation
+ *
+ *  All signal processing runs in the main loop when a chunk is handed
+ *  to audio TX: the history is updated, the pitch is estimated and the
+ *  concealment frames for a loss right after this chunk are synthesized
+ *  ahead of time. On underrun the TX ISR only picks the next prepared
+ *  frame.
+ *
+ *  The frames are synthesized with interrupts enabled, into the bank
+ *  the ISR does not play from; only switching to it is a critical
+ *  section.
+ *
+ * Target:   TLL6527v1-0
+ * Compiler: VDSP++     Output format: VDSP++ "*.dxe"
+ *
+ *******************************************************************************/
+#ifndef _PLC_H_
+#define _PLC_H_
+
+#include <chunk.h>
+
+/***************************************************
+            DEFINES
+***************************************************/
+/**
+ * @def PLC_PITCH_MIN
+ * @brief shortest pitch period searched [samples], 400 Hz at 8 kHz
+ */
+#define PLC_PITCH_MIN   (20)
+
+/**
+ * @def PLC_PITCH_MAX
+ * @brief longest pitch period searched [samples], 50 Hz at 8 kHz
+ */
+#define PLC_PITCH_MAX   (160)
+
+/**
+ * @def PLC_CORR_LEN
+ * @brief correlation window of the pitch search [samples]
+ */
+#define PLC_CORR_LEN    (160)
+
+/**
+ * @def PLC_HIST_LEN
+ * @brief history kept from the last chunk played [samples]
+ */
+#define PLC_HIST_LEN    (PLC_PITCH_MAX + PLC_CORR_LEN)
+
+/**
+ * @def PLC_MAX_FRAMES
+ * @brief consecutive frames concealed, silence after that; the
+ * attenuation reaches zero at the end of the last one
+ */
+#define PLC_MAX_FRAMES  (2)
+
+/**
+ * @def PLC_FADE_LEN
+ * @brief cross-fade from concealment into resumed data [samples],
+ * power of two
+ */
+#define PLC_FADE_LEN    (64)
+
+
+/***************************************************
+            DATA TYPES
+***************************************************/
+
+/** packet loss concealment object
+ */
+typedef struct {
+  chunk_t       conceal[2][PLC_MAX_FRAMES]; /* prepared frames, two banks */
+  chunk_t       silence;    /* played once the concealment ran out */
+  unsigned int  mem[2 * PLC_MAX_FRAMES + 1][CHUNK_WORDS(SAMPLE_SIZE)]; /* storage of the chunks above */
+  short         history[PLC_HIST_LEN]; /* last samples handed to audio TX */
+  int           pitch;      /* pitch period of the history [samples], 0: none yet */
+  volatile int  bank;       /* bank prepared for the next loss run */
+  volatile int  latched;    /* bank the running loss run plays from */
+  volatile int  lost;       /* frames replaced in a row (ISR) */
+  unsigned int  concealed;  /* frames concealed in total */
+  unsigned int  silenced;   /* frames replaced by silence in total */
+} plc_t;
+
+
+/***************************************************
+            Access Methods
+***************************************************/
+
+/** Initialize concealment
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int plc_init(plc_t *pThis);
+
+/** a chunk of 16 bit PCM is about to be played (main loop)
+ *    - cross-fades the chunk start from the concealment if it ends
+ *      a running loss run
+ *    - updates history and pitch, prepares the concealment frames
+ *    - call with interrupts enabled, after the chunk is linked; lost
+ *      and latched are read in the critical section that links it,
+ *      the ISR may end the loss run right after
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pChunk  chunk handed to audio TX
+ * @param next  chunk is played right after the concealment frames
+ * @param lost  plc.lost, read when the chunk was linked
+ * @param latched  plc.latched, read when the chunk was linked
+ *
+ * @return void
+ */
+void plc_update(plc_t *pThis, chunk_t *pChunk, int next, int lost, int latched);
+
+/** replacement for a missing chunk (ISR)
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return chunk to play, owned by plc
+ */
+chunk_t *plc_conceal(plc_t *pThis);
+
+/** real data is played again, ends a loss run (ISR)
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return void
+ */
+void plc_resume(plc_t *pThis);
+
+/** chunk belongs to plc (not to the buffer pool)
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pChunk  chunk to test
+ *
+ * @return non-zero if owned by plc
+ */
+int plc_owns(plc_t *pThis, chunk_t *pChunk);
+
+#endif
@@ -0,0 +1,115 @@
+/**
+ *@file profile.h
+ *
+ *@brief
+ *  - cycle counter profiling of the hot paths: per stage min / max /
+ *    mean and a log2 histogram of the cycles
+ *
+ *  Build with -DPROFILE_ENABLE to profile; without it the probes and
+ *  the report compile to nothing. A stage is recorded from one context
+ *  only (its ISR or the main loop), so no locking is needed; a report
+ *  in the middle of an ISR update may be off by that one sample.
+ *
+ * Target:   TLL6527v1-0
+ * Compiler: VDSP++     Output format: VDSP++ "*.dxe"
+ *
+ *******************************************************************************/
+#ifndef _PROFILE_H_
+#define _PROFILE_H_
+
+#include "cycles.h"
+
+/***************************************************
+            DEFINES
+***************************************************/
+/**
+ * @def PROFILE_BINS
+ * @brief histogram bins, bin n counts samples of 2^(n-1) .. 2^n - 1 cycles
+ */
+#define PROFILE_BINS	(33)
+
+
+/***************************************************
+            DATA TYPES
+***************************************************/
+
+/** profiled stages
+ */
+typedef enum {
+  PROFILE_AUDIO_RX_ISR,
+  PROFILE_AUDIO_TX_ISR,
+  PROFILE_UART_RX_ISR,
+  PROFILE_UART_TX_ISR,
+  PROFILE_CHUNK_COPY,
+  PROFILE_AEC,          /* echo canceller of the capture path */
+  PROFILE_NS,           /* noise suppression of the capture path */
+  PROFILE_AGC,          /* gain control of the capture path */
+  PROFILE_MIX,          /* volume and sidetone of the playout */
+  PROFILE_ENCODE,       /* encoder call of the capture path */
+  PROFILE_DECODE,       /* decoder call of the playout */
+  PROFILE_CAPTURE,      /* audioPlayer_run: code captured chunks */
+  PROFILE_RECEIVE,      /* audioPlayer_run: parse UART RX */
+  PROFILE_PLAYOUT,      /* audioPlayer_run: feed audio TX */
+  PROFILE_NUM
+} profile_id_t;
+
+/** statistics of one stage
+ */
+typedef struct {
+  unsigned int       start;     /* cycle count at PROFILE_BEGIN */
+  unsigned int       count;     /* samples */
+  unsigned int       min;       /* [cycles] */
+  unsigned int       max;
+  unsigned long long sum;
+  unsigned int       hist[PROFILE_BINS];
+} profile_stage_t;
+
+/** all stages
+ */
+typedef struct {
+  profile_stage_t    stage[PROFILE_NUM];
+} profile_t;
+
+
+/***************************************************
+            Access Methods
+***************************************************/
+#ifdef PROFILE_ENABLE
+
+extern profile_t profile;
+
+/** start a stage */
+#define PROFILE_BEGIN(id)	(profile.stage[id].start = cycles_read())
+
+/** end a stage, record the cycles since PROFILE_BEGIN */
+#define PROFILE_END(id)		profile_record(&profile.stage[id], cycles_read() - profile.stage[id].start)
+
+/** print all stages, then restart */
+#define PROFILE_REPORT()	profile_report()
+
+/** record a sample
+ *
+ * Parameters:
+ * @param pStage  stage to record in
+ * @param cycles  cycles of the sample
+ *
+ * @return void
+ */
+void profile_record(profile_stage_t *pStage, unsigned int cycles);
+
+/** print count, min / mean / max and the non-empty histogram bins of
+ *   every stage seen since the last report, then clear all stages
+ *
+ * @return void
+ */
+void profile_report(void);
+
+#else
+
+#define PROFILE_BEGIN(id)	do { } while (0)
+#define PROFILE_END(id)		do { } while (0)
+#define PROFILE_REPORT()	do { } while (0)
+
+#endif
+
+#endif
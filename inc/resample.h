@@ -0,0 +1,102 @@
+/**
+ *@file resample.h
+ *
+ *@brief
+ *  - polyphase FIR sample rate conversion by 2 or 4 for the UART link:
+ *    decimator on the transmit side, interpolator on the receive side
+ *
+ *  Both use the same linear phase low pass (Kaiser window, ~60 dB
+ *  stop band from the lower Nyquist frequency on), Q15 16 bit
+ *  coefficients. The decimator only computes the kept outputs, the
+ *  interpolator runs one phase of the filter per output. Every inner
+ *  loop is a 16 x 16 bit dot product over an even number of taps with
+ *  two accumulators, laid out for the two MACs of the Blackfin. The
+ *  filter state (last taps of the previous chunk) is carried across
+ *  chunks.
+ *
+ * Target:   TLL6527v1-0
+ * Compiler: VDSP++     Output format: VDSP++ "*.dxe"
+ *
+ *******************************************************************************/
+#ifndef _RESAMPLE_H_
+#define _RESAMPLE_H_
+
+#include "chunk.h"
+
+/***************************************************
+            DEFINES
+***************************************************/
+/**
+ * @def RESAMPLE_RATIO_MAX
+ * @brief largest ratio, ratios are 1 (off), 2 and 4
+ */
+#define RESAMPLE_RATIO_MAX	(4)
+
+/**
+ * @def RESAMPLE_TAPS_MAX
+ * @brief taps of the longest filter
+ */
+#define RESAMPLE_TAPS_MAX	(64)
+
+/**
+ * @def RESAMPLE_SAMPLES_MAX
+ * @brief samples of the largest chunk
+ */
+#define RESAMPLE_SAMPLES_MAX	(SAMPLE_SIZE / 2)
+
+
+/***************************************************
+            DATA TYPES
+***************************************************/
+
+/** resampler object, one per direction
+ */
+typedef struct {
+  int            ratio;   /* 1, 2 or 4 */
+  int            taps;    /* filter taps (decimator) or taps per phase (interpolator) */
+  const short    *pCoef;  /* low pass of the ratio, Q15 */
+  short          phase[RESAMPLE_TAPS_MAX]; /* interpolator: one phase after the other, times ratio */
+  short          work[RESAMPLE_TAPS_MAX + RESAMPLE_SAMPLES_MAX]; /* history, then the chunk */
+} resample_t;
+
+
+/***************************************************
+            Access Methods
+***************************************************/
+
+/** Initialize a resampler, filter state cleared
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param ratio  1 (pass through), 2 or 4
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int resample_init(resample_t *pThis, int ratio);
+
+/** low pass and keep every ratio-th sample, in place
+ *   pChunk->len shrinks by the ratio
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pChunk  chunk of 16 bit PCM, samples a multiple of the ratio
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int resample_decimate(resample_t *pThis, chunk_t *pChunk);
+
+/** insert ratio-1 samples after every sample and low pass, in place
+ *   pChunk->len grows by the ratio
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pChunk  chunk of 16 bit PCM, size for ratio times the samples
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int resample_interpolate(resample_t *pThis, chunk_t *pChunk);
+
+#endif
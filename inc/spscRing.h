@@ -0,0 +1,128 @@
+/**
+ *@file spscRing.h
+ *
+ *@brief
+ *  - single producer / single consumer ring of pointers between one
+ *    ISR and the main loop
+ *
+ *  The producer only writes head, the consumer only writes tail. Both
+ *  run free and wrap at 2^32, the fill level is their difference, so
+ *  all slots can be used and no interrupts are masked. The slot is
+ *  written before head is advanced (and read before tail is advanced),
+ *  the volatile accesses keep that order on the single core.
+ *
+ *  The consumer role may pass between the ISR and the main loop, as
+ *  long as only one of them gets at a time. The UART TX ring works
+ *  that way: the DMA11 ISR consumes while the DMA runs; once it has
+ *  found the ring empty and cleared uartTx.running, the ISR no longer
+ *  fires and the main loop is the consumer, it takes the first item
+ *  to start the DMA. The main loop checks running and gets under
+ *  critical_enter, so the ISR cannot be between a failed get and
+ *  clearing running at that point.
+ *
+ * Target:   TLL6527v1-0
+ * Compiler: VDSP++     Output format: VDSP++ "*.dxe"
+ *
+ *******************************************************************************/
+#ifndef _SPSC_RING_H_
+#define _SPSC_RING_H_
+
+/***************************************************
+            DEFINES
+***************************************************/
+/**
+ * @def SPSCRING_SIZE_MAX
+ * @brief most slots of a ring, a power of two
+ */
+#define SPSCRING_SIZE_MAX	(16)
+
+
+/***************************************************
+            DATA TYPES
+***************************************************/
+
+/** SPSC ring object
+ */
+typedef struct {
+  void * volatile       slot[SPSCRING_SIZE_MAX]; /* items */
+  volatile unsigned int head;   /* next slot to put, producer only */
+  volatile unsigned int tail;   /* next slot to get, consumer only */
+  unsigned int          size;   /* slots used, a power of two */
+} spscRing_t;
+
+
+/***************************************************
+            Access Methods
+***************************************************/
+
+/** Initialize the ring empty
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param size  slots, a power of two up to SPSCRING_SIZE_MAX
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int spscRing_init(spscRing_t *pThis, unsigned int size);
+
+/** put an item (producer side)
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pItem  item to put
+ *
+ * @return Zero on success.
+ * Negative value on failure (ring full).
+ */
+int spscRing_put(spscRing_t *pThis, void *pItem);
+
+/** get the oldest item (consumer side)
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param ppItem  pointer to the item taken
+ *
+ * @return Zero on success.
+ * Negative value on failure (ring empty).
+ */
+int spscRing_get(spscRing_t *pThis, void **ppItem);
+
+/** items in the ring
+ *   exact on either side, may be one behind for the other side
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return item count
+ */
+static inline unsigned int spscRing_count(spscRing_t *pThis)
+{
+	return pThis->head - pThis->tail;
+}
+
+/** check if the ring is empty
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return 1 if empty, 0 otherwise
+ */
+static inline int spscRing_isEmpty(spscRing_t *pThis)
+{
+	return pThis->head == pThis->tail;
+}
+
+/** check if the ring is full
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return 1 if full, 0 otherwise
+ */
+static inline int spscRing_isFull(spscRing_t *pThis)
+{
+	return pThis->head - pThis->tail >= pThis->size;
+}
+
+#endif
@@ -0,0 +1,128 @@
+/**
+ *@file telemetry.h
+ *
+ *@brief
+ *  - per path counters: chunks in / out, drops by reason, pool empty
+ *    events, underruns, queue high-water mark
+ *
+ *  Every counter has a single writer (ISR or main loop) and only ever
+ *  counts up, so no locking is needed. Snapshot and reset work on
+ *  differences against a baseline copy and never write the live
+ *  counters (except the high-water mark, see telemetry_reset).
+ *
+ * Target:   TLL6527v1-0
+ * Compiler: VDSP++     Output format: VDSP++ "*.dxe"
+ *
+ *******************************************************************************/
+#ifndef _TELEMETRY_H_
+#define _TELEMETRY_H_
+
+/***************************************************
+            DATA TYPES
+***************************************************/
+
+/** reasons a chunk is dropped
+ */
+typedef enum {
+  TELEMETRY_DROP_QUEUE_FULL,  /* next stage did not take it */
+  TELEMETRY_DROP_NO_BUFFER,   /* no chunk to continue with (pool empty) */
+  TELEMETRY_DROP_CORRUPT,     /* bad frame header or CRC */
+  TELEMETRY_DROP_LINK_LOSS,   /* missing in the received sequence */
+  TELEMETRY_DROP_INVALID,     /* could not be framed / decoded */
+  TELEMETRY_DROP_NUM
+} telemetry_drop_t;
+
+/** counters of one path
+ */
+typedef struct {
+  unsigned int  in;           /* chunks entering the queue */
+  unsigned int  out;          /* chunks leaving the queue */
+  unsigned int  drops[TELEMETRY_DROP_NUM]; /* chunks dropped, by reason */
+  unsigned int  poolEmpty;    /* buffer pool acquire failed */
+  unsigned int  underruns;    /* sink found nothing to process */
+  unsigned int  queueHigh;    /* most chunks queued at once */
+} telemetry_t;
+
+
+/***************************************************
+            Access Methods
+***************************************************/
+
+/** count a chunk entering the queue (producer side)
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return void
+ */
+static inline void telemetry_in(telemetry_t *pThis)
+{
+	unsigned int level;
+
+	pThis->in++;
+	level = pThis->in - pThis->out;
+	if ( level > pThis->queueHigh ) {
+		pThis->queueHigh = level;
+	}
+}
+
+/** count a chunk leaving the queue (consumer side)
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return void
+ */
+static inline void telemetry_out(telemetry_t *pThis)
+{
+	pThis->out++;
+}
+
+/** count dropped chunks
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param reason  TELEMETRY_DROP_xxx
+ * @param count  number of chunks
+ *
+ * @return void
+ */
+static inline void telemetry_drop(telemetry_t *pThis, telemetry_drop_t reason, unsigned int count)
+{
+	pThis->drops[reason] += count;
+}
+
+/** initialize counters
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return void
+ */
+void telemetry_init(telemetry_t *pThis);
+
+/** counters since the last reset
+ *
+ * Parameters:
+ * @param pThis  live counters
+ * @param pBase  baseline taken at the last reset
+ * @param pSnap  result
+ *
+ * @return void
+ */
+void telemetry_snapshot(const telemetry_t *pThis, const telemetry_t *pBase, telemetry_t *pSnap);
+
+/** start a new measurement interval
+ *    - baseline = live counters
+ *    - the high-water mark restarts at the current queue level, it is
+ *      the only live field written; a concurrent update may be lost
+ *
+ * Parameters:
+ * @param pThis  live counters
+ * @param pBase  baseline to update
+ *
+ * @return void
+ */
+void telemetry_reset(telemetry_t *pThis, telemetry_t *pBase);
+
+#endif
@@ -1,29 +1,99 @@
 #ifndef _UART_RX_H_
 #define _UART_RX_H_
 
-#include "queue.h"
 #include "bufferPool.h"
 #include "isrDisp.h"
+#include "event.h"
+#include "frame.h"
+#include "telemetry.h"
 
 /***************************************************
 * 		DEFINES
 ***************************************************/
 /**
- * @def UARTRX_QUEUE_DEPTH
- * @brief rx queue depth
+ * @def UARTRX_RING_SIZE
+ * @brief bytes in the circular DMA receive buffer (power of 2), holds a
+ * frame of maximum length plus the bytes arriving while it is parsed
  */
-#define UARTRX_QUEUE_DEPTH	7
+#define UARTRX_RING_SIZE	4096
+
+/**
+ * @def UARTRX_ROW_SIZE
+ * @brief the ring is run as 2D DMA, one interrupt per row of this size
+ */
+#define UARTRX_ROW_SIZE		512
+
+/**
+ * @def UARTRX_TICK_CYCLES
+ * @brief period of the core timer tick that wakes the main loop on
+ * received bytes [core cycles]: the row interrupt alone leaves a frame
+ * shorter than a row in the ring until the next audio wakeup
+ */
+#define UARTRX_TICK_CYCLES	(CYCLES_PER_MS)
+
+/**
+ * @def UARTRX_CHAR_CYCLES
+ * @brief core cycles per character, 10 bits at 115200 baud, 600 MHz
+ */
+#define UARTRX_CHAR_CYCLES	(52083)
+
+/**
+ * @def UARTRX_RF_GAP_MS
+ * @brief longest pause the radio link puts into a byte stream [ms]: a
+ * transparent RF modem sends what it buffered once its packetization
+ * timeout expires, the rest of a frame follows in the next RF packet
+ */
+#define UARTRX_RF_GAP_MS	(20)
+
+/**
+ * @def UARTRX_IDLE_CYCLES
+ * @brief line idle timeout in core cycles for frames of the given
+ * number of samples; a frame still incomplete after the line was quiet
+ * that long is flushed
+ *
+ * A few character times are far too short on a radio link: the modem
+ * may hold the tail of a frame back until the next frame fills its RF
+ * packet (a frame time), the header may arrive a character at a time
+ * and the RF packetization adds its own gap. Flushing earlier drops a
+ * frame that is still coming and resyncs into its payload.
+ */
+#define UARTRX_IDLE_CYCLES(samples)	((samples) * (CYCLES_PER_MS / 8) \
+                                	 + FRAME_HDR_SIZE * UARTRX_CHAR_CYCLES \
+                                	 + UARTRX_RF_GAP_MS * CYCLES_PER_MS)
 
 
 /***************************************************
 * 		DATA TYPES
 ***************************************************/
+/** receive state of the framing layer
+ */
+typedef enum {
+  UARTRX_HUNT,		/* scan the stream for a sync word */
+  UARTRX_HEADER,	/* wait for the rest of the frame header */
+  UARTRX_PAYLOAD	/* wait for the payload of a valid header */
+} uartRx_state_t;
+
 /** uart RX object
  */
 typedef struct {
-  queue_t        queue;  	/* queue for received buffers */
-  chunk_t        *pPending; /* pointer to pending chunk just in receiving */
+  unsigned char  ring[UARTRX_RING_SIZE];	/* DMA10 autobuffer */
+  volatile unsigned int rows;	/* ring rows completed, ISR counted */
+  unsigned int   rdPos;		/* stream position of the next byte to parse */
+  unsigned int   frameStart;	/* stream position of the frame in parsing */
+  unsigned int   lastPos;	/* stream position at the last poll */
+  unsigned int   lastCycles;	/* time the line was last seen active */
+  unsigned int   idleCycles;	/* line idle timeout, UARTRX_IDLE_CYCLES of the frame */
+  unsigned char  hdr[FRAME_HDR_SIZE];	/* header of the frame in parsing */
+  int            len;		/* its payload length */
   bufferPool_t   *pBuffP; 	/* pointer to buffer pool */
+  event_t        *pEvent;	/* EVENT_UART_RX per ring row and tick with bytes */
+  uartRx_state_t state;		/* what the parser waits for */
+  int            seqValid;	/* expectSeq is valid (first frame seen) */
+  unsigned short expectSeq;	/* sequence number of the next frame */
+  int            silent;	/* last frame was a SID, gaps are suppressed silence */
+  unsigned int   bytesSkipped;	/* bytes discarded while resynchronizing */
+  unsigned int   overruns;	/* DMA overwrote bytes not yet parsed */
+  telemetry_t    stats;		/* frames delivered / dropped */
 } uartRx_t;
 
 
@@ -31,35 +101,37 @@ typedef struct {
 * 		Access Methods
 ***************************************************/
 /** Configure the UART DMA
- * Configures the DMA rx with the buffer and the buffer length to
- * receive
+ * Configures DMA10 to write the ring buffer circularly (autobuffer),
+ * 2D with one interrupt per ring row
  * Parameters:
- * @param pchunk  pointer to receive chunk
+ * @param pThis  pointer to own object
  *
  * @return void
  */
-void uartRx_dmaConfig(chunk_t* cPtr);
+void uartRx_dmaConfig(uartRx_t *pThis);
 
 /** Initialize uart rx
  *    - get pointer to buffer pool
  *    - register interrupt handler
- *    - initialize RX queue
+ *    - reset the frame parser
 
  * Parameters:
  * @param pThis  pointer to own object
  * @param pBuffP  pointer to buffer pool to take and return chunks from
  * @param pIsrDisp   pointer to interrupt dispatcher to get ISR registered
+ * @param pEvent  events to post to the main loop, NULL for none
  *
  * @return Zero on success.
  * Negative value on failure.
  */
-int uartRx_init(uartRx_t *pThis, bufferPool_t *pBuffP, isrDisp_t *pIsrDisp);
+int uartRx_init(uartRx_t *pThis, bufferPool_t *pBuffP, isrDisp_t *pIsrDisp,
+                event_t *pEvent);
 
 /** start uart rx
- *    - start receiving first chunk from DMA
- * 		- acquire chunk from pool
- *      - config DMA
- *      - start DMA + SPORT
+ *    - set the line idle timeout for the frame duration of the pool
+ *    - start the circular DMA into the ring
+ *    - enable the UART receive DMA request
+ *    - start the core timer tick (UARTRX_TICK_CYCLES)
  * Parameters:
  * @param pThis  pointer to own object
  *
@@ -69,6 +141,9 @@ int uartRx_init(uartRx_t *pThis, bufferPool_t *pBuffP, isrDisp_t *pIsrDisp);
 int uartRx_start(uartRx_t *pThis);
 
 /** uartRx_isr
+ *   - a ring row is complete, count it
+ *   - post EVENT_UART_RX
+ *   - the DMA runs on, frames are parsed in uartRx_getNbNc
 
  * Parameters:
  * @param pThisArg  pointer to own object
@@ -79,8 +154,8 @@ void uartRx_isr(void *pThisArg);
 
 /** uart rx get
  *   copies a filled chunk into pChunk
- *   blocking call, blocks if queue is empty
- *     - get from queue
+ *   does not block, fails if no complete frame was received
+ *     - get next frame
  *     - copy in to pChunk
  *     - release chunk to buffer pool
  * Parameters:
@@ -92,8 +167,24 @@ void uartRx_isr(void *pThisArg);
  */
 int uartRx_get(uartRx_t *pThis, chunk_t *pChunk);
 
+/** uart rx get
+ *    non-blocking
+ *    no copy
+ *    parses the bytes received so far, returns a frame as soon as its
+ *    last byte is in the ring
+ *    caller is responsible for releasing the buffer
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param ppChunk Pointer Pointer to chunk object
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int uartRx_getNbNc(uartRx_t *pThis, chunk_t **ppChunk);
+
 /* uart rx dma stop
- * - empty for now
+ * - disables the receive DMA request, DMA10 and the tick
  *
  * @return
  */
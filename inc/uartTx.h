@@ -1,18 +1,19 @@
 #ifndef _UART_TX_H_
 #define _UART_TX_H_
 
-#include "queue.h"
+#include "spscRing.h"
 #include "bufferPool.h"
 #include "isrDisp.h"
+#include "telemetry.h"
 
 /***************************************************
 * 		DEFINES
 ***************************************************/
 /**
  * @def UARTTX_QUEUE_DEPTH
- * @brief tx queue depth
+ * @brief tx queue depth, a power of two
  */
-#define UARTTX_QUEUE_DEPTH	7
+#define UARTTX_QUEUE_DEPTH	8
 
 
 /***************************************************
@@ -21,10 +22,13 @@
 /** uart TX object
  */
 typedef struct {
-  queue_t		queue;		/* queue for received buffers */
+  spscRing_t	queue;		/* frames to send, main loop to ISR */
   chunk_t		*pPending; 	/* pointer to pending chunk just in receiving */
   bufferPool_t	*pBuffP; 	/* pointer to buffer pool */
-  int 			running;
+  volatile int	running;	/* DMA busy, cleared by the ISR when the queue runs dry;
+  				   while clear the main loop consumes the queue */
+  unsigned short	seq;		/* sequence number of the next frame time */
+  telemetry_t	stats;		/* frames queued / sent / dropped */
 } uartTx_t;
 
 
@@ -32,10 +36,9 @@ typedef struct {
 * 		Access Methods
 ***************************************************/
 /** Configure the UART DMA
- * Configures the DMA tx with the buffer and the buffer length to
- * receive
+ * Configures the DMA tx to send the framed chunk, header + payload
  * Parameters:
- * @param pchunk  pointer to receive chunk
+ * @param pchunk  pointer to framed chunk
  *
  * @return void
  */
@@ -89,6 +92,31 @@ void uartTx_isr(void *pThisArg);
  */
 int uartTx_put(uartTx_t *pThis, chunk_t *pChunk);
 
+/** uart tx put
+ *    no copy
+ *    frames the chunk (header in the chunk headroom)
+ *    ownership of pChunk passes to uartTx, the ISR releases it
+ *    to the buffer pool once sent (or right away when dropped)
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pChunk  chunk acquired from the buffer pool
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int uartTx_putNc(uartTx_t *pThis, chunk_t *pChunk);
+
+/** uart tx skip
+ *   a frame time passes without a frame (suppressed silence),
+ *   the receiver sees the gap in the sequence numbers
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return void
+ */
+void uartTx_skip(uartTx_t *pThis);
+
 /* uart tx dma stop
  * - empty for now
  *
@@ -0,0 +1,115 @@
+/**
+ *@file vad.h
+ *
+ *@brief
+ *  - voice activity detection for the transmit path
+ *  - energy (mean magnitude) + zero crossing rate against a tracked
+ *    noise floor, with hangover
+ *  - builds SID (silence descriptor) frames for suppressed silence
+ *
+ * Target:   TLL6527v1-0
+ * Compiler: VDSP++     Output format: VDSP++ "*.dxe"
+ *
+ *******************************************************************************/
+#ifndef _VAD_H_
+#define _VAD_H_
+
+#include <chunk.h>
+
+/***************************************************
+            DEFINES
+***************************************************/
+/**
+ * @def VAD_LEVEL_MIN
+ * @brief mean magnitude always taken as silence
+ */
+#define VAD_LEVEL_MIN       (24)
+
+/**
+ * @def VAD_LEVEL_RATIO
+ * @brief speech if the level exceeds the noise floor this many times
+ */
+#define VAD_LEVEL_RATIO     (3)
+
+/**
+ * @def VAD_ZCR_DELTA
+ * @brief speech if the level exceeds 1.5x the noise floor and the zero
+ * crossings differ from the noise by more than 1 in VAD_ZCR_DELTA samples
+ * (unvoiced sounds)
+ */
+#define VAD_ZCR_DELTA       (8)
+
+/**
+ * @def VAD_HANGOVER
+ * @brief frames still sent after the last speech frame
+ */
+#define VAD_HANGOVER        (2)
+
+/**
+ * @def VAD_SID_INTERVAL
+ * @brief frames between two SID frames during silence
+ */
+#define VAD_SID_INTERVAL    (8)
+
+
+/***************************************************
+            DATA TYPES
+***************************************************/
+
+/** decision for one chunk
+ */
+typedef enum {
+  VAD_SPEECH,   /* send the chunk */
+  VAD_SID,      /* send a SID frame instead */
+  VAD_SILENT    /* send nothing */
+} vad_decision_t;
+
+/** voice activity detector object
+ */
+typedef struct {
+  int           noiseLevel;   /* noise floor, mean magnitude */
+  int           noiseZcr;     /* zero crossings of the noise per chunk */
+  int           hangover;     /* speech frames still to send */
+  int           sinceSid;     /* frames since the last SID */
+  unsigned int  speech;       /* chunks sent */
+  unsigned int  sid;          /* SID frames sent */
+  unsigned int  silent;       /* chunks suppressed */
+} vad_t;
+
+
+/***************************************************
+            Access Methods
+***************************************************/
+
+/** Initialize voice activity detection
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int vad_init(vad_t *pThis);
+
+/** classify a chunk of 16 bit PCM
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pChunk  captured chunk
+ *
+ * @return VAD_SPEECH, VAD_SID or VAD_SILENT
+ */
+vad_decision_t vad_process(vad_t *pThis, chunk_t *pChunk);
+
+/** turn a chunk into a SID frame with the current noise level
+ *   (COMPRESSION_HDR_SIZE bytes, see compression.h)
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pChunk  chunk to overwrite
+ *
+ * @return void
+ */
+void vad_sid(vad_t *pThis, chunk_t *pChunk);
+
+#endif
@@ -0,0 +1,346 @@
+/**
+ *@file aec.c
+ *
+ *@brief
+ *  - NLMS acoustic echo canceller with Geigel double talk detection,
+ *    see aec.h
+ *
+ * Target:   TLL6527v1-0
+ * Compiler: VDSP++     Output format: VDSP++ "*.dxe"
+ *
+ *******************************************************************************/
+#include "tll_common.h"
+#include "aec.h"
+
+/**
+ * @def AEC_REF_MASK
+ * @brief ring index of a sample position
+ */
+#define AEC_REF_MASK	(AEC_REF_SIZE - 1)
+
+/**
+ * @def AEC_DELTA
+ * @brief regularization of the far end energy, the energy of the taps
+ * at AEC_FAR_MIN
+ */
+#define AEC_DELTA	(AEC_TAPS * ((AEC_FAR_MIN * AEC_FAR_MIN) >> 8))
+
+
+/** saturate to 16 bit
+ *
+ * Parameters:
+ * @param value  value to saturate
+ *
+ * @return value in [-32768, 32767]
+ */
+static int aec_sat(int value)
+{
+	if ( 32767 < value ) {
+		return 32767;
+	} else if ( -32768 > value ) {
+		return -32768;
+	}
+	return value;
+}
+
+
+/** Initialize the echo canceller, no echo path known yet
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int aec_init(aec_t *pThis)
+{
+	int count;
+
+	if ( NULL == pThis ) {
+		return FAIL;
+	}
+
+	for ( count = 0; AEC_TAPS > count; count++ ) {
+		pThis->w[count] = 0;
+	}
+	for ( count = 0; AEC_REF_SIZE > count; count++ ) {
+		pThis->ref[count] = 0;
+	}
+	pThis->refEnd   = 0;
+	pThis->hangover = 0;
+
+	pThis->stats.blocks     = 0;
+	pThis->stats.farIdle    = 0;
+	pThis->stats.doubleTalk = 0;
+	pThis->stats.micEnergy  = 0;
+	pThis->stats.errEnergy  = 0;
+	return PASS;
+}
+
+
+/** far end reference, the samples of a chunk put for playback
+ *   the positions skipped since the last chunk are silence
+ *
+ * Parameters:
+ * @param pThis  pointer to own object, nothing done if NULL
+ * @param pChunk  chunk of 16 bit PCM
+ * @param pos  absolute sample position its first sample plays at
+ *
+ * @return void
+ */
+void aec_reference(aec_t *pThis, chunk_t *pChunk, unsigned int pos)
+{
+	unsigned int gap;
+	int samples;
+	int count;
+
+	if ( NULL == pThis || NULL == pChunk ) {
+		return;
+	}
+
+	// concealed frame times, no reference
+	gap = pos - pThis->refEnd;
+	if ( 0 < (int) gap ) {
+		if ( AEC_REF_SIZE < gap ) {
+			gap = AEC_REF_SIZE;
+		}
+		for ( ; 0 < gap; gap-- ) {
+			pThis->ref[(pos - gap) & AEC_REF_MASK] = 0;
+		}
+	}
+
+	samples = pChunk->len / 2;
+	for ( count = 0; samples > count; count++ ) {
+		pThis->ref[(pos + count) & AEC_REF_MASK] = pChunk->s16_buff[count];
+	}
+	pThis->refEnd = pos + samples;
+}
+
+
+/** fetch far end samples into the block work buffer
+ *   positions not in the ring (not written yet, or overwritten) are
+ *   silence
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pos  position of the oldest sample
+ * @param count  samples
+ *
+ * @return peak magnitude of the samples
+ */
+static int aec_fetch(aec_t *pThis, unsigned int pos, int count)
+{
+	unsigned int age;
+	int peak = 0;
+	int value;
+	int index;
+
+	for ( index = 0; count > index; index++, pos++ ) {
+		age   = pThis->refEnd - pos;
+		value = 0;
+		if ( 0 < age && AEC_REF_SIZE >= age ) {
+			value = pThis->ref[pos & AEC_REF_MASK];
+		}
+		pThis->x[index] = (short) value;
+		if ( 0 > value ) {
+			value = -value;
+		}
+		if ( value > peak ) {
+			peak = value;
+		}
+	}
+	return peak;
+}
+
+
+/** echo estimate of one sample
+ *   two accumulators over tap pairs (dual MAC), upper 16 bit of the
+ *   taps: Q14 x Q15
+ *
+ * Parameters:
+ * @param pW  taps, oldest first
+ * @param pX  far end, oldest first
+ *
+ * @return echo estimate, Q15
+ */
+static int aec_dot(const int *pW, const short *pX)
+{
+	int acc0 = 0;
+	int acc1 = 0;
+	int count;
+
+	for ( count = 0; AEC_TAPS > count; count += 2 ) {
+		acc0 += (pW[count] >> 16)     * pX[count];
+		acc1 += (pW[count + 1] >> 16) * pX[count + 1];
+	}
+	return (acc0 + acc1 + (1 << 13)) >> 14;
+}
+
+
+/** NLMS update of all taps, w += g x
+ *
+ * Parameters:
+ * @param pW  taps, oldest first
+ * @param pX  far end, oldest first
+ * @param gain  normalized step times error, Q15
+ *
+ * @return void
+ */
+static void aec_update(int *pW, const short *pX, int gain)
+{
+	int count;
+
+	for ( count = 0; AEC_TAPS > count; count += 2 ) {
+		pW[count]     += gain * pX[count];
+		pW[count + 1] += gain * pX[count + 1];
+	}
+}
+
+
+/** cancel the echo in one block
+ *   pThis->x holds the far end from AEC_TAPS - 1 samples before the
+ *   block to its last sample
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pD  microphone samples, replaced by the echo free ones
+ * @param count  samples, up to AEC_BLOCK
+ * @param farPeak  peak magnitude of the far end in pThis->x
+ *
+ * @return void
+ */
+static void aec_block(aec_t *pThis, short *pD, int count, int farPeak)
+{
+	long long factor = 0;
+	unsigned int micEnergy = 0;
+	unsigned int errEnergy = 0;
+	int nearPeak = 0;
+	int energy = 0;
+	int shift = 16;
+	int adapt;
+	int index;
+	int err;
+
+	pThis->stats.blocks++;
+
+	// Geigel: the echo is at least 6 dB below the far end peak
+	for ( index = 0; count > index; index++ ) {
+		err = 0 > pD[index] ? -pD[index] : pD[index];
+		if ( err > nearPeak ) {
+			nearPeak = err;
+		}
+	}
+	if ( nearPeak > (farPeak >> 1) ) {
+		pThis->hangover = AEC_HANGOVER;
+	}
+	adapt = 0 == pThis->hangover;
+	if ( !adapt ) {
+		pThis->hangover--;
+		pThis->stats.doubleTalk++;
+	}
+
+	/* step size mu / |x|^2 once per block, over the taps of its last
+	 * sample: gain = (err * factor) >> shift, factor 15 bit */
+	if ( adapt ) {
+		for ( index = count - 1; AEC_TAPS + count - 1 > index; index++ ) {
+			energy += (pThis->x[index] * pThis->x[index]) >> 8;
+		}
+		factor = ((long long) AEC_MU << 23) / (energy + AEC_DELTA);
+		while ( 32767 < factor && 0 < shift ) {
+			factor >>= 1;
+			shift--;
+		}
+		if ( 32767 < factor ) {
+			factor = 32767;
+		}
+	}
+
+	for ( index = 0; count > index; index++ ) {
+		err = aec_sat(pD[index] - aec_dot(pThis->w, &pThis->x[index]));
+		if ( adapt ) {
+			aec_update(pThis->w, &pThis->x[index],
+			           aec_sat((err * (int) factor) >> shift));
+			micEnergy += (pD[index] * pD[index]) >> 8;
+			errEnergy += (err * err) >> 8;
+		}
+		pD[index] = (short) err;
+	}
+
+	pThis->stats.micEnergy += micEnergy;
+	pThis->stats.errEnergy += errEnergy;
+}
+
+
+/** cancel the echo in a captured chunk, in place
+ *   block by block, each with the far end played AEC_DELAY samples
+ *   before its capture time and the AEC_TAPS - 1 samples before that
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pChunk  chunk of 16 bit PCM
+ * @param pos  far end position playing when its first sample was
+ *             captured (see audioTx_position)
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int aec_process(aec_t *pThis, chunk_t *pChunk, unsigned int pos)
+{
+	int samples;
+	int start;
+	int count;
+	int farPeak;
+
+	if ( NULL == pThis || NULL == pChunk ) {
+		return FAIL;
+	}
+
+	samples = pChunk->len / 2;
+	pos    -= AEC_DELAY + AEC_TAPS - 1;
+	for ( start = 0; samples > start; start += count ) {
+		count = samples - start;
+		if ( AEC_BLOCK < count ) {
+			count = AEC_BLOCK;
+		}
+
+		farPeak = aec_fetch(pThis, pos + start, AEC_TAPS - 1 + count);
+		if ( AEC_FAR_MIN > farPeak ) {
+			// far end silent, no echo
+			pThis->stats.farIdle++;
+			if ( 0 < pThis->hangover ) {
+				pThis->hangover--;
+			}
+			continue;
+		}
+		aec_block(pThis, &pChunk->s16_buff[start], count, farPeak);
+	}
+	return PASS;
+}
+
+
+/** print the statistics since the last report, then restart them
+ *   echo left: energy after / before cancellation in the blocks that
+ *   adapted (far end only), in 1/1000
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return void
+ */
+void aec_report(aec_t *pThis)
+{
+	aec_stats_t *pStats = &pThis->stats;
+	unsigned int left = 0;
+
+	if ( 0 != pStats->micEnergy ) {
+		left = (unsigned int) (pStats->errEnergy * 1000 / pStats->micEnergy);
+	}
+	printf("[AEC]: %u blocks, far end idle %u, double talk %u, echo left %u/1000\r\n",
+	       pStats->blocks, pStats->farIdle, pStats->doubleTalk, left);
+
+	pStats->blocks     = 0;
+	pStats->farIdle    = 0;
+	pStats->doubleTalk = 0;
+	pStats->micEnergy  = 0;
+	pStats->errEnergy  = 0;
+}
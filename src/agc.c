@@ -0,0 +1,179 @@
+/**
+ *@file agc.c
+ *
+ *@brief
+ *  - automatic gain control with noise gate, see agc.h
+ *
+ * Target:   TLL6527v1-0
+ * Compiler: VDSP++     Output format: VDSP++ "*.dxe"
+ *
+ *******************************************************************************/
+#include "tll_common.h"
+#include "agc.h"
+
+/**
+ * @def AGC_FULL_SCALE
+ * @brief largest sample magnitude times unity gain
+ */
+#define AGC_FULL_SCALE	(32767 * AGC_UNITY)
+
+
+/** envelope coefficient per block for a time constant
+ *   block duration / time constant, Q15
+ *
+ * Parameters:
+ * @param ms  time constant [ms]
+ *
+ * @return coefficient, Q15
+ */
+static int agc_rate(int ms)
+{
+	int rate = 32768 * AGC_BLOCK / (8 * ms);
+
+	if ( 32767 < rate ) {
+		return 32767;
+	} else if ( 1 > rate ) {
+		return 1;
+	}
+	return rate;
+}
+
+
+/** Initialize the AGC, unity gain
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pConfig  target level and limits, read per chunk
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int agc_init(agc_t *pThis, const agc_config_t *pConfig)
+{
+	if ( NULL == pThis || PASS != agc_check(pConfig) ) {
+		return FAIL;
+	}
+
+	pThis->pConfig  = pConfig;
+	pThis->envelope = 0;
+	pThis->gain     = AGC_UNITY;
+	pThis->gated    = 0;
+	pThis->limited  = 0;
+	return PASS;
+}
+
+
+/** check a configuration
+ *
+ * Parameters:
+ * @param pConfig  target level and limits
+ *
+ * @return Zero if valid.
+ * Negative value otherwise.
+ */
+int agc_check(const agc_config_t *pConfig)
+{
+	if ( NULL == pConfig
+	     || 0 >= pConfig->target || 32767 < pConfig->target
+	     || 0 >= pConfig->gainMin || pConfig->gainMin > pConfig->gainMax || 32767 < pConfig->gainMax
+	     || 0 > pConfig->gate || 0 >= pConfig->gateGain || 32767 < pConfig->gateGain
+	     || 0 >= pConfig->attackMs || 0 >= pConfig->releaseMs ) {
+		return FAIL;
+	}
+	return PASS;
+}
+
+
+/** level a captured chunk, in place
+ *   per block: peak, envelope, gain aimed at; the samples get the gain
+ *   ramped from the last block to this one
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pChunk  chunk of 16 bit PCM
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int agc_process(agc_t *pThis, chunk_t *pChunk)
+{
+	const agc_config_t *pConfig;
+	short *pData;
+	int attack;
+	int release;
+	int samples;
+	int start;
+	int count;
+	int index;
+	int peak;
+	int value;
+	int target;
+	int gain;
+	int step;
+
+	if ( NULL == pThis || NULL == pChunk ) {
+		return FAIL;
+	}
+
+	pConfig = pThis->pConfig;
+	attack  = agc_rate(pConfig->attackMs);
+	release = agc_rate(pConfig->releaseMs);
+	samples = pChunk->len / 2;
+
+	for ( start = 0; samples > start; start += count ) {
+		pData = &pChunk->s16_buff[start];
+		count = samples - start;
+		if ( AGC_BLOCK < count ) {
+			count = AGC_BLOCK;
+		}
+
+		peak = 0;
+		for ( index = 0; count > index; index++ ) {
+			value = 0 > pData[index] ? -pData[index] : pData[index];
+			if ( value > peak ) {
+				peak = value;
+			}
+		}
+
+		// level envelope
+		if ( peak > pThis->envelope ) {
+			pThis->envelope += ((peak - pThis->envelope) * attack) >> 15;
+		} else {
+			pThis->envelope -= ((pThis->envelope - peak) * release) >> 15;
+		}
+
+		// gain aimed at, the gate keeps the noise down in the pauses
+		if ( pThis->envelope < pConfig->gate || 0 == pThis->envelope ) {
+			target = pConfig->gateGain;
+			pThis->gated++;
+		} else {
+			target = (pConfig->target * AGC_UNITY) / pThis->envelope;
+			if ( pConfig->gainMax < target ) {
+				target = pConfig->gainMax;
+			} else if ( pConfig->gainMin > target ) {
+				target = pConfig->gainMin;
+			}
+		}
+		// the envelope lags a sudden peak, do not clip it
+		if ( peak * target > AGC_FULL_SCALE ) {
+			target = AGC_FULL_SCALE / peak;
+			pThis->limited++;
+		}
+
+		// ramp to the new gain over the block, one multiply per sample
+		gain = pThis->gain;
+		step = (target - gain) / count;
+		for ( index = 0; count > index; index++ ) {
+			gain += step;
+			value = (pData[index] * gain) >> 12;
+			if ( 32767 < value ) {
+				value = 32767;
+			} else if ( -32768 > value ) {
+				value = -32768;
+			}
+			pData[index] = (short) value;
+		}
+		pThis->gain = target;
+	}
+	return PASS;
+}
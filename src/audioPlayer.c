@@ -24,11 +24,17 @@
 #include <isrDisp.h>
 #include <extio.h>
 #include <tll6527_core_timer.h>
+#include "frame.h"
+#include "cycles.h"
+#include "profile.h"
+#include "critical.h"
 
 //Chunk for receive path
 chunk_t receiveChunk;
+unsigned int receiveMem[CHUNK_WORDS(SAMPLE_SIZE)];
 //Chunk for transmit path
 chunk_t transmitChunk;
+unsigned int transmitMem[CHUNK_WORDS(SAMPLE_SIZE)];
 
 /**
  * @def I2C_CLK
@@ -43,6 +49,8 @@ chunk_t transmitChunk;
 /**
  * @def VOLUME_MAX
  * @brief MAX volume possible is +6db refer to ssm2603 manual
+ *   set in the codec at init, the volume after that is a digital gain
+ *   (mixer.h) of 1 dB per step under it
  */
 #define VOLUME_MAX (0x7F)
 /**
@@ -50,8 +58,6 @@ chunk_t transmitChunk;
  * @brief MIN volume possible is -73db refer to ssm2603 manual
  */
 #define VOLUME_MIN (0x2F)
-
-
 /** initialize audio player 
  *@param pThis  pointer to own object 
  *
@@ -88,16 +94,18 @@ int audioPlayer_init(audioPlayer_t *pThis)
         return status;
     }
     
-    /* Initialize the buffer pool */
-    status = bufferPool_init(&pThis->bp);
+    /* Initialize the buffer pool, chunks of one frame */
+    pThis->frameMs = AP_FRAME_MS_DEFAULT;
+    pThis->started = 0;
+    status = bufferPool_init(&pThis->bp, pThis->frameMs * AP_BYTES_PER_MS);
     if ( PASS != status ) {
         return FAIL;
     }
     
     /* Initialize transmit/receive chunks */
 	// init local chunk
-	chunk_init(&receiveChunk);
-	chunk_init(&transmitChunk);
+	chunk_init(&receiveChunk, receiveMem, SAMPLE_SIZE);
+	chunk_init(&transmitChunk, transmitMem, SAMPLE_SIZE);
 
 	pThis->pReceiveChunk = &receiveChunk;
 	pThis->pTransmitChunk = &transmitChunk;
@@ -108,8 +116,14 @@ int audioPlayer_init(audioPlayer_t *pThis)
         return FAIL;
     }
 
+    /* Initialize the events the ISRs wake the main loop with */
+    status = event_init(&pThis->event);
+    if ( PASS != status ) {
+        return FAIL;
+    }
+
     /* Initialize the audio RX module*/
-    status = audioRx_init(&pThis->rx, &pThis->bp, &pThis->isrDisp);
+    status = audioRx_init(&pThis->rx, &pThis->bp, &pThis->isrDisp, &pThis->event);
     if ( PASS != status) {
         return FAIL;
     }
@@ -121,17 +135,98 @@ int audioPlayer_init(audioPlayer_t *pThis)
     }
 
     /* Initialize the UART RX module */
-	status = uartRx_init(&pThis->uartRx, &pThis->bp, &pThis->isrDisp);
+	status = uartRx_init(&pThis->uartRx, &pThis->bp, &pThis->isrDisp, &pThis->event);
+	if ( PASS != status ) {
+			return FAIL;
+	}
+
+	/* Initialize the codec, UART carries ADPCM compressed chunks */
+	status = compression_init(&pThis->comp);
+	if ( PASS != status ) {
+			return FAIL;
+	}
+	status = decompression_init(&pThis->decomp);
+	if ( PASS != status ) {
+			return FAIL;
+	}
+	status = audioPlayer_setCodec(pThis, COMPRESSION_CODEC_ADPCM);
+	if ( PASS != status ) {
+			return FAIL;
+	}
+
+	/* Initialize silence suppression and comfort noise */
+	status = vad_init(&pThis->vad);
+	if ( PASS != status ) {
+			return FAIL;
+	}
+	status = cng_init(&pThis->cng);
+	if ( PASS != status ) {
+			return FAIL;
+	}
+
+	/* Initialize the jitter buffer in front of audio TX */
+	status = jitterBuffer_init(&pThis->jb, &pThis->bp);
+	if ( PASS != status ) {
+			return FAIL;
+	}
+	pThis->scheduled = 0;
+
+	/* Initialize the resamplers, full rate on the link */
+	status = audioPlayer_setRatio(pThis, 1);
+	if ( PASS != status ) {
+			return FAIL;
+	}
+	status = resample_init(&pThis->up, 1);
+	if ( PASS != status ) {
+			return FAIL;
+	}
+
+	/* Initialize latency measurement, off until audioPlayer_setLatencyMode */
+	status = latency_init(&pThis->latency);
+	if ( PASS != status ) {
+			return FAIL;
+	}
+
+	/* Initialize the noise suppression of the capture path */
+	status = ns_init(&pThis->ns);
+	if ( PASS != status ) {
+			return FAIL;
+	}
+	pThis->nsEnabled = 1;
+
+	/* Initialize the AGC of the capture path */
+	pThis->agcConfig.target    = AGC_TARGET_DEFAULT;
+	pThis->agcConfig.gainMax   = AGC_GAIN_MAX_DEFAULT;
+	pThis->agcConfig.gainMin   = AGC_GAIN_MIN_DEFAULT;
+	pThis->agcConfig.gate      = AGC_GATE_DEFAULT;
+	pThis->agcConfig.gateGain  = AGC_GATE_GAIN_DEFAULT;
+	pThis->agcConfig.attackMs  = AGC_ATTACK_MS_DEFAULT;
+	pThis->agcConfig.releaseMs = AGC_RELEASE_MS_DEFAULT;
+	status = agc_init(&pThis->agc, &pThis->agcConfig);
+	if ( PASS != status ) {
+			return FAIL;
+	}
+
+	/* Initialize the mixer of the playout, unity gain, sidetone off */
+	status = mixer_init(&pThis->mixer);
+	if ( PASS != status ) {
+			return FAIL;
+	}
+
+	/* Initialize the echo canceller, audio TX feeds it the far end */
+	status = aec_init(&pThis->aec);
 	if ( PASS != status ) {
 			return FAIL;
 	}
 
     /* Initialize the audio TX module */
-    status = audioTx_init(&pThis->tx, &pThis->bp, &pThis->isrDisp);
+    status = audioTx_init(&pThis->tx, &pThis->bp, &pThis->isrDisp, &pThis->event, &pThis->aec);
     if ( PASS != status ) {
         return FAIL;
     }
 
+    audioPlayer_telemetryReset(pThis);
+
     printf("[AP]: Init complete\r\n");
 
     return PASS;
@@ -150,6 +245,7 @@ int audioPlayer_start(audioPlayer_t *pThis)
     int                         status                  = 0;
     
     printf("[AP]: startup \r\n");
+    pThis->started = 1;
     
     /* Start the audio RX module */
     status = audioRx_start(&pThis->rx);
@@ -180,44 +276,511 @@ int audioPlayer_start(audioPlayer_t *pThis)
 
 
 
+/**
+ * @def AP_PLAYOUT_LEAD
+ * @brief frames scheduled ahead of the one playing: those the DMA has
+ * fetched plus one queued, everything else waits in the jitter buffer
+ * (its depth is the adaptive delay)
+ */
+#define AP_PLAYOUT_LEAD (AUDIOTX_FIRST + 1)
+
+/** feed audio TX from the jitter buffer
+ *   keeps AP_PLAYOUT_LEAD frames scheduled ahead of the playing one,
+ *   everything else waits in the jitter buffer
+ *   a lost frame uses up its frame time (audio TX conceals it),
+ *   while the far end is silent frame times are filled with comfort
+ *   noise
+ *@param pThis  pointer to own object
+ *
+ *@return void
+ **/
+static void audioPlayer_playout(audioPlayer_t *pThis)
+{
+	chunk_t *pChunk = NULL;
+	chunk_t *pFrame = NULL;
+	unsigned int played = pThis->tx.played;
+	int status;
+	int ratio;
+
+	// audio TX concealed on its own, do not catch up on those frames
+	if ( AUDIOTX_FIRST > (int) (pThis->scheduled - played) ) {
+		pThis->scheduled = played + AUDIOTX_FIRST;
+	}
+
+	if ( AP_PLAYOUT_LEAD <= (int) (pThis->scheduled - played) ) {
+		return;
+	}
+	if ( PASS != jitterBuffer_get(&pThis->jb, &pChunk) && !pThis->cng.active ) {
+		return;
+	}
+	pThis->scheduled++;
+
+	if ( NULL == pChunk ) {
+		if ( pThis->cng.active && PASS == bufferPool_acquire(&pThis->bp, &pChunk) ) {
+			cng_generate(&pThis->cng, pChunk);
+			PROFILE_BEGIN(PROFILE_MIX);
+			mixer_process(&pThis->mixer, pChunk);
+			PROFILE_END(PROFILE_MIX);
+			audioTx_putNc(&pThis->tx, pChunk);
+		} else {
+			audioTx_skip(&pThis->tx);
+		}
+		return;
+	}
+	/* the coded chunk is smaller than a frame, decode into a frame
+	 * chunk; in place if the pool ran out of those */
+	PROFILE_BEGIN(PROFILE_DECODE);
+	if ( PASS == bufferPool_acquire(&pThis->bp, &pFrame) ) {
+		status = decompressDataTo(&pThis->decomp, pChunk, pFrame);
+		pFrame->stamp = pChunk->stamp;
+		pFrame->flags = pChunk->flags;
+		bufferPool_release(&pThis->bp, pChunk);
+		pChunk = pFrame;
+	} else {
+		status = decompressData(&pThis->decomp, pChunk);
+	}
+	PROFILE_END(PROFILE_DECODE);
+
+	/* back to 8 kHz at the rate the far end sent */
+	if ( PASS == status ) {
+		ratio = 1 << ((pChunk->flags & FRAME_FLAG_RATIO_MASK) >> FRAME_FLAG_RATIO_SHIFT);
+		if ( ratio != pThis->up.ratio ) {
+			resample_init(&pThis->up, ratio);
+		}
+		status = resample_interpolate(&pThis->up, pChunk);
+	}
+	if ( PASS == status ) {
+		cng_speech(&pThis->cng, pChunk->len);
+		PROFILE_BEGIN(PROFILE_MIX);
+		mixer_process(&pThis->mixer, pChunk);
+		PROFILE_END(PROFILE_MIX);
+		audioTx_putNc(&pThis->tx, pChunk);
+	} else {
+		bufferPool_release(&pThis->bp, pChunk);
+		audioTx_skip(&pThis->tx);
+	}
+}
+
+
+/** code a captured chunk for the UART link
+ *   the echo of the playback is cancelled first, then the noise
+ *   is suppressed and the level evened out
+ *   silence is not sent, only a SID now and then
+ *@param pThis  pointer to own object
+ *@param pChunk  captured chunk, ownership passes on
+ *
+ *@return void
+ **/
+static void audioPlayer_capture(audioPlayer_t *pThis, chunk_t *pChunk)
+{
+	chunk_t *pCoded = NULL;
+	int trailer = pThis->latency.enabled ? LATENCY_TRAILER_SIZE : 0;
+	unsigned int flags = 0;
+	int ratio;
+
+	/* take out the echo of what played at capture time */
+	PROFILE_BEGIN(PROFILE_AEC);
+	aec_process(&pThis->aec, pChunk, audioTx_position(&pThis->tx, pChunk->stamp));
+	PROFILE_END(PROFILE_AEC);
+
+	/* then the background noise, before VAD and encoder see it */
+	if ( pThis->nsEnabled ) {
+		PROFILE_BEGIN(PROFILE_NS);
+		ns_process(&pThis->ns, pChunk);
+		PROFILE_END(PROFILE_NS);
+		// its output lags by a frame, the stamp follows the samples
+		pChunk->stamp -= NS_FFT * AUDIORX_CYCLES_PER_SAMPLE;
+	}
+
+	/* even out the level of the talker */
+	PROFILE_BEGIN(PROFILE_AGC);
+	agc_process(&pThis->agc, pChunk);
+	PROFILE_END(PROFILE_AGC);
+
+	// sidetone, before the chunk is coded in place
+	mixer_sidetone(&pThis->mixer, pChunk);
+
+	switch(vad_process(&pThis->vad, pChunk))
+	{
+	case VAD_SPEECH:
+		/* lower rate on the link, full rate if the chunk does not
+		 * divide by the ratio */
+		if ( PASS == resample_decimate(&pThis->down, pChunk) ) {
+			for ( ratio = pThis->down.ratio; 1 < ratio; ratio >>= 1 ) {
+				flags += 1 << FRAME_FLAG_RATIO_SHIFT;
+			}
+		}
+		/* the coded frame goes out in a chunk of its size class,
+		 * the capture frame returns to the pool right away */
+		if ( PASS == bufferPool_acquireSize(&pThis->bp,
+				compression_chunkLen(pThis->comp.codec, pChunk->len) + trailer, &pCoded) ) {
+			PROFILE_BEGIN(PROFILE_ENCODE);
+			compressDataTo(&pThis->comp, pChunk, pCoded);
+			PROFILE_END(PROFILE_ENCODE);
+			pCoded->stamp = pChunk->stamp;
+			bufferPool_release(&pThis->bp, pChunk);
+			pChunk = pCoded;
+		} else {
+			PROFILE_BEGIN(PROFILE_ENCODE);
+			compressData(&pThis->comp, pChunk);
+			PROFILE_END(PROFILE_ENCODE);
+		}
+		pChunk->flags |= flags;
+		latency_tx(&pThis->latency, pChunk);
+		uartTx_putNc(&pThis->uartTx, pChunk);
+		break;
+	case VAD_SID:
+		if ( PASS == bufferPool_acquireSize(&pThis->bp, COMPRESSION_HDR_SIZE + trailer, &pCoded) ) {
+			pCoded->stamp = pChunk->stamp;
+			bufferPool_release(&pThis->bp, pChunk);
+			pChunk = pCoded;
+		}
+		vad_sid(&pThis->vad, pChunk);
+		latency_tx(&pThis->latency, pChunk);
+		uartTx_putNc(&pThis->uartTx, pChunk);
+		break;
+	default:
+		bufferPool_release(&pThis->bp, pChunk);
+		uartTx_skip(&pThis->uartTx);
+		break;
+	}
+}
+
+
+/** take a frame received over the UART link
+ *@param pThis  pointer to own object
+ *@param pChunk  received frame, ownership passes on
+ *
+ *@return void
+ **/
+static void audioPlayer_receive(audioPlayer_t *pThis, chunk_t *pChunk)
+{
+	// timing trailer off, capture time to the local clock
+	latency_rx(&pThis->latency, pChunk);
+
+	if(COMPRESSION_CODEC_SID == frame_codec(pChunk))
+	{
+		/* far end went silent: comfort noise at its level */
+		cng_sid(&pThis->cng, pChunk);
+		jitterBuffer_silence(&pThis->jb, frame_seq(pChunk));
+		bufferPool_release(&pThis->bp, pChunk);
+	}
+	else
+	{
+		jitterBuffer_put(&pThis->jb, pChunk);
+	}
+}
+
+
+/**
+ * @def AP_REPORT_MS
+ * @brief period of the idle / wakeup latency and profile report [ms]
+ */
+#define AP_REPORT_MS	(10000)
+
 /** main loop of audio player does not terminate
+ *   sleeps in idle until an ISR posts an event, then does the work
+ *   that is ready:
+ *   - EVENT_AUDIO_RX: code the captured chunks
+ *   - every wakeup: parse the UART RX ring, EVENT_UART_RX comes per
+ *     ring row and per tick with bytes received, not per frame
+ *   - EVENT_AUDIO_TX or a frame received: feed audio TX
+ *   idle fraction, wakeup latency and the echo canceller statistics
+ *   are printed every AP_REPORT_MS, with the stage profile if built with PROFILE_ENABLE and the
+ *   latency distributions in latency mode
  *@param pThis  pointer to own object 
  *
  *@return 0 success, non-zero otherwise
  **/
 void audioPlayer_run (audioPlayer_t *pThis) {
+	chunk_t *pChunk = NULL;
+	unsigned int events;
+	unsigned int scheduled;
+	int received;
 
 	printf("[AP]: running \r\n");
 
 	UARTStart();
 	while(1)
 	{
-	// setup UART
-    	//testUART(pThis);
-		//testAudioLoopBack(pThis);
-		//testNBAudioPath(pThis);
-
-    	/*int i = 0;
-		for(i = 0; i < SAMPLE_SIZE; i++)
-		{
-			transmitChunk.s08_buff[i] = 0;
-			receiveChunk.s08_buff[i] = 0;
-		}*/
-
-    	if(PASS == audioRx_get(&pThis->rx, &transmitChunk))
-    	{
-    		uartTx_put(&pThis->uartTx, &transmitChunk);
-    	}
-		if(PASS == uartRx_get(&pThis->uartRx, &receiveChunk))
-		{
-			audioTx_put(&pThis->tx, &receiveChunk);
+		events = event_wait(&pThis->event);
+
+		/* chunks are handed from source to sink by pointer, the sink's
+		 * ISR returns them to the buffer pool (no payload copies) */
+		if ( events & EVENT_MASK(EVENT_AUDIO_RX) ) {
+			PROFILE_BEGIN(PROFILE_CAPTURE);
+			while ( PASS == audioRx_getNbNc(&pThis->rx, &pChunk) ) {
+				audioPlayer_capture(pThis, pChunk);
+			}
+			PROFILE_END(PROFILE_CAPTURE);
+		}
+
+		PROFILE_BEGIN(PROFILE_RECEIVE);
+		received = 0;
+		while ( PASS == uartRx_getNbNc(&pThis->uartRx, &pChunk) ) {
+			audioPlayer_receive(pThis, pChunk);
+			received = 1;
+		}
+		PROFILE_END(PROFILE_RECEIVE);
+
+		if ( received || (events & EVENT_MASK(EVENT_AUDIO_TX)) ) {
+			PROFILE_BEGIN(PROFILE_PLAYOUT);
+			do {
+				scheduled = pThis->scheduled;
+				audioPlayer_playout(pThis);
+			} while ( scheduled != pThis->scheduled );
+			PROFILE_END(PROFILE_PLAYOUT);
 		}
 
+		if ( (unsigned long long) AP_REPORT_MS * CYCLES_PER_MS <= pThis->event.stats.cycles ) {
+			event_report(&pThis->event);
+			aec_report(&pThis->aec);
+			PROFILE_REPORT();
+			if ( pThis->latency.enabled ) {
+				audioPlayer_latencyReport(pThis);
+			}
+		}
 	}
 	UARTStop();
 }
 
 
+/** select the codec used on the UART link
+ *   switches the encoder, the receiver takes the frame length from
+ *   the frame header and the codec from the codec header
+ *@param pThis  pointer to own object
+ *@param codec  COMPRESSION_CODEC_xxx
+ *
+ *@return 0 success, non-zero otherwise
+ **/
+int audioPlayer_setCodec(audioPlayer_t *pThis, int codec)
+{
+	return compression_setCodec(&pThis->comp, codec);
+}
+
+
+/** select the sample rate on the UART link
+ *   the transmit path decimates by the ratio in front of the encoder,
+ *   the receiver takes the ratio from the frame header and
+ *   interpolates back to 8 kHz; may be called at run time
+ *@param pThis  pointer to own object
+ *@param ratio  1 (8 kHz), 2 (4 kHz) or 4 (2 kHz)
+ *
+ *@return 0 success, non-zero otherwise
+ **/
+int audioPlayer_setRatio(audioPlayer_t *pThis, int ratio)
+{
+	return resample_init(&pThis->down, ratio);
+}
+
+
+/** set the AGC target level and limits of the transmit path
+ *   taken from the next captured chunk on; the defaults are the
+ *   AGC_xxx_DEFAULT of agc.h
+ *@param pThis  pointer to own object
+ *@param pConfig  target level, gain limits, gate, attack and release
+ *
+ *@return 0 success, non-zero otherwise
+ **/
+int audioPlayer_setAgc(audioPlayer_t *pThis, const agc_config_t *pConfig)
+{
+	if ( PASS != agc_check(pConfig) ) {
+		return FAIL;
+	}
+	// the AGC reads it per chunk, in the main loop as this
+	pThis->agcConfig = *pConfig;
+	return PASS;
+}
+
+
+/** set the playback volume
+ *   a digital gain in front of audio TX, 1 dB per step like the
+ *   headphone volume of the codec (which stays at VOLUME_MAX); ramped
+ *   to over a few ms, no I2C traffic
+ *@param pThis  pointer to own object
+ *@param volume  VOLUME_MIN (-80 dB) .. VOLUME_MAX (unity gain)
+ *
+ *@return 0 success, non-zero otherwise
+ **/
+int audioPlayer_setVolume(audioPlayer_t *pThis, int volume)
+{
+	if ( VOLUME_MIN > volume || VOLUME_MAX < volume ) {
+		return FAIL;
+	}
+	pThis->volume = volume;
+	return mixer_setGain(&pThis->mixer, mixer_gainDb(VOLUME_MAX - volume));
+}
+
+
+/** playback volume up by VOLUME_CHANGE_STEP, up to VOLUME_MAX
+ *@param pThis  pointer to own object
+ *
+ *@return the volume now
+ **/
+int audioPlayer_volumeUp(audioPlayer_t *pThis)
+{
+	int volume = pThis->volume + VOLUME_CHANGE_STEP;
+
+	audioPlayer_setVolume(pThis, VOLUME_MAX < volume ? VOLUME_MAX : volume);
+	return pThis->volume;
+}
+
+
+/** playback volume down by VOLUME_CHANGE_STEP, down to VOLUME_MIN
+ *@param pThis  pointer to own object
+ *
+ *@return the volume now
+ **/
+int audioPlayer_volumeDown(audioPlayer_t *pThis)
+{
+	int volume = pThis->volume - VOLUME_CHANGE_STEP;
+
+	audioPlayer_setVolume(pThis, VOLUME_MIN > volume ? VOLUME_MIN : volume);
+	return pThis->volume;
+}
+
+
+/** set the sidetone, the local capture mixed into the playback
+ *   after the AEC, NS and AGC, it lags by one to two frames
+ *@param pThis  pointer to own object
+ *@param attenuation  level under the capture [dB], 12 or more; 0 off
+ *
+ *@return 0 success, non-zero otherwise
+ **/
+int audioPlayer_setSidetone(audioPlayer_t *pThis, int attenuation)
+{
+	if ( 0 == attenuation ) {
+		return mixer_setSidetone(&pThis->mixer, 0);
+	}
+	return mixer_setSidetone(&pThis->mixer, mixer_gainDb(attenuation));
+}
+
+
+/** switch the noise suppression of the transmit path
+ *   off, the capture bypasses it and its NS_FFT samples (16 ms) of
+ *   delay; on again, it starts over from silence; may be called at
+ *   run time
+ *@param pThis  pointer to own object
+ *@param enable  1 on (the default), 0 off
+ *
+ *@return 0 success, non-zero otherwise
+ **/
+int audioPlayer_setNoiseSuppression(audioPlayer_t *pThis, int enable)
+{
+	// its frame still holds the capture of before it was switched off
+	if ( enable && !pThis->nsEnabled && PASS != ns_init(&pThis->ns) ) {
+		return FAIL;
+	}
+	pThis->nsEnabled = enable ? 1 : 0;
+	return PASS;
+}
+
+
+/** switch the latency measurement mode
+ *   on: every frame sent carries a timing trailer (see latency.h), the
+ *   far end has to be in latency mode too for the round trip and the
+ *   one way latency to be measured here
+ *@param pThis  pointer to own object
+ *@param enable  1 on, 0 off
+ *
+ *@return void
+ **/
+void audioPlayer_setLatencyMode(audioPlayer_t *pThis, int enable)
+{
+	pThis->latency.enabled = enable;
+}
+
+
+/** print the latency distributions since the last report, then
+ *   restart them
+ *   - one way: far end capture to local playback start (mouth to ear)
+ *   - round trip: on the UART link, frame sent to its echo received
+ *@param pThis  pointer to own object
+ *
+ *@return void
+ **/
+void audioPlayer_latencyReport(audioPlayer_t *pThis)
+{
+	latency_hist_t oneWay;
+	unsigned int mask;
+
+	// the audio TX ISR records the one way samples
+	mask = critical_enter();
+	oneWay = pThis->tx.latency;
+	latency_histInit(&pThis->tx.latency);
+	critical_exit(mask);
+
+	latency_histReport("one way   ", &oneWay);
+	latency_histReport("round trip", &pThis->latency.rtt);
+	latency_histInit(&pThis->latency.rtt);
+	// the offset wraps with the clocks, far clock behind comes out negative
+	if ( pThis->latency.offsetValid && 0 > (int) pThis->latency.offset ) {
+		printf("[LATENCY]: far clock behind by %u cycles\r\n", 0u - pThis->latency.offset);
+	} else if ( pThis->latency.offsetValid ) {
+		printf("[LATENCY]: far clock ahead by %u cycles\r\n", pThis->latency.offset);
+	}
+}
+
+
+/** select the frame duration of all paths
+ *   re-carves the buffer pool into chunks of one frame; audio RX
+ *   captures, audio TX plays and the codecs code one chunk at a time,
+ *   the UART frames are as long as the coded chunk
+ *   only before audioPlayer_start, both ends have to use the same
+ *@param pThis  pointer to own object
+ *@param ms  frame duration, up to SAMPLE_SIZE / AP_BYTES_PER_MS (128)
+ *
+ *@return 0 success, non-zero otherwise
+ **/
+int audioPlayer_setFrameDuration(audioPlayer_t *pThis, int ms)
+{
+	// chunks in flight would keep the old size
+	if ( pThis->started || 0 >= ms || SAMPLE_SIZE < ms * AP_BYTES_PER_MS ) {
+		return FAIL;
+	}
+
+	if ( PASS != bufferPool_init(&pThis->bp, ms * AP_BYTES_PER_MS) ) {
+		return FAIL;
+	}
+	pThis->frameMs = ms;
+
+	printf("[AP]: frame duration %d ms\r\n", ms);
+	return PASS;
+}
+
+
+/** counters of all paths since the last reset
+ *   copies a few words per path, callable any time from the main loop
+ *@param pThis  pointer to own object
+ *@param pSnap  filled with the counters
+ *
+ *@return void
+ **/
+void audioPlayer_telemetrySnapshot(audioPlayer_t *pThis, audioPlayer_telemetry_t *pSnap)
+{
+	telemetry_snapshot(&pThis->rx.stats,     &pThis->telemetryBase.audioRx, &pSnap->audioRx);
+	telemetry_snapshot(&pThis->uartTx.stats, &pThis->telemetryBase.uartTx,  &pSnap->uartTx);
+	telemetry_snapshot(&pThis->uartRx.stats, &pThis->telemetryBase.uartRx,  &pSnap->uartRx);
+	telemetry_snapshot(&pThis->tx.stats,     &pThis->telemetryBase.audioTx, &pSnap->audioTx);
+}
+
+
+/** restart the counters of all paths
+ *   the live counters are not cleared (ISRs keep writing them), a
+ *   baseline is taken instead
+ *@param pThis  pointer to own object
+ *
+ *@return void
+ **/
+void audioPlayer_telemetryReset(audioPlayer_t *pThis)
+{
+	telemetry_reset(&pThis->rx.stats,     &pThis->telemetryBase.audioRx);
+	telemetry_reset(&pThis->uartTx.stats, &pThis->telemetryBase.uartTx);
+	telemetry_reset(&pThis->uartRx.stats, &pThis->telemetryBase.uartRx);
+	telemetry_reset(&pThis->tx.stats,     &pThis->telemetryBase.audioTx);
+}
+
+
 /** Starts the wireless communicator
  *
  * @return PASS on success, FAIL otherwise
@@ -244,7 +807,9 @@ int UARTStop( void )
     uartRx_dmaStop();
     uartTx_dmaStop();
 
+#if defined(__ADSPBLACKFIN__) || defined(__bfin__)
     asm("ssync;");
+#endif
 
     return PASS;
 }
@@ -19,38 +19,33 @@
 #include "audioRx.h"
 #include "bufferPool.h"
 #include "isrDisp.h"
+#include "profile.h"
 #include <tll_config.h>
 #include <tll_sport.h>
-#include <queue.h>
 #include <power_mode.h>
 
+/**
+ * @def AUDIORX_DMA_CONFIG
+ * @brief DMA3 config of every descriptor: write to memory, 16 bit,
+ * interrupt on completion, large descriptor model (7 words)
+ */
+#define AUDIORX_DMA_CONFIG  (WNR | WDSIZE_16 | DI_EN | FLOW_LARGE | NDSIZE_7 | DMAEN)
+
+
 /** 
- * Configures the DMA rx with the buffer and the buffer length to 
- * receive
+ * Points a descriptor at the chunk to receive into
  * Parameters:
+ * @param pDesc  pointer to descriptor
  * @param pchunk  pointer to receive chunk
  *
  * @return void
  */
-void audioRx_dmaConfig(chunk_t *pchunk)
+static void audioRx_descConfig(dmaDesc_t *pDesc, chunk_t *pchunk)
 {
-	/* 1. Disable DMA 3*/
-	DISABLE_DMA(*pDMA3_CONFIG);
-
-	/* 2. Configure start address */
-	*pDMA3_START_ADDR = &pchunk->u16_buff[0];
-
-	/* 3. set X count */
-	*pDMA3_X_COUNT = pchunk->size/2; //*pDMA3_X_COUNT = 2;
-	//*pDMA3_Y_COUNT = pchunk->size/2; // 16 bit data so we change the stride and count
-
-	/* 4. set X modify */
-	*pDMA3_X_MODIFY = 2; //*pDMA3_X_MODIFY = 0;
-	//*pDMA3_Y_MODIFY = 2;
-
-	/* 5 Re-enable DMA */
-	ENABLE_DMA(*pDMA3_CONFIG);
-
+	pDesc->pStart  = &pchunk->u16_buff[0];
+	pDesc->xCount  = pchunk->size/2;
+	pDesc->xModify = 2;
+	pDesc->config  = AUDIORX_DMA_CONFIG;
 }
 
 
@@ -64,26 +59,36 @@ void audioRx_dmaConfig(chunk_t *pchunk)
  * @param pThis  pointer to own object
  * @param pBuffP  pointer to buffer pool to take and return chunks from
  * @param pIsrDisp   pointer to interrupt dispatcher to get ISR registered
+ * @param pEvent  events to post to the main loop, NULL for none
  *
  * @return Zero on success.
  * Negative value on failure.
  */
 int audioRx_init(audioRx_t *pThis, bufferPool_t *pBuffP,
-                 isrDisp_t *pIsrDisp)
+                 isrDisp_t *pIsrDisp, event_t *pEvent)
 {
     if ( NULL == pThis || NULL == pBuffP || NULL == pIsrDisp) {
         printf("[Audio RX]: Failed init\r\n");
         return FAIL;
     }
     
-    pThis->pPending     = NULL;
+    pThis->pFilling[0]  = NULL;
+    pThis->pFilling[1]  = NULL;
+    pThis->done         = 0;
     pThis->pBuffP       = pBuffP;
+    pThis->pEvent       = pEvent;
+    telemetry_init(&pThis->stats);
     
     // init queue with 
-    if(FAIL == queue_init(&pThis->queue, AUDIORX_QUEUE_DEPTH))
+    if(FAIL == spscRing_init(&pThis->queue, AUDIORX_QUEUE_DEPTH))
     	printf("[Audio RX]: Queue init failed\n");
 
-    *pDMA3_CONFIG = WDSIZE_16 | DI_EN | WNR; //| DMA2D; /* 16 bit and DMA enable */
+    /* DMA3 stays off until the descriptor ring is linked */
+    *pDMA3_CONFIG = 0;
+
+    // ping-pong ring
+    pThis->desc[0].pNext = &pThis->desc[1];
+    pThis->desc[1].pNext = &pThis->desc[0];
 
     // register own ISR to the ISR dispatcher
     isrDisp_registerCallback(pIsrDisp, ISR_DMA3_SPORT0_RX, audioRx_isr, pThis);
@@ -111,13 +116,19 @@ int audioRx_start(audioRx_t *pThis)
 {
 	printf("[Audio RX]: audioRx_start: implemented \r\n");
 
-	/* prime the system by getting the first buffer filled */
-	if ( FAIL == bufferPool_acquire(pThis->pBuffP, &pThis->pPending ) ) {
+	/* prime the system with a chunk behind each descriptor */
+	if ( FAIL == bufferPool_acquire(pThis->pBuffP, &pThis->pFilling[0]) ||
+	     FAIL == bufferPool_acquire(pThis->pBuffP, &pThis->pFilling[1]) ) {
 		printf("[Audio RX]: Failed to acquire buffer\n");
 		return FAIL;
 	}
+	audioRx_descConfig(&pThis->desc[0], pThis->pFilling[0]);
+	audioRx_descConfig(&pThis->desc[1], pThis->pFilling[1]);
+	pThis->done = 0;
 
-	audioRx_dmaConfig(pThis->pPending);
+	/* descriptor mode: DMA3 fetches desc[0] when enabled */
+	*pDMA3_NEXT_DESC_PTR = &pThis->desc[0];
+	*pDMA3_CONFIG        = AUDIORX_DMA_CONFIG;
 
 	// enable the audio transfer
 	ENABLE_SPORT0_RX();
@@ -140,40 +151,46 @@ void audioRx_isr(void *pThisArg)
 
 	// local pThis to avoid constant casting
 	audioRx_t *pThis = (audioRx_t*) pThisArg;
+	chunk_t *pNext = NULL;
+	chunk_t *pFilled;
+	int done;
 
+	PROFILE_BEGIN(PROFILE_AUDIO_RX_ISR);
 	if ( *pDMA3_IRQ_STATUS & 0x1 ) {
+		*pDMA3_IRQ_STATUS |= DMA_DONE;		// clear the interrupt
+
+		/* the DMA continues in the other descriptor, this one is
+		 * fetched again only after that chunk is full */
+		done = pThis->done;
+		pThis->done = done ^ 1;
+		pFilled = pThis->pFilling[done];
 
 		//  chunk is now filled, so update the length
-        pThis->pPending->len = pThis->pPending->size;
+        pFilled->len = pThis->desc[done].xCount * 2;
+        // its first sample was captured one chunk ago
+        pFilled->stamp = cycles_read() - pThis->desc[done].xCount * AUDIORX_CYCLES_PER_SAMPLE;
 
         /* Insert the chunk previously read by the DMA RX on the
-         * RX QUEUE and a data is inserted to queue
+         * RX QUEUE, but only with a fresh chunk to continue in: on a
+         * full queue or an empty pool the samples are dropped and the
+         * same chunk is filled again, capture never stops
          */
-        if ( FAIL == queue_put(&pThis->queue, pThis->pPending) ) {
-
-        	// reuse the same buffer and overwrite last samples
-        	audioRx_dmaConfig(pThis->pPending);
+        if ( spscRing_isFull(&pThis->queue) ) {
         	//printf("[ARX INT]: RX Packet Dropped \r\n");
+        	telemetry_drop(&pThis->stats, TELEMETRY_DROP_QUEUE_FULL, 1);
+        } else if ( PASS == bufferPool_acquire(pThis->pBuffP, &pNext) ) {
+        	spscRing_put(&pThis->queue, pFilled);
+        	telemetry_in(&pThis->stats);
+        	event_post(pThis->pEvent, EVENT_AUDIO_RX);
+        	pThis->pFilling[done] = pNext;
+        	audioRx_descConfig(&pThis->desc[done], pNext);
         } else {
-
-        	/* Otherwise, attempt to acquire a chunk from the buffer
-			 * pool.
-			 */
-			if ( PASS == bufferPool_acquire(pThis->pBuffP, &pThis->pPending) ) {
-				/* If successful, configure the DMA to write
-				 * to this chunk.
-				 */
-				audioRx_dmaConfig(pThis->pPending);
-			} else {
-
-				/* If not successful, then we are out of
-				 * memory because the buffer pool is empty.
-				 */
-				//printf("Buffer pool is empty!\n");
-			}
+        	//printf("Buffer pool is empty!\n");
+        	pThis->stats.poolEmpty++;
+        	telemetry_drop(&pThis->stats, TELEMETRY_DROP_NO_BUFFER, 1);
         }
-        *pDMA3_IRQ_STATUS |= DMA_DONE;		// clear the interrupt
     }
+    PROFILE_END(PROFILE_AUDIO_RX_ISR);
 }
 
 
@@ -195,7 +212,7 @@ int audioRx_get(audioRx_t *pThis, chunk_t *pChunk)
 	chunk_t *chunk_rx;
     /* Block till a chunk arrives on the rx queue */
     //while( queue_is_empty(&pThis->queue) ) {
-	if( queue_is_empty(&pThis->queue) ) {
+	if( spscRing_isEmpty(&pThis->queue) ) {
     	//printf("[ARX] Queue is empty\r\n");
     	return FAIL;
         //powerMode_change(PWR_ACTIVE);
@@ -203,9 +220,10 @@ int audioRx_get(audioRx_t *pThis, chunk_t *pChunk)
     }
    //powerMode_change(PWR_FULL_ON);
 
-    if(FAIL == queue_get(&pThis->queue, (void**)&chunk_rx))
+    if(FAIL == spscRing_get(&pThis->queue, (void**)&chunk_rx))
     	return FAIL;
     else {
+    	 telemetry_out(&pThis->stats);
     	 chunk_copy(chunk_rx, pChunk);
     	 bufferPool_release(pThis->pBuffP, chunk_rx);
     	 return PASS;
@@ -227,13 +245,15 @@ int audioRx_getNbNc(audioRx_t *pThis, chunk_t **ppChunk)
 {
 	int retval = FAIL;
     // check if something in queue
-    if(queue_is_empty(&pThis->queue))
+    if(spscRing_isEmpty(&pThis->queue))
     {
     	return retval;
     }
     else {
-        if(PASS == queue_get(&pThis->queue, (void**)ppChunk))
+        if(PASS == spscRing_get(&pThis->queue, (void**)ppChunk)) {
+        	telemetry_out(&pThis->stats);
         	retval = PASS;
+        }
         else
         {
         	//printf("[Audio RX]: Failed to get chunk\r\n");
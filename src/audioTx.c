@@ -19,56 +19,65 @@
 #include "audioTx.h"
 #include "bufferPool.h"
 #include "isrDisp.h"
+#include "plc.h"
+#include "critical.h"
+#include "profile.h"
+#include "frame.h"
+#include "cycles.h"
 #include <tll_config.h>
 #include <tll_sport.h>
-#include <queue.h>
 #include <power_mode.h>
 
+/**
+ * @def AUDIOTX_DMA_CONFIG
+ * @brief DMA4 config of every descriptor: read from memory, 16 bit,
+ * interrupt on completion, large descriptor model (7 words)
+ */
+#define AUDIOTX_DMA_CONFIG  (WDSIZE_16 | DI_EN | FLOW_LARGE | NDSIZE_7 | DMAEN)
+
+/**
+ * @def AUDIOTX_SLOT
+ * @brief ring slot of a descriptor count
+ */
+#define AUDIOTX_SLOT(count)  ((count) & (AUDIOTX_RING - 1))
+
+
 /** 
- * Configures the DMA tx with the buffer and the buffer length to 
- * transfer
+ * Points a descriptor at the chunk to transmit
  * Parameters:
+ * @param pDesc  pointer to descriptor
  * @param pchunk  pointer to tx chunk
  * @return void
  */
-void audioTx_dmaConfig(chunk_t *pchunk)
+static void audioTx_descConfig(dmaDesc_t *pDesc, chunk_t *pchunk)
 {
-	/* 1. Disable DMA 4*/
-	DISABLE_DMA(*pDMA4_CONFIG);
-
-	/* 2. Configure start address */
-	*pDMA4_START_ADDR = &pchunk->u16_buff[0];
-
-	/* 3. set X count */
-	*pDMA4_X_COUNT = pchunk->len/2;//*pDMA4_X_COUNT = 2;//pchunk->bytesUsed/2;
-	//*pDMA4_Y_COUNT = pchunk->len/2; // 16 bit data so we change the stride and count
-   
-	/* 4. set X modify */
-	*pDMA4_X_MODIFY = 2; //*pDMA4_X_MODIFY = 0;
-	//*pDMA4_Y_MODIFY = 2;
-   
-	/* 5. Re-enable DMA */
-	ENABLE_DMA(*pDMA4_CONFIG);
-
+    pDesc->pStart  = &pchunk->u16_buff[0];
+    pDesc->xCount  = pchunk->len/2;
+    pDesc->xModify = 2;
+    pDesc->config  = AUDIOTX_DMA_CONFIG;
 }
 
 
 /** Initialize audio tx
  *    - get pointer to buffer pool
  *    - register interrupt handler
- *    - initialize TX queue
+ *    - link the descriptor ring
 
  * Parameters:
  * @param pThis  pointer to own object
  * @param pBuffP  pointer to buffer pool to take and return chunks from
  * @param pIsrDisp   pointer to interrupt dispatcher to get ISR registered
+ * @param pEvent  events to post to the main loop, NULL for none
+ * @param pAec  echo canceller to hand the far end to, NULL for none
  *
  * @return Zero on success.
  * Negative value on failure.
  */
 int audioTx_init(audioTx_t *pThis, bufferPool_t *pBuffP,
-                 isrDisp_t *pIsrDisp)
+                 isrDisp_t *pIsrDisp, event_t *pEvent, aec_t *pAec)
 {
+    int count;
+
     // parameter checking
     if ( NULL == pThis || NULL == pBuffP || NULL == pIsrDisp ) {
         printf("[Audio TX]: Failed init \r\n");
@@ -77,16 +86,31 @@ int audioTx_init(audioTx_t *pThis, bufferPool_t *pBuffP,
     
     // store pointer to buffer pool for later access     
     pThis->pBuffP       = pBuffP;
+    pThis->pEvent       = pEvent;
+    pThis->pAec         = pAec;
+
+    pThis->running      = 0;    // no data played yet
+    pThis->played       = 0;
+    pThis->playStamp    = 0;
+    pThis->next         = AUDIOTX_FIRST;
+    telemetry_init(&pThis->stats);
+    latency_histInit(&pThis->latency);
+
+    // init loss concealment
+    if ( PASS != plc_init(&pThis->plc) ) {
+        return FAIL;
+    }
 
-    pThis->pPending     = NULL; // nothing pending
-    pThis->running      = 0;    // DMA turned off by default
-    
-    // init queue 
-    queue_init(&pThis->queue, AUDIOTX_QUEUE_DEPTH);   
+    // link the ring, every descriptor plays silence until data arrives
+    for ( count = 0; AUDIOTX_RING > count; count++ ) {
+        pThis->desc[count].pNext = &pThis->desc[AUDIOTX_SLOT(count + 1)];
+        pThis->pChunk[count]     = &pThis->plc.silence;
+        pThis->filled[count]     = (unsigned int) -1;
+        audioTx_descConfig(&pThis->desc[count], pThis->pChunk[count]);
+    }
  
-    /* Configure the DMA4 for TX (data transfer/memory read) */
-    /* Read, 2-D, interrupt enabled, 16 bit transfer, Auto buffer */
-    *pDMA4_CONFIG = WDSIZE_16 | DI_EN; //| DMA2D; /* 16 bit and DMA enable */
+    /* DMA4 stays off until audioTx_start */
+    *pDMA4_CONFIG = 0;
     
     // register own ISR to the ISR dispatcher
     isrDisp_registerCallback(pIsrDisp, ISR_DMA4_SPORT0_TX, audioTx_isr, pThis);
@@ -99,7 +123,8 @@ int audioTx_init(audioTx_t *pThis, bufferPool_t *pBuffP,
 
 
 /** start audio tx
- *   - empty for now
+ *   - start the descriptor ring, plays silence until chunks are put
+ *     (one frame of the buffer pool per descriptor)
  * Parameters:
  * @param pThis  pointer to own object
  *
@@ -108,20 +133,52 @@ int audioTx_init(audioTx_t *pThis, bufferPool_t *pBuffP,
  */
 int audioTx_start(audioTx_t *pThis)
 {
+    int count;
      
     printf("[Audio TX]: audioTx_start: implemented \r\n");
 
-    // empty nothing to be done, DMA kicked off during run time 
-    return PASS;   
+    // frame duration is known now, as carved by the buffer pool
+    pThis->plc.silence.len = pThis->pBuffP->frameSize;
+    for ( count = 0; AUDIOTX_RING > count; count++ ) {
+        audioTx_descConfig(&pThis->desc[count], pThis->pChunk[count]);
+    }
+
+    /* descriptor mode: DMA4 fetches desc[0] when enabled and runs
+     * around the ring from then on */
+    *pDMA4_NEXT_DESC_PTR = &pThis->desc[0];
+    *pDMA4_CONFIG        = AUDIOTX_DMA_CONFIG;
+    ENABLE_SPORT0_TX();
+
+    return PASS;
+}
+
+
+
+/** release a played chunk, unless it is a concealment frame
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pchunk  chunk played
+ *
+ * @return None
+ */
+static void audioTx_release(audioTx_t *pThis, chunk_t *pchunk)
+{
+    if ( NULL != pchunk && !plc_owns(&pThis->plc, pchunk) ) {
+        bufferPool_release(pThis->pBuffP, pchunk);
+    }
 }
 
 
 
 /** audio tx isr  (to be called from dispatcher) 
- *   - get chunk from tx queue
- *    - if valid, release old pending chunk to buffer pool 
- *    - configure DMA 
- *    - if not valid, configure DMA to replay same chunk again
+ *   - the DMA already plays the next descriptor
+ *   - release the chunk of the finished descriptor to the buffer pool
+ *   - finalize the descriptor after the one now playing: keep the
+ *     chunk linked there by audioTx_putNc, or link a concealment frame
+ *     (prepared in the main loop, no signal processing here)
+ *   - no DMA register is touched but the IRQ status
+ *   - a stamped chunk starting to play adds a one way latency sample
+ *   - post EVENT_AUDIO_TX, there is room for the next frame
  * Parameters:
  * @param pThis  pointer to own object
  *
@@ -131,40 +188,57 @@ void audioTx_isr(void *pThisArg)
 {
     // create local casted pThis to avoid casting on every single access
     audioTx_t  *pThis = (audioTx_t*) pThisArg;
+    unsigned int count;
+    int slot;
 
-    chunk_t *pchunk = NULL;
-
+    PROFILE_BEGIN(PROFILE_AUDIO_TX_ISR);
     // validate that TX DMA IRQ was triggered 
     if ( *pDMA4_IRQ_STATUS & 0x1  ) {
-        //printf("[TXISR]\n");
-        /* We need to remove the data from the queue and create space for more data
-         * (The data was read previously by the DMA)
-
-        1. First, attempt to get the new chunk, and check if it's available: */
-    	if (PASS == queue_get(&pThis->queue, (void **)&pchunk) ) {
-    		/* 2. If so, release old chunk on success back to buffer pool */
-    		bufferPool_release(pThis->pBuffP, pThis->pPending);
-
-    		/* 3. Register the new chunk as pending */
-    		pThis->pPending = pchunk;
+        *pDMA4_IRQ_STATUS  |= DMA_DONE;     // Clear the interrupt
 
-    	} else {
-    		//printf("[Audio TX]: TX Queue Empty! \r\n");
-    	}
+        /* 1. the finished chunk goes back to the pool */
+        count = pThis->played;
+        slot  = AUDIOTX_SLOT(count);
+        audioTx_release(pThis, pThis->pChunk[slot]);
+        pThis->pChunk[slot] = NULL;
+        pThis->played = ++count;
+
+        /* the next descriptor started playing just now */
+        pThis->playStamp = cycles_read();
+        slot = AUDIOTX_SLOT(count);
+        if ( pThis->filled[slot] == count && (pThis->pChunk[slot]->flags & FRAME_FLAG_TIMING) ) {
+            latency_histRecord(&pThis->latency, cycles_read() - pThis->pChunk[slot]->stamp);
+        }
 
-        *pDMA4_IRQ_STATUS  |= DMA_DONE;     // Clear the interrupt
+        /* 2. descriptor count+1 is fetched when count is done */
+        count++;
+        slot = AUDIOTX_SLOT(count);
+        if ( pThis->filled[slot] == count ) {
+            telemetry_out(&pThis->stats);
+            plc_resume(&pThis->plc);
+        } else {
+            if ( pThis->running ) {
+                pThis->stats.underruns++;
+            }
+            //printf("[Audio TX]: TX Queue Empty! \r\n");
+            /* replaying the same chunk would loop it audibly,
+             * play a concealment frame instead */
+            pThis->pChunk[slot] = plc_conceal(&pThis->plc);
+            audioTx_descConfig(&pThis->desc[slot], pThis->pChunk[slot]);
+        }
 
-        // config DMA either with new chunk (if there was one), or with old chunk on empty Q
-        audioTx_dmaConfig(pThis->pPending);
+        /* 3. room for the next frame */
+        event_post(pThis->pEvent, EVENT_AUDIO_TX);
     }
+    PROFILE_END(PROFILE_AUDIO_TX_ISR);
 }
 
 
 
 
 /** audio tx put
- *   copies filled pChunk into the TX queue for transmission
- *    if queue is full, then chunk is dropped 
+ *   copies filled pChunk into a pool chunk and links it into the ring
+ *    if the ring is full, then chunk is dropped 
  * Parameters:
  * @param pThis  pointer to own object
  *
@@ -180,48 +254,155 @@ int audioTx_put(audioTx_t *pThis, chunk_t *pChunk)
         return FAIL;
     }
     
-    // block if queue is full
-    //while(queue_is_full(&pThis->queue)) {
-    if(queue_is_full(&pThis->queue)) {
-        //printf("[Audio TX]: Queue Full \r\n");
+    // drop if the ring is full, no need to copy then
+    if ( AUDIOTX_RING <= (int) (pThis->next - pThis->played) ) {
+        //printf("[Audio TX]: Ring Full \r\n");
+        telemetry_drop(&pThis->stats, TELEMETRY_DROP_QUEUE_FULL, 1);
         return FAIL;
-        //powerMode_change(PWR_ACTIVE);
-        //asm("idle;");
     }
-    //powerMode_change(PWR_FULL_ON);
 
     // get free chunk from pool
     if ( PASS == bufferPool_acquire(pThis->pBuffP, &pchunk_temp) ) {
     	// copy chunk into free buffer for queue
-    	chunk_copy(pChunk, pchunk_temp);
-
-    	/* If DMA not running ? */
-        if ( 0 == pThis->running ) {
-        	/* directly put chunk to DMA transfer & enable */
-        	pThis->running  = 1;
-            pThis->pPending = pchunk_temp;
-            audioTx_dmaConfig(pThis->pPending);
-            ENABLE_SPORT0_TX();
+    	if ( PASS != chunk_copy(pChunk, pchunk_temp) ) {
+    		// longer than a frame of the pool
+    		bufferPool_release(pThis->pBuffP, pchunk_temp);
+    		telemetry_drop(&pThis->stats, TELEMETRY_DROP_INVALID, 1);
+    		return FAIL;
+    	}
 
-        } else {
-        	/* DMA already running add chunk to queue */
-            if ( PASS != queue_put(&pThis->queue, pchunk_temp) ) {
-            	// return chunk to pool if queue is full, effectively dropping the chunk
-                bufferPool_release(pThis->pBuffP, pchunk_temp);
-                return FAIL;
-            }
-            else
-            {
-            	return PASS;
-            }
-        }
+    	// hand the copy over, released by the ISR once played
+    	return audioTx_putNc(pThis, pchunk_temp);
 
     } else {
     	// drop if we don't get free space
     	//printf("[Audio TX]: failed to get buffer \r\n");
+    	pThis->stats.poolEmpty++;
+    	telemetry_drop(&pThis->stats, TELEMETRY_DROP_NO_BUFFER, 1);
     	return FAIL;
     }
     
     return FAIL;
 }
 
+
+
+/** audio tx put (no copy)
+ *   hands a pool chunk over for playback, ownership passes to audioTx:
+ *   the chunk is linked into the descriptor ring and released to the
+ *   buffer pool by the ISR once played, or right away if it has to be
+ *   dropped
+ *   the concealment learns from every chunk and cross-fades a chunk
+ *   that ends a loss run
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pChunk  chunk acquired from the buffer pool
+ *
+ * @return Zero on success.
+ * Negative value on failure (chunk dropped).
+ */
+int audioTx_putNc(audioTx_t *pThis, chunk_t *pChunk)
+{
+    unsigned int mask;
+    unsigned int count;
+    unsigned int playing;
+    int slot;
+    int next;
+    int lost;
+    int latched;
+
+    if ( NULL == pThis || NULL == pChunk ) {
+        return FAIL;
+    }
+
+    /* the ISR finalizes the descriptor after the playing one: hold it
+     * off while picking and linking a descriptor, nothing more */
+    mask    = critical_enter();
+    playing = pThis->played;
+    count   = pThis->next;
+
+    // fell behind: those descriptors play concealment
+    if ( AUDIOTX_FIRST > (int) (count - playing) ) {
+        count = playing + AUDIOTX_FIRST;
+    }
+
+    if ( AUDIOTX_RING <= (int) (count - playing) ) {
+        critical_exit(mask);
+        bufferPool_release(pThis->pBuffP, pChunk);
+        telemetry_drop(&pThis->stats, TELEMETRY_DROP_QUEUE_FULL, 1);
+        return FAIL;
+    }
+
+    // the loss run as it stands now, the ISR may end it once unmasked
+    next    = playing + AUDIOTX_FIRST == count && plc_owns(&pThis->plc, pThis->pChunk[AUDIOTX_SLOT(count - 1)]);
+    lost    = pThis->plc.lost;
+    latched = pThis->plc.latched;
+
+    slot = AUDIOTX_SLOT(count);
+    pThis->pChunk[slot] = pChunk;
+    audioTx_descConfig(&pThis->desc[slot], pChunk);
+    pThis->filled[slot] = count;
+    pThis->next    = count + 1;
+    pThis->running = 1;
+    telemetry_in(&pThis->stats);
+    critical_exit(mask);
+
+    /* history + concealment, fades in if the chunk ends a loss run;
+     * the chunk is linked a frame ahead of the playing one at least,
+     * the DMA reads it a frame from now at the earliest */
+    plc_update(&pThis->plc, pChunk, next, lost, latched);
+
+    /* far end reference of the echo canceller, the chunk plays a
+     * frame from now at the earliest and stays linked till then */
+    aec_reference(pThis->pAec, pChunk, count * (pThis->pBuffP->frameSize / 2));
+
+    return PASS;
+}
+
+
+
+/** audio tx skip
+ *   a frame time passes without a chunk (lost frame), its descriptor
+ *   is left to the ISR, which links a concealment frame
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return void
+ */
+void audioTx_skip(audioTx_t *pThis)
+{
+    unsigned int mask;
+
+    mask = critical_enter();
+    if ( AUDIOTX_FIRST > (int) (pThis->next - pThis->played) ) {
+        pThis->next = pThis->played + AUDIOTX_FIRST;
+    }
+    pThis->next++;
+    critical_exit(mask);
+}
+
+
+/** audio tx position
+ *   absolute sample position played at a given time, as written to the
+ *   echo canceller: descriptor count times the frame samples
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param stamp  time [cycles], within a few frames of now
+ *
+ * @return sample position
+ */
+unsigned int audioTx_position(audioTx_t *pThis, unsigned int stamp)
+{
+    unsigned int mask;
+    unsigned int played;
+    unsigned int start;
+
+    // descriptor count and its start time as one
+    mask   = critical_enter();
+    played = pThis->played;
+    start  = pThis->playStamp;
+    critical_exit(mask);
+
+    return played * (pThis->pBuffP->frameSize / 2)
+           + (int) (stamp - start) / AUDIOTX_CYCLES_PER_SAMPLE;
+}
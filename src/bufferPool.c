@@ -3,6 +3,7 @@
  *
  *@brief
  *  - Global buffer pool divided into chunks and kept on the free list
+ *  - chunks come in size classes, each with its own free list
  *
  * Target:   TLL6527v1-0      
  * Compiler: VDSP++     Output format: VDSP++ "*.dxe"
@@ -18,38 +19,94 @@
 #include "tll_common.h"
 #include "bufferPool.h"
 
+/** carve a size class from the storage
+ *
+ * Parameters:
+ * @param pThis  pointer to buffer pool data structure
+ * @param cls  class to carve
+ * @param size  data bytes per chunk
+ * @param pMem  storage of the class
+ * @param words  words of storage available
+ * @param first  index of the first chunk in buffer[]
+ *
+ * @return words of storage used
+ */
+static int bufferPool_carve(bufferPool_t *pThis, bufferPool_class_t cls, int size,
+                            unsigned int *pMem, int words, int first)
+{
+    int                         count                   = 0;
+    int                         chunkWords              = CHUNK_WORDS(size);
+    bufferPool_sizeClass_t      *pCls                   = &pThis->cls[cls];
+    
+    pCls->size  = size;
+    pCls->first = first;
+    pCls->num   = words / chunkWords;
+    if ( CHUNK_NUM_MAX < pCls->num ) {
+        pCls->num = CHUNK_NUM_MAX;
+    }
+    
+    /* We put all the chunk on the free list */
+    for(count = 0; pCls->num > count; count++){
+        // init chunk on its slice of the storage
+        chunk_init(&pThis->buffer[first + count], &pMem[count * chunkWords], size);
+        // put initialized chunk into queue, a chunk it does not take is not carved
+        if ( FAIL == queue_put(&pCls->freeList, (void **)&pThis->buffer[first + count] ) ) {
+            printf("[BP]: Free list full at %d chunks\n", count);
+            pCls->num = count;
+            break;
+        }
+    }
+    
+    printf("[BP]: %d chunks of %d bytes\n", pCls->num, size);
+    return pCls->num * chunkWords;
+}
+
 /** Initialize buffer pool 
- *    - initialize freeList, populate with chunks
+ *    - carve the storage into the size classes: CHUNK_NUM_MAX small
+ *      chunks, then frame and coded chunks from one half of the rest
+ *      each, CHUNK_NUM_MAX at most per class
+ *    - initialize a freeList per class, populate with chunks; a class
+ *      holds the chunks its freeList took
+ *    - may be called again to re-carve while no chunk is acquired
   *
  * Parameters:
  * @param pThis  pointer to buffer pool data structure
+ * @param size  data bytes of a frame chunk, SAMPLE_SIZE at most
  *
  * @return Zero on success.
  * Negative value on failure.
  */
-int bufferPool_init(bufferPool_t *pThis)
+int bufferPool_init(bufferPool_t *pThis, int size)
 {
     int                         count                   = 0;
+    int                         used                    = 0;
     
-    // init queue
-    if ( FAIL == queue_init(&pThis->freeList, CHUNK_NUM_MAX) ) {
-        printf("[BP]: Failed to initialize free list\n");
+    if ( NULL == pThis || 0 >= size || SAMPLE_SIZE < size ) {
+        printf("[BP]: Failed init\n");
         return FAIL;
     }
     
-    /* We put all the chunk on the free list */
-    for(count = 0; CHUNK_NUM_MAX > count; count++){
-        // init chunk 
-        chunk_init(&pThis->buffer[count]);
-        // put initialized chunk into queue 
-        queue_put(&pThis->freeList, (void **)&pThis->buffer[count] );
+    // init queues
+    for ( count = 0; BP_CLASS_NUM > count; count++ ) {
+        if ( FAIL == queue_init(&pThis->cls[count].freeList, CHUNK_NUM_MAX) ) {
+            printf("[BP]: Failed to initialize free list\n");
+            return FAIL;
+        }
     }
     
+    pThis->frameSize = size;
+    used  = bufferPool_carve(pThis, BP_CLASS_SMALL, BP_SMALL_SIZE,
+                             &pThis->mem[0], BP_POOL_WORDS, 0);
+    used += bufferPool_carve(pThis, BP_CLASS_FRAME, size,
+                             &pThis->mem[used], (BP_POOL_WORDS - used) / 2, CHUNK_NUM_MAX);
+    used += bufferPool_carve(pThis, BP_CLASS_CODED, BP_CODED_SIZE(size),
+                             &pThis->mem[used], BP_POOL_WORDS - used, 2 * CHUNK_NUM_MAX);
+    
     printf("[BP]: Initialised\n");
     return PASS;
 }
 
-/** Get a chunk from the  buffer pool 
+/** Get a frame chunk from the  buffer pool 
  *
  * Parameters:
  * @param pThis    pointer to queue data structure
@@ -65,18 +122,54 @@ int bufferPool_acquire(bufferPool_t *pThis, chunk_t **ppChunk)
         return FAIL;
     }
     
-    if (FAIL == queue_get(&pThis->freeList, (void **)ppChunk) ){
+    if (FAIL == queue_get(&pThis->cls[BP_CLASS_FRAME].freeList, (void **)ppChunk) ){
         *ppChunk = NULL;
         return FAIL;
     }
-    (*ppChunk)->size = SAMPLE_SIZE;
-    (*ppChunk)->len  = 0;
+    (*ppChunk)->size  = pThis->frameSize;
+    (*ppChunk)->len   = 0;
+    (*ppChunk)->flags = 0;
     return PASS;
 }
 
+/** Get a chunk of at least size bytes from the  buffer pool 
+ *    - from the smallest class that fits, the next larger one if
+ *      that class is empty
+ *
+ * Parameters:
+ * @param pThis    pointer to queue data structure
+ * @param size     data bytes needed
+ * @param ppChunk  pointer pointer to chunk acquired (null if empty)
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int bufferPool_acquireSize(bufferPool_t *pThis, int size, chunk_t **ppChunk)
+{
+    int                         count                   = 0;
+    
+    if ( NULL == pThis || NULL == ppChunk ) {
+        printf("[BP]: Acquire failed\n");
+        return FAIL;
+    }
+    
+    for ( count = 0; BP_CLASS_NUM > count; count++ ) {
+        if ( size <= pThis->cls[count].size
+             && PASS == queue_get(&pThis->cls[count].freeList, (void **)ppChunk) ) {
+            (*ppChunk)->size  = pThis->cls[count].size;
+            (*ppChunk)->len   = 0;
+            (*ppChunk)->flags = 0;
+            return PASS;
+        }
+    }
+    
+    *ppChunk = NULL;
+    return FAIL;
+}
 
 
-/** Release chunk into the free list 
+
+/** Release chunk into the free list of its class
  *    - non blocking 
  *    - error on null passed 
   *
@@ -89,19 +182,35 @@ int bufferPool_acquire(bufferPool_t *pThis, chunk_t **ppChunk)
  */
 int bufferPool_release(bufferPool_t *pThis, chunk_t *pChunk)
 {
+    int                         count                   = 0;
+    int                         index                   = 0;
+    
     if ( NULL == pThis || NULL == pChunk ) {
         printf("[BP]: Acquire failed\n");
         return FAIL;
     }    
     
-    if (FAIL == queue_put(&pThis->freeList, (void **)pChunk) ){
+    // the class follows from the position in buffer[]
+    index = pChunk - &pThis->buffer[0];
+    for ( count = 0; BP_CLASS_NUM > count; count++ ) {
+        if ( pThis->cls[count].first <= index
+             && pThis->cls[count].first + pThis->cls[count].num > index ) {
+            break;
+        }
+    }
+    if ( BP_CLASS_NUM == count ) {
+        // not from this pool
+        return FAIL;
+    }
+    
+    if (FAIL == queue_put(&pThis->cls[count].freeList, (void **)pChunk) ){
         pChunk = NULL;
         return FAIL;
     }
     return PASS;
 }
 
-/** Returns true if buffer pool is empty
+/** Returns true if buffer pool has no frame chunk left
  *
  *
  * Parameters:
@@ -116,7 +225,7 @@ int bufferPool_is_empty(bufferPool_t *pThis )
         return FAIL;
     }   
     
-    if ( FAIL != queue_is_empty(&pThis->freeList) ) {
+    if ( FAIL != queue_is_empty(&pThis->cls[BP_CLASS_FRAME].freeList) ) {
         printf("[BP]: The buffer has free chunks\n");
         return FAIL;
     }
@@ -17,28 +17,42 @@
  *******************************************************************************/
 #include "tll_common.h"
 #include "chunk.h"
+#include "profile.h"
 
 /** Initialize buffer chunk
- *    - set max size of buffer and the current fill level
+ *    - attach the storage, the header directly in front of the data
+ *    - set size of buffer and the current fill level
  * Parameters:
  * @param pThis  pointer to own object
+ * @param pMem  CHUNK_WORDS(size) words of storage
+ * @param size  data bytes of the chunk
  *
  * @return Zero on success.
  * Negative value on failure.
  */
-int chunk_init(chunk_t *pThis)
+int chunk_init(chunk_t *pThis, unsigned int *pMem, int size)
 {
-    if ( NULL == pThis ) {
+    if ( NULL == pThis || NULL == pMem || 0 >= size ) {
         return FAIL;
     }
     
-    pThis->size = SAMPLE_SIZE;
+    // CHUNK_HDR_SIZE is a multiple of 4, the data stays word aligned
+    pThis->hdr      = (unsigned char *) pMem;
+    pThis->u08_buff = pThis->hdr + CHUNK_HDR_SIZE;
+    pThis->size = size;
     pThis->len  = 0; // default not filled
+    pThis->stamp = 0;
+    pThis->flags = 0;
     return PASS;
 }
 
 
 /** copy on chunk into another
+ *   - bulk of the data is moved in 32 bit words through the u32_buff
+ *     view, two words per iteration; the remaining 0..7 bytes are
+ *     copied one by one
+ *   - capture time and frame flags go along
+ *   - fails if the data does not fit the destination
  *@param pSrc  pointer to source object (will not be modified)
  *@param pDst  pointer to destination object (will get the data of the src object)
  *
@@ -47,15 +61,32 @@ int chunk_init(chunk_t *pThis)
 int chunk_copy(chunk_t *pSrc, chunk_t *pDst){
     unsigned int count;
     unsigned int len = pSrc->len;
-    
+    unsigned int words = (len / 8) * 2;
+    unsigned int *pS = pSrc->u32_buff;
+    unsigned int *pD = pDst->u32_buff;
+    unsigned int w0, w1;
+
+    if ( pSrc->len > pDst->size ) {
+        return FAIL;
+    }
+
+    PROFILE_BEGIN(PROFILE_CHUNK_COPY);
     // copy manually since memcpy does not work currently
-    // 
-    for ( count = 0; len > count; count++ ) {
+    // both buffers are word aligned (union with u32_buff)
+    for ( count = 0; words > count; count += 2 ) {
+        w0 = pS[count];
+        w1 = pS[count + 1];
+        pD[count]     = w0;
+        pD[count + 1] = w1;
+    }
+    for ( count = words * 4; len > count; count++ ) {
         pDst->u08_buff[count] = pSrc->u08_buff[count];
     }
     // update length of actual copied data
-    pDst->len = pSrc->len;
+    pDst->len   = pSrc->len;
+    pDst->stamp = pSrc->stamp;
+    pDst->flags = pSrc->flags;
+    PROFILE_END(PROFILE_CHUNK_COPY);
    
     return PASS;
 }
-
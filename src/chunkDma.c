@@ -0,0 +1,160 @@
+/**
+ *@file chunkDma.c
+ *
+ *@brief
+ *  - asynchronous chunk copy on memory DMA stream 0
+ *  - frees the core from the copy loop, completion is picked up by
+ *    polling the destination channel status
+ *
+ * Target:   TLL6527v1-0
+ * Compiler: VDSP++     Output format: VDSP++ "*.dxe"
+ *
+ *******************************************************************************/
+#include "tll_common.h"
+#include "chunkDma.h"
+#include <tll_config.h>
+
+/** Initialize chunk DMA
+ *    - stop memory DMA stream 0
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int chunkDma_init(chunkDma_t *pThis)
+{
+    if ( NULL == pThis ) {
+        printf("[CHUNK DMA]: Failed init\r\n");
+        return FAIL;
+    }
+
+    pThis->pSrc         = NULL;
+    pThis->pDst         = NULL;
+    pThis->callback     = NULL;
+    pThis->pCallbackArg = NULL;
+    pThis->busy         = 0;
+
+    *pMDMA_S0_CONFIG = 0;
+    *pMDMA_D0_CONFIG = 0;
+    *pMDMA_D0_IRQ_STATUS = DMA_DONE | DMA_ERR;  // clear stale status
+
+    printf("[CHUNK DMA]: init complete \r\n");
+
+    return PASS;
+}
+
+
+/** start copying pSrc into pDst
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pSrc  pointer to source chunk
+ * @param pDst  pointer to destination chunk
+ * @param callback  called from chunkDma_poll() on completion, may be NULL
+ * @param pArg  first argument passed to callback
+ *
+ * @return Zero on success.
+ * Negative value on failure (a copy is still in flight, or the data
+ * does not fit pDst).
+ */
+int chunkDma_copy(chunkDma_t *pThis, chunk_t *pSrc, chunk_t *pDst,
+                  chunkDma_callback_t callback, void *pArg)
+{
+    unsigned int count;
+    unsigned int len;
+    unsigned int words;
+
+    if ( NULL == pThis || NULL == pSrc || NULL == pDst || pThis->busy ) {
+        return FAIL;
+    }
+
+    // as chunk_copy, the data has to fit, checked before MDMA0 is set up
+    if ( pSrc->len > pDst->size ) {
+        return FAIL;
+    }
+
+    len   = pSrc->len;
+    words = len / 4;
+
+    pThis->pSrc         = pSrc;
+    pThis->pDst         = pDst;
+    pThis->callback     = callback;
+    pThis->pCallbackArg = pArg;
+    pThis->busy         = 1;
+
+    // tail bytes do not fill a word, copy them by hand
+    for ( count = words * 4; len > count; count++ ) {
+        pDst->u08_buff[count] = pSrc->u08_buff[count];
+    }
+    pDst->len = len;
+
+    if ( 0 == words ) {
+        // nothing for the DMA, report completion on next poll
+        return PASS;
+    }
+
+    /* 1. source: memory read, 32 bit */
+    *pMDMA_S0_START_ADDR = &pSrc->u32_buff[0];
+    *pMDMA_S0_X_COUNT    = words;
+    *pMDMA_S0_X_MODIFY   = 4;
+
+    /* 2. destination: memory write, 32 bit, flag DMA_DONE at the end */
+    *pMDMA_D0_START_ADDR = &pDst->u32_buff[0];
+    *pMDMA_D0_X_COUNT    = words;
+    *pMDMA_D0_X_MODIFY   = 4;
+
+    /* 3. enable source first, destination starts the transfer */
+    *pMDMA_S0_CONFIG = WDSIZE_32 | DMAEN;
+    *pMDMA_D0_CONFIG = WDSIZE_32 | WNR | DI_EN | DMAEN;
+
+    return PASS;
+}
+
+
+/** poll for completion
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return Zero if a copy completed during this call.
+ * Negative value otherwise.
+ */
+int chunkDma_poll(chunkDma_t *pThis)
+{
+    if ( NULL == pThis || 0 == pThis->busy ) {
+        return FAIL;
+    }
+
+    // byte-only copies never started the DMA
+    if ( 4 <= pThis->pSrc->len ) {
+        if ( 0 == (*pMDMA_D0_IRQ_STATUS & DMA_DONE) ) {
+            return FAIL;
+        }
+
+        *pMDMA_D0_IRQ_STATUS = DMA_DONE;    // write 1 to clear
+        *pMDMA_S0_CONFIG = 0;
+        *pMDMA_D0_CONFIG = 0;
+    }
+
+    pThis->busy = 0;
+    if ( NULL != pThis->callback ) {
+        pThis->callback(pThis->pCallbackArg, pThis->pDst);
+    }
+
+    return PASS;
+}
+
+
+/** Returns true if a copy is in flight
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return true (non-zero) if busy, 0 if idle
+ */
+int chunkDma_isBusy(chunkDma_t *pThis)
+{
+    return pThis->busy;
+}
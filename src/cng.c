@@ -0,0 +1,115 @@
+/**
+ *@file cng.c
+ *
+ *@brief
+ *  - comfort noise generation for the receive path
+ *
+ *  White noise, uniform in [-2*level, 2*level] so its mean magnitude
+ *  matches the level the far end measured for its background noise.
+ *
+ * Target:   TLL6527v1-0
+ * Compiler: VDSP++     Output format: VDSP++ "*.dxe"
+ *
+ *******************************************************************************/
+#include "tll_common.h"
+#include "cng.h"
+#include "compression.h"
+
+
+/** Initialize comfort noise generation
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int cng_init(cng_t *pThis)
+{
+	if ( NULL == pThis ) {
+		printf("[CNG]: Failed init\r\n");
+		return FAIL;
+	}
+
+	pThis->active = 0;
+	pThis->level  = 0;
+	pThis->len    = SAMPLE_SIZE;
+	pThis->seed   = 0x1234567;
+	pThis->frames = 0;
+
+	printf("[CNG]: Init complete\r\n");
+	return PASS;
+}
+
+
+/** a SID frame was received, start or update comfort noise
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pChunk  SID frame (codec header only)
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int cng_sid(cng_t *pThis, chunk_t *pChunk)
+{
+	if ( COMPRESSION_HDR_SIZE > pChunk->len || COMPRESSION_CODEC_SID != pChunk->u08_buff[0] ) {
+		return FAIL;
+	}
+
+	pThis->level  = pChunk->u08_buff[2] | (pChunk->u08_buff[3] << 8);
+	pThis->active = 1;
+
+	return PASS;
+}
+
+
+/** a speech frame is played, stop comfort noise
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param len  bytes of 16 bit PCM in the frame, used for noise frames
+ *
+ * @return void
+ */
+void cng_speech(cng_t *pThis, int len)
+{
+	pThis->active = 0;
+	pThis->len    = len;
+}
+
+
+/** fill a chunk with one frame of comfort noise
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pChunk  chunk to fill
+ *
+ * @return void
+ */
+void cng_generate(cng_t *pThis, chunk_t *pChunk)
+{
+	int count;
+	int samples = pThis->len / 2;
+	int amp = 2 * pThis->level;
+	unsigned int seed = pThis->seed;
+	short *pOut = pChunk->s16_buff;
+
+	if ( 32767 < amp ) {
+		amp = 32767;
+	}
+	// no speech frame seen yet, fill the chunk
+	if ( 2 * samples > pChunk->size ) {
+		samples = pChunk->size / 2;
+	}
+
+	for ( count = 0; samples > count; count++ ) {
+		seed = seed * 1664525 + 1013904223;
+		// top 16 bit as signed Q15 in [-1, 1)
+		pOut[count] = (short) ((((int) seed >> 16) * amp) >> 15);
+	}
+
+	pThis->seed = seed;
+	pChunk->len = samples * 2;
+	pThis->frames++;
+}
@@ -3,6 +3,8 @@
  *
  *@brief
  *  - compress data for transmission
+ *  - IMA ADPCM, 4:1 on 16 bit PCM
+ *  - G.711 mu-law / A-law, 2:1 on 16 bit PCM
  *
  * Target:   TLL6527v1-0
  * Compiler:
@@ -11,29 +13,384 @@
  * 		   Mark Hatch
  *
  *******************************************************************************/
-#include <stdlib.h>
-#include <stdio.h>
+#include "tll_common.h"
 #include "chunk.h"
 #include "compression.h"
 
+/** IMA ADPCM quantizer step sizes */
+const short adpcm_stepTable[89] = {
+	    7,     8,     9,    10,    11,    12,    13,    14,    16,    17,
+	   19,    21,    23,    25,    28,    31,    34,    37,    41,    45,
+	   50,    55,    60,    66,    73,    80,    88,    97,   107,   118,
+	  130,   143,   157,   173,   190,   209,   230,   253,   279,   307,
+	  337,   371,   408,   449,   494,   544,   598,   658,   724,   796,
+	  876,   963,  1060,  1166,  1282,  1411,  1552,  1707,  1878,  2066,
+	 2272,  2499,  2749,  3024,  3327,  3660,  4026,  4428,  4871,  5358,
+	 5894,  6484,  7132,  7845,  8630,  9493, 10442, 11487, 12635, 13899,
+	15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+/** IMA ADPCM step index adjustment per 4 bit code */
+const signed char adpcm_indexTable[16] = {
+	-1, -1, -1, -1, 2, 4, 6, 8,
+	-1, -1, -1, -1, 2, 4, 6, 8
+};
+
+/** G.711 segment (exponent) of a biased magnitude, indexed by bits 14..7 */
+static const unsigned char g711_expTable[256] = {
+	0, 0, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3,
+	4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+	5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5,
+	5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5,
+	6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+	6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+	6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+	6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+	7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+	7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+	7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+	7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+	7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+	7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+	7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+	7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7
+};
+
+/** A-law mantissa shift per segment, segment 0 is linear */
+static const unsigned char g711_alawShift[8] = {
+	4, 4, 5, 6, 7, 8, 9, 10
+};
+
+/**
+ * @def G711_ULAW_BIAS
+ * @brief mu-law magnitude bias
+ */
+#define G711_ULAW_BIAS	(0x84)
+
+/**
+ * @def G711_CLIP
+ * @brief largest magnitude representable by either G.711 law
+ */
+#define G711_CLIP	(32635)
+
+/** Encode one sample to mu-law without data dependent branches
+ *
+ * Parameters:
+ * @param sample  16 bit PCM sample
+ *
+ * @return mu-law code byte
+ */
+static inline unsigned char g711_encodeUlaw(int sample)
+{
+	int mask = sample >> 31;			// all ones for negative samples
+	int mag  = (sample ^ mask) - mask;	// abs
+	int exponent;
+
+	mag -= (mag - G711_CLIP) & ((G711_CLIP - mag) >> 31);	// min(mag, CLIP)
+	mag += G711_ULAW_BIAS;
+	exponent = g711_expTable[(mag >> 7) & 0xFF];
+
+	return (unsigned char) ~((mask & 0x80) | (exponent << 4) | ((mag >> (exponent + 3)) & 0x0F));
+}
+
+/** Encode one sample to A-law without data dependent branches
+ *
+ * Parameters:
+ * @param sample  16 bit PCM sample
+ *
+ * @return A-law code byte
+ */
+static inline unsigned char g711_encodeAlaw(int sample)
+{
+	int mask = sample >> 31;			// all ones for negative samples
+	int mag  = (sample ^ mask) - mask;	// abs
+	int exponent;
+
+	mag -= (mag - G711_CLIP) & ((G711_CLIP - mag) >> 31);	// min(mag, CLIP)
+	exponent = g711_expTable[(mag >> 7) & 0xFF];
+
+	return (unsigned char) ((((~mask) & 0x80) | (exponent << 4)
+			| ((mag >> g711_alawShift[exponent]) & 0x0F)) ^ 0x55);
+}
+
+/** Encode one sample and advance the encoder state
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param sample  16 bit PCM sample
+ *
+ * @return 4 bit ADPCM code
+ */
+static unsigned char adpcm_encodeSample(compression_t *pThis, int sample)
+{
+	int step = adpcm_stepTable[pThis->stepIndex];
+	int diff = sample - pThis->predictor;
+	int vpdiff = step >> 3;
+	unsigned char code = 0;
+
+	if ( diff < 0 ) {
+		code = 8;
+		diff = -diff;
+	}
+
+	/* successive approximation of diff/step in 3 bits */
+	if ( diff >= step ) {
+		code |= 4;
+		diff -= step;
+		vpdiff += step;
+	}
+	step >>= 1;
+	if ( diff >= step ) {
+		code |= 2;
+		diff -= step;
+		vpdiff += step;
+	}
+	step >>= 1;
+	if ( diff >= step ) {
+		code |= 1;
+		vpdiff += step;
+	}
+
+	/* track the decoder's reconstruction, not the input */
+	if ( code & 8 ) {
+		pThis->predictor -= vpdiff;
+	} else {
+		pThis->predictor += vpdiff;
+	}
+	if ( pThis->predictor > 32767 ) {
+		pThis->predictor = 32767;
+	} else if ( pThis->predictor < -32768 ) {
+		pThis->predictor = -32768;
+	}
+
+	pThis->stepIndex += adpcm_indexTable[code];
+	if ( pThis->stepIndex < 0 ) {
+		pThis->stepIndex = 0;
+	} else if ( pThis->stepIndex > 88 ) {
+		pThis->stepIndex = 88;
+	}
+
+	return code;
+}
+
 /** Configures a blank state structure
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return Zero on success.
+ * 			Negative value on failure.
+ */
+int compression_init(compression_t *pThis)
+{
+	if ( NULL == pThis ) {
+		printf("[COMP]: Failed init\r\n");
+		return FAIL;
+	}
+
+	pThis->codec     = COMPRESSION_CODEC_ADPCM;
+	pThis->predictor = 0;
+	pThis->stepIndex = 0;
+
+	printf("[COMP]: Init complete, codec: %d\r\n", pThis->codec);
+	return PASS;
+}
+
+/** Select the codec for the following chunks
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param codec  COMPRESSION_CODEC_xxx
  *
  * @return Zero on success.
  * 			Negative value on failure.
  */
-int compression_init(compression_t *state)
+int compression_setCodec(compression_t *pThis, int codec)
+{
+	if ( NULL == pThis || 0 > compression_chunkLen(codec, 0) ) {
+		printf("[COMP]: Unknown codec %d\r\n", codec);
+		return FAIL;
+	}
+
+	if ( codec != pThis->codec ) {
+		// restart ADPCM adaptation from a known state
+		pThis->predictor = 0;
+		pThis->stepIndex = 0;
+		pThis->codec     = codec;
+	}
+
+	return PASS;
+}
+
+/** Compressed length of a chunk
+ *
+ * Parameters:
+ * @param codec  COMPRESSION_CODEC_xxx
+ * @param len  bytes of 16 bit PCM
+ *
+ * @return compressed length in bytes, Negative value on unknown codec
+ */
+int compression_chunkLen(int codec, int len)
 {
-    printf("[INIT] Compression BIT: %d RATE: %d\n", SHIFT, SAMPLE_DIV);
-    state = NULL;
-    return PASS;
+	switch ( codec ) {
+	case COMPRESSION_CODEC_ADPCM:
+		return COMPRESSION_ADPCM_LEN(len);
+	case COMPRESSION_CODEC_ULAW:
+	case COMPRESSION_CODEC_ALAW:
+		return COMPRESSION_G711_LEN(len);
+	default:
+		return FAIL;
+	}
 }
 
-/** Takes a chunk and compresses it
+/** G.711 compress a chunk, one byte per sample
+ *    - in place if pSrc and pDst are the same chunk
+ *
+ * Parameters:
+ * @param codec  COMPRESSION_CODEC_ULAW or COMPRESSION_CODEC_ALAW
+ * @param pSrc  chunk of 16 bit PCM
+ * @param pDst  chunk to compress into
+ *
+ * @return void
+ */
+static void g711_compress(int codec, chunk_t *pSrc, chunk_t *pDst)
+{
+	int count;
+	int head;
+	int samples = (pSrc->len / 4) * 2;
+	unsigned char first[COMPRESSION_HDR_SIZE];
+	unsigned char *pOut = &pDst->u08_buff[COMPRESSION_HDR_SIZE];
+
+	/* byte HDR+n would land on sample (HDR+n)/2 before it is read for
+	 * n < HDR, so encode the first HDR samples up front */
+	head = samples < COMPRESSION_HDR_SIZE ? samples : COMPRESSION_HDR_SIZE;
+
+	if ( COMPRESSION_CODEC_ULAW == codec ) {
+		for ( count = 0; head > count; count++ ) {
+			first[count] = g711_encodeUlaw(pSrc->s16_buff[count]);
+		}
+		for ( ; samples > count; count++ ) {
+			pOut[count] = g711_encodeUlaw(pSrc->s16_buff[count]);
+		}
+	} else {
+		for ( count = 0; head > count; count++ ) {
+			first[count] = g711_encodeAlaw(pSrc->s16_buff[count]);
+		}
+		for ( ; samples > count; count++ ) {
+			pOut[count] = g711_encodeAlaw(pSrc->s16_buff[count]);
+		}
+	}
+
+	for ( count = 0; head > count; count++ ) {
+		pOut[count] = first[count];
+	}
+
+	pDst->u08_buff[0] = (unsigned char) codec;
+	pDst->u08_buff[1] = 0;
+	pDst->u08_buff[2] = 0;
+	pDst->u08_buff[3] = 0;
+
+	pDst->len = COMPRESSION_HDR_SIZE + samples;
+}
+
+/** ADPCM compress a chunk
+ *    - header holds the encoder state at the start of the chunk so every
+ *      chunk can be decoded on its own (lost chunks do not desync)
+ *    - two codes per byte, first sample in the low nibble
+ *    - in place if pSrc and pDst are the same chunk
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pSrc  chunk of 16 bit PCM
+ * @param pDst  chunk to compress into
+ *
+ * @return void
+ */
+static void adpcm_compress(compression_t *pThis, chunk_t *pSrc, chunk_t *pDst)
+{
+	int count;
+	int samples;
+	int hdrPredictor;
+	int hdrStepIndex;
+	unsigned char code;
+	unsigned char pending = 0;
+	unsigned char *pOut;
+
+	// encode sample pairs only, chunks are filled in 32 bit words
+	samples = (pSrc->len / 4) * 2;
+	pOut = &pDst->u08_buff[COMPRESSION_HDR_SIZE];
+
+	hdrPredictor = pThis->predictor;
+	hdrStepIndex = pThis->stepIndex;
+
+	for ( count = 0; samples > count; count += 2 ) {
+		code  = adpcm_encodeSample(pThis, pSrc->s16_buff[count]);
+		code |= adpcm_encodeSample(pThis, pSrc->s16_buff[count + 1]) << 4;
+
+		/* output trails the input by one byte: the first output byte
+		 * would otherwise land on sample 2 before it has been read */
+		if ( 0 != count ) {
+			*pOut++ = pending;
+		}
+		pending = code;
+	}
+	if ( 0 != samples ) {
+		*pOut++ = pending;
+	}
+
+	// samples 0 and 1 have been consumed, header may overwrite them
+	pDst->u08_buff[0] = COMPRESSION_CODEC_ADPCM;
+	pDst->u08_buff[1] = (unsigned char) hdrStepIndex;
+	pDst->u08_buff[2] = (unsigned char) (hdrPredictor & 0xFF);
+	pDst->u08_buff[3] = (unsigned char) ((hdrPredictor >> 8) & 0xFF);
+
+	pDst->len = COMPRESSION_HDR_SIZE + samples/2;
+}
+
+/** Takes a chunk of 16 bit PCM and compresses it in place
+ *    with the currently selected codec
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pchunk  chunk to compress
  *
  * @return Zero on success.
  * 			Negative value on failure.
  */
 int compressData(compression_t *pThis, chunk_t *pchunk ) {
-	// implement compression here
 
+	return compressDataTo(pThis, pchunk, pchunk);
+}
+
+/** Takes a chunk of 16 bit PCM and compresses it into another chunk
+ *    with the currently selected codec
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pSrc  chunk of 16 bit PCM (not modified unless it is pDst)
+ * @param pDst  chunk to compress into, may be pSrc
+ *
+ * @return Zero on success.
+ * 			Negative value on failure.
+ */
+int compressDataTo(compression_t *pThis, chunk_t *pSrc, chunk_t *pDst ) {
+
+	if ( NULL == pThis || NULL == pSrc || NULL == pDst
+	     || compression_chunkLen(pThis->codec, pSrc->len) > pDst->size ) {
+		return FAIL;
+	}
+
+	switch ( pThis->codec ) {
+	case COMPRESSION_CODEC_ADPCM:
+		adpcm_compress(pThis, pSrc, pDst);
+		break;
+	case COMPRESSION_CODEC_ULAW:
+	case COMPRESSION_CODEC_ALAW:
+		g711_compress(pThis->codec, pSrc, pDst);
+		break;
+	default:
+		return FAIL;
+	}
+
+	return PASS;
 }
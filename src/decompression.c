@@ -3,6 +3,8 @@
  *
  *@brief
  *  - decompress received data
+ *  - IMA ADPCM, 1:4 to 16 bit PCM
+ *  - G.711 mu-law / A-law, 1:2 to 16 bit PCM
  *
  * Target:   TLL6527v1-0
  * Compiler:
@@ -11,29 +13,304 @@
  * 		   Mark Hatch
  *
  *******************************************************************************/
-#include <stdlib.h>
-#include <stdio.h>
+#include "tll_common.h"
 #include "chunk.h"
 #include "decompression.h"
 
+/** G.711 mu-law to 16 bit PCM */
+const short g711_ulawTable[256] = {
+	-32124, -31100, -30076, -29052, -28028, -27004, -25980, -24956,
+	-23932, -22908, -21884, -20860, -19836, -18812, -17788, -16764,
+	-15996, -15484, -14972, -14460, -13948, -13436, -12924, -12412,
+	-11900, -11388, -10876, -10364,  -9852,  -9340,  -8828,  -8316,
+	 -7932,  -7676,  -7420,  -7164,  -6908,  -6652,  -6396,  -6140,
+	 -5884,  -5628,  -5372,  -5116,  -4860,  -4604,  -4348,  -4092,
+	 -3900,  -3772,  -3644,  -3516,  -3388,  -3260,  -3132,  -3004,
+	 -2876,  -2748,  -2620,  -2492,  -2364,  -2236,  -2108,  -1980,
+	 -1884,  -1820,  -1756,  -1692,  -1628,  -1564,  -1500,  -1436,
+	 -1372,  -1308,  -1244,  -1180,  -1116,  -1052,   -988,   -924,
+	  -876,   -844,   -812,   -780,   -748,   -716,   -684,   -652,
+	  -620,   -588,   -556,   -524,   -492,   -460,   -428,   -396,
+	  -372,   -356,   -340,   -324,   -308,   -292,   -276,   -260,
+	  -244,   -228,   -212,   -196,   -180,   -164,   -148,   -132,
+	  -120,   -112,   -104,    -96,    -88,    -80,    -72,    -64,
+	   -56,    -48,    -40,    -32,    -24,    -16,     -8,      0,
+	 32124,  31100,  30076,  29052,  28028,  27004,  25980,  24956,
+	 23932,  22908,  21884,  20860,  19836,  18812,  17788,  16764,
+	 15996,  15484,  14972,  14460,  13948,  13436,  12924,  12412,
+	 11900,  11388,  10876,  10364,   9852,   9340,   8828,   8316,
+	  7932,   7676,   7420,   7164,   6908,   6652,   6396,   6140,
+	  5884,   5628,   5372,   5116,   4860,   4604,   4348,   4092,
+	  3900,   3772,   3644,   3516,   3388,   3260,   3132,   3004,
+	  2876,   2748,   2620,   2492,   2364,   2236,   2108,   1980,
+	  1884,   1820,   1756,   1692,   1628,   1564,   1500,   1436,
+	  1372,   1308,   1244,   1180,   1116,   1052,    988,    924,
+	   876,    844,    812,    780,    748,    716,    684,    652,
+	   620,    588,    556,    524,    492,    460,    428,    396,
+	   372,    356,    340,    324,    308,    292,    276,    260,
+	   244,    228,    212,    196,    180,    164,    148,    132,
+	   120,    112,    104,     96,     88,     80,     72,     64,
+	    56,     48,     40,     32,     24,     16,      8,      0
+};
+
+/** G.711 A-law to 16 bit PCM */
+const short g711_alawTable[256] = {
+	 -5504,  -5248,  -6016,  -5760,  -4480,  -4224,  -4992,  -4736,
+	 -7552,  -7296,  -8064,  -7808,  -6528,  -6272,  -7040,  -6784,
+	 -2752,  -2624,  -3008,  -2880,  -2240,  -2112,  -2496,  -2368,
+	 -3776,  -3648,  -4032,  -3904,  -3264,  -3136,  -3520,  -3392,
+	-22016, -20992, -24064, -23040, -17920, -16896, -19968, -18944,
+	-30208, -29184, -32256, -31232, -26112, -25088, -28160, -27136,
+	-11008, -10496, -12032, -11520,  -8960,  -8448,  -9984,  -9472,
+	-15104, -14592, -16128, -15616, -13056, -12544, -14080, -13568,
+	  -344,   -328,   -376,   -360,   -280,   -264,   -312,   -296,
+	  -472,   -456,   -504,   -488,   -408,   -392,   -440,   -424,
+	   -88,    -72,   -120,   -104,    -24,     -8,    -56,    -40,
+	  -216,   -200,   -248,   -232,   -152,   -136,   -184,   -168,
+	 -1376,  -1312,  -1504,  -1440,  -1120,  -1056,  -1248,  -1184,
+	 -1888,  -1824,  -2016,  -1952,  -1632,  -1568,  -1760,  -1696,
+	  -688,   -656,   -752,   -720,   -560,   -528,   -624,   -592,
+	  -944,   -912,  -1008,   -976,   -816,   -784,   -880,   -848,
+	  5504,   5248,   6016,   5760,   4480,   4224,   4992,   4736,
+	  7552,   7296,   8064,   7808,   6528,   6272,   7040,   6784,
+	  2752,   2624,   3008,   2880,   2240,   2112,   2496,   2368,
+	  3776,   3648,   4032,   3904,   3264,   3136,   3520,   3392,
+	 22016,  20992,  24064,  23040,  17920,  16896,  19968,  18944,
+	 30208,  29184,  32256,  31232,  26112,  25088,  28160,  27136,
+	 11008,  10496,  12032,  11520,   8960,   8448,   9984,   9472,
+	 15104,  14592,  16128,  15616,  13056,  12544,  14080,  13568,
+	   344,    328,    376,    360,    280,    264,    312,    296,
+	   472,    456,    504,    488,    408,    392,    440,    424,
+	    88,     72,    120,    104,     24,      8,     56,     40,
+	   216,    200,    248,    232,    152,    136,    184,    168,
+	  1376,   1312,   1504,   1440,   1120,   1056,   1248,   1184,
+	  1888,   1824,   2016,   1952,   1632,   1568,   1760,   1696,
+	   688,    656,    752,    720,    560,    528,    624,    592,
+	   944,    912,   1008,    976,    816,    784,    880,    848
+};
+
+/** Decode one 4 bit code and advance the decoder state
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param code  4 bit ADPCM code
+ *
+ * @return reconstructed 16 bit sample
+ */
+static short adpcm_decodeSample(decompression_t *pThis, unsigned char code)
+{
+	int step = adpcm_stepTable[pThis->stepIndex];
+	int vpdiff = step >> 3;
+
+	if ( code & 4 ) {
+		vpdiff += step;
+	}
+	if ( code & 2 ) {
+		vpdiff += step >> 1;
+	}
+	if ( code & 1 ) {
+		vpdiff += step >> 2;
+	}
+
+	if ( code & 8 ) {
+		pThis->predictor -= vpdiff;
+	} else {
+		pThis->predictor += vpdiff;
+	}
+	if ( pThis->predictor > 32767 ) {
+		pThis->predictor = 32767;
+	} else if ( pThis->predictor < -32768 ) {
+		pThis->predictor = -32768;
+	}
+
+	pThis->stepIndex += adpcm_indexTable[code];
+	if ( pThis->stepIndex < 0 ) {
+		pThis->stepIndex = 0;
+	} else if ( pThis->stepIndex > 88 ) {
+		pThis->stepIndex = 88;
+	}
+
+	return (short) pThis->predictor;
+}
+
 /** Configures a blank state structure
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return Zero on success.
+ * 			Negative value on failure.
+ */
+int decompression_init(decompression_t *pThis)
+{
+	if ( NULL == pThis ) {
+		printf("[DECOMP]: Failed init\r\n");
+		return FAIL;
+	}
+
+	pThis->predictor = 0;
+	pThis->stepIndex = 0;
+
+	printf("[DECOMP]: Init complete\r\n");
+	return PASS;
+}
+
+/** Move the compressed payload to the end of the chunk buffer
+ *    - back to front, the destination never lies below the source
+ *    - decoding front to back from there never overtakes the input as
+ *      long as the decoded data fits pchunk->size
+ *
+ * Parameters:
+ * @param pchunk  chunk holding header + bytes of payload
+ * @param bytes  payload bytes behind the codec header
+ *
+ * @return pointer to the first moved payload byte
+ */
+static unsigned char *decompression_moveToTail(chunk_t *pchunk, int bytes)
+{
+	int count;
+	int offset = pchunk->size - bytes;
+
+	for ( count = bytes - 1; 0 <= count; count-- ) {
+		pchunk->u08_buff[offset + count] = pchunk->u08_buff[COMPRESSION_HDR_SIZE + count];
+	}
+
+	return &pchunk->u08_buff[offset];
+}
+
+/** payload of a chunk to decompress
+ *    - in place it is moved to the tail first
+ *
+ * Parameters:
+ * @param pSrc  chunk holding header + bytes of payload
+ * @param pDst  chunk to decompress into
+ * @param bytes  payload bytes behind the codec header
+ *
+ * @return pointer to the first payload byte
+ */
+static unsigned char *decompression_input(chunk_t *pSrc, chunk_t *pDst, int bytes)
+{
+	if ( pSrc == pDst ) {
+		return decompression_moveToTail(pDst, bytes);
+	}
+	return &pSrc->u08_buff[COMPRESSION_HDR_SIZE];
+}
+
+/** ADPCM decompress a chunk
+ *    - in place if pSrc and pDst are the same chunk
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pSrc  chunk to decompress
+ * @param pDst  chunk to decompress into
+ *
+ * @return Zero on success.
+ * 			Negative value on failure.
+ */
+static int adpcm_decompress(decompression_t *pThis, chunk_t *pSrc, chunk_t *pDst)
+{
+	int count;
+	int stepIndex;
+	int bytes = pSrc->len - COMPRESSION_HDR_SIZE;
+	unsigned char code;
+	unsigned char *pIn;
+	short *pOut;
+
+	stepIndex = pSrc->u08_buff[1];
+	if ( bytes * 4 > pDst->size || 88 < stepIndex ) {
+		return FAIL;
+	}
+
+	/* re-seed from the header so a lost chunk does not desync the stream */
+	pThis->stepIndex = stepIndex;
+	pThis->predictor = (short) (pSrc->u08_buff[2] | (pSrc->u08_buff[3] << 8));
+
+	pIn  = decompression_input(pSrc, pDst, bytes);
+	pOut = pDst->s16_buff;
+	for ( count = 0; bytes > count; count++ ) {
+		code = pIn[count];
+		*pOut++ = adpcm_decodeSample(pThis, code & 0x0F);
+		*pOut++ = adpcm_decodeSample(pThis, code >> 4);
+	}
+
+	pDst->len = bytes * 4;
+
+	return PASS;
+}
+
+/** G.711 decompress a chunk, one table lookup per sample
+ *    - in place if pSrc and pDst are the same chunk
+ *
+ * Parameters:
+ * @param pTable  g711_ulawTable or g711_alawTable
+ * @param pSrc  chunk to decompress
+ * @param pDst  chunk to decompress into
  *
  * @return Zero on success.
  * 			Negative value on failure.
  */
-int decompression_init(decompression_t *state)
+static int g711_decompress(const short *pTable, chunk_t *pSrc, chunk_t *pDst)
 {
-    printf("[INIT] Decompression BIT: %d RATE: %d\n", SHIFT, SAMPLE_DIV);
-    state = NULL;
-    return PASS;
+	int count;
+	int bytes = pSrc->len - COMPRESSION_HDR_SIZE;
+	unsigned char *pIn;
+	short *pOut;
+
+	if ( bytes * 2 > pDst->size ) {
+		return FAIL;
+	}
+
+	pIn  = decompression_input(pSrc, pDst, bytes);
+	pOut = pDst->s16_buff;
+	for ( count = 0; bytes > count; count++ ) {
+		pOut[count] = pTable[pIn[count]];
+	}
+
+	pDst->len = bytes * 2;
+
+	return PASS;
 }
 
-/** Receive a chunk and decompress it
+/** Receive a chunk and decompress it in place
+ *    - codec is taken from the chunk header
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pchunk  chunk to decompress
  *
  * @return Zero on success.
  * 			Negative value on failure.
  */
 int decompressData(decompression_t *pThis, chunk_t *pchunk ) {
-	// implement decompression here
 
+	return decompressDataTo(pThis, pchunk, pchunk);
+}
+
+/** Receive a chunk and decompress it into another chunk
+ *    - codec is taken from the chunk header
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pSrc  chunk to decompress (not modified unless it is pDst)
+ * @param pDst  chunk to decompress into, may be pSrc
+ *
+ * @return Zero on success.
+ * 			Negative value on failure.
+ */
+int decompressDataTo(decompression_t *pThis, chunk_t *pSrc, chunk_t *pDst ) {
+
+	if ( NULL == pThis || NULL == pSrc || NULL == pDst || COMPRESSION_HDR_SIZE > pSrc->len ) {
+		return FAIL;
+	}
+
+	switch ( pSrc->u08_buff[0] ) {
+	case COMPRESSION_CODEC_ADPCM:
+		return adpcm_decompress(pThis, pSrc, pDst);
+	case COMPRESSION_CODEC_ULAW:
+		return g711_decompress(g711_ulawTable, pSrc, pDst);
+	case COMPRESSION_CODEC_ALAW:
+		return g711_decompress(g711_alawTable, pSrc, pDst);
+	default:
+		return FAIL;
+	}
 }
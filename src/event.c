@@ -0,0 +1,156 @@
+/**
+ *@file event.c
+ *
+ *@brief
+ *  - event flags from the ISRs, idle sleep of the main loop
+ *
+ * Target:   TLL6527v1-0
+ * Compiler: VDSP++     Output format: VDSP++ "*.dxe"
+ *
+ *******************************************************************************/
+#include "tll_common.h"
+#include "event.h"
+#include "critical.h"
+#include "cycles.h"
+
+
+/** Initialize events, none pending
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int event_init(event_t *pThis)
+{
+	int count;
+
+	if ( NULL == pThis ) {
+		return FAIL;
+	}
+
+	for ( count = 0; EVENT_NUM > count; count++ ) {
+		pThis->pending[count] = 0;
+		pThis->posted[count]  = 0;
+	}
+	pThis->last             = cycles_read();
+	pThis->stats.cycles     = 0;
+	pThis->stats.idleCycles = 0;
+	pThis->stats.wakeups    = 0;
+	pThis->stats.latencySum = 0;
+	pThis->stats.latencyMax = 0;
+	return PASS;
+}
+
+
+/** post an event (ISR)
+ *   time stamp first, the flag publishes it
+ *
+ * Parameters:
+ * @param pThis  pointer to own object, no event if NULL
+ * @param id  event to post
+ *
+ * @return void
+ */
+void event_post(event_t *pThis, event_id_t id)
+{
+	if ( NULL == pThis ) {
+		return;
+	}
+	pThis->posted[id]  = cycles_read();
+	pThis->pending[id] = 1;
+}
+
+
+/** wait for events (main loop)
+ *   checks the flags with interrupts disabled and idles with them
+ *   enabled again in one go, a post can not slip in between the check
+ *   and the sleep; after a sleep the time from the post to here is
+ *   the wakeup latency
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return set of EVENT_MASK() bits
+ */
+unsigned int event_wait(event_t *pThis)
+{
+	unsigned int events = 0;
+	unsigned int mask;
+	unsigned int start;
+	unsigned int now;
+	unsigned int latency;
+	int slept = 0;
+	int count;
+
+	mask = critical_enter();
+	while ( 1 ) {
+		for ( count = 0; EVENT_NUM > count; count++ ) {
+			if ( pThis->pending[count] ) {
+				pThis->pending[count] = 0;
+				events |= EVENT_MASK(count);
+			}
+		}
+		if ( 0 != events ) {
+			break;
+		}
+		start = cycles_read();
+		critical_idle(mask);
+		pThis->stats.idleCycles += cycles_read() - start;
+		slept = 1;
+		mask = critical_enter();
+	}
+	critical_exit(mask);
+
+	now = cycles_read();
+	pThis->stats.cycles += now - pThis->last;
+	pThis->last = now;
+
+	if ( slept ) {
+		// the earliest post ended the idle
+		latency = 0;
+		for ( count = 0; EVENT_NUM > count; count++ ) {
+			if ( (events & EVENT_MASK(count)) && latency < now - pThis->posted[count] ) {
+				latency = now - pThis->posted[count];
+			}
+		}
+		pThis->stats.wakeups++;
+		pThis->stats.latencySum += latency;
+		if ( pThis->stats.latencyMax < latency ) {
+			pThis->stats.latencyMax = latency;
+		}
+	}
+	return events;
+}
+
+
+/** print idle fraction, wakeups and wakeup latency since the last
+ *   report, then restart the statistics
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return void
+ */
+void event_report(event_t *pThis)
+{
+	event_stats_t *pStats = &pThis->stats;
+	unsigned int idle = 0;     // [0.01 %]
+	unsigned int avg  = 0;     // [cycles]
+
+	if ( 0 != pStats->cycles ) {
+		idle = (unsigned int) (pStats->idleCycles * 10000 / pStats->cycles);
+	}
+	if ( 0 != pStats->wakeups ) {
+		avg = pStats->latencySum / pStats->wakeups;
+	}
+	printf("[EVENT]: idle %u.%02u %%, %u wakeups, wakeup latency avg %u max %u cycles\r\n",
+	       idle / 100, idle % 100, pStats->wakeups, avg, pStats->latencyMax);
+
+	pStats->cycles     = 0;
+	pStats->idleCycles = 0;
+	pStats->wakeups    = 0;
+	pStats->latencySum = 0;
+	pStats->latencyMax = 0;
+}
@@ -0,0 +1,159 @@
+/**
+ *@file fpgaImage.c
+ *
+ *@brief
+ *  - streaming decompression of the packed FPGA bitstream, see
+ *    fpgaImage.h for the format
+ *
+ * Target:   TLL6527v1-0
+ * Compiler: VDSP++     Output format: VDSP++ "*.dxe"
+ *
+ *******************************************************************************/
+#include "tll_common.h"
+#include "fpgaImage.h"
+
+
+/** Initialize the decompressor on a packed image
+ *    - checks the header
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pSrc  packed image
+ * @param srcLen  bytes of the packed image
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int fpgaImage_init(fpgaImage_t *pThis, const unsigned char *pSrc, int srcLen)
+{
+	if ( NULL == pThis || NULL == pSrc || FPGAIMAGE_HDR_SIZE > srcLen ) {
+		return FAIL;
+	}
+	if ( 'F' != pSrc[0] || 'Z' != pSrc[1] || FPGAIMAGE_VERSION != pSrc[2] ) {
+		return FAIL;
+	}
+
+	pThis->pSrc    = pSrc;
+	pThis->srcLen  = srcLen;
+	pThis->srcPos  = FPGAIMAGE_HDR_SIZE;
+	pThis->size    = pSrc[4] | (pSrc[5] << 8) | (pSrc[6] << 16) | ((unsigned int) pSrc[7] << 24);
+	pThis->done    = 0;
+	pThis->literal = 0;
+	pThis->match   = 0;
+	pThis->dist    = 0;
+	return PASS;
+}
+
+
+/** unpacked size of the image
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return bytes
+ */
+unsigned int fpgaImage_size(fpgaImage_t *pThis)
+{
+	return pThis->size;
+}
+
+
+/** next packed byte
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return byte, negative past the end of the packed image
+ */
+static int fpgaImage_byte(fpgaImage_t *pThis)
+{
+	if ( pThis->srcLen <= pThis->srcPos ) {
+		return FAIL;
+	}
+	return pThis->pSrc[pThis->srcPos++];
+}
+
+
+/** decode the next token
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return Zero on success.
+ * Negative value on a corrupt image.
+ */
+static int fpgaImage_token(fpgaImage_t *pThis)
+{
+	int token = fpgaImage_byte(pThis);
+	int lo;
+	int hi;
+
+	if ( 0 > token ) {
+		return FAIL;
+	}
+	if ( 0x80 > token ) {
+		pThis->literal = token + 1;
+		return PASS;
+	}
+
+	pThis->match = (token & 0x7F) + FPGAIMAGE_MATCH_MIN;
+	if ( FPGAIMAGE_MATCH_EXT == token ) {
+		lo = fpgaImage_byte(pThis);
+		hi = fpgaImage_byte(pThis);
+		if ( 0 > lo || 0 > hi ) {
+			return FAIL;
+		}
+		pThis->match += lo | (hi << 8);
+	}
+	lo = fpgaImage_byte(pThis);
+	hi = fpgaImage_byte(pThis);
+	if ( 0 > lo || 0 > hi ) {
+		return FAIL;
+	}
+	pThis->dist = (lo | (hi << 8)) + 1;
+	if ( FPGAIMAGE_WINDOW < pThis->dist || pThis->done < pThis->dist ) {
+		return FAIL;
+	}
+	return PASS;
+}
+
+
+/** produce the next block of the image
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pDst  block to fill
+ * @param max  size of the block
+ *
+ * @return bytes produced, zero at the end of the image.
+ * Negative value on a corrupt image.
+ */
+int fpgaImage_read(fpgaImage_t *pThis, unsigned char *pDst, int max)
+{
+	int count = 0;
+	int value;
+
+	while ( max > count && pThis->size > pThis->done ) {
+		if ( 0 != pThis->literal ) {
+			value = fpgaImage_byte(pThis);
+			if ( 0 > value ) {
+				return FAIL;
+			}
+			pThis->literal--;
+		} else if ( 0 != pThis->match ) {
+			value = pThis->window[(pThis->done - pThis->dist) & (FPGAIMAGE_WINDOW - 1)];
+			pThis->match--;
+		} else {
+			if ( PASS != fpgaImage_token(pThis) ) {
+				return FAIL;
+			}
+			continue;
+		}
+
+		pThis->window[pThis->done & (FPGAIMAGE_WINDOW - 1)] = (unsigned char) value;
+		pThis->done++;
+		pDst[count++] = (unsigned char) value;
+	}
+
+	return count;
+}
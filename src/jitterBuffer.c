@@ -0,0 +1,372 @@
+/**
+ *@file jitterBuffer.c
+ *
+ *@brief
+ *  - adaptive jitter buffer between UART receive and audio playback
+ *
+ *  The inter-arrival time of the frames is compared against their
+ *  sequence numbers (interarrival jitter as in RFC 3550). The playout
+ *  delay is set to cover JB_JITTER_MULT times the mean jitter, raised
+ *  after each underrun and lowered again while playout runs clean.
+ *  Frames beyond the target are discarded slowly to bring the latency
+ *  back down.
+ *
+ * Target:   TLL6527v1-0
+ * Compiler: VDSP++     Output format: VDSP++ "*.dxe"
+ *
+ *******************************************************************************/
+#include "tll_common.h"
+#include "jitterBuffer.h"
+#include "frame.h"
+#include "cycles.h"
+
+
+/** recompute the target depth from jitter estimate and underrun boost
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return void
+ */
+static void jitterBuffer_updateTarget(jitterBuffer_t *pThis)
+{
+	int target = JB_MIN_DEPTH + pThis->boost;
+
+	if ( 0 != pThis->period ) {
+		target += (JB_JITTER_MULT * pThis->jitter + pThis->period - 1) / pThis->period;
+	}
+	if ( JB_MAX_DEPTH < target ) {
+		target = JB_MAX_DEPTH;
+	}
+
+	pThis->target = target;
+}
+
+
+/** update period and jitter estimate with an arrival
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param seq  sequence number of the arrived frame
+ *
+ * @return void
+ */
+static void jitterBuffer_arrival(jitterBuffer_t *pThis, unsigned short seq)
+{
+	unsigned int now = cycles_read();
+	unsigned int elapsed;
+	unsigned int perFrame;
+	int dSeq = (short) (seq - pThis->lastSeq);
+	int dev;
+
+	if ( pThis->seqValid && 0 < dSeq && JB_SLOTS > dSeq ) {
+		elapsed  = now - pThis->lastArrival;
+		perFrame = elapsed / dSeq;
+
+		if ( 0 == pThis->period ) {
+			pThis->period = perFrame;
+		} else if ( (unsigned int) (4 * JB_SLOTS) * pThis->period > elapsed ) {
+			// (longer gaps are outages, not jitter)
+			dev = (int) (elapsed - dSeq * pThis->period);
+			if ( 0 > dev ) {
+				dev = -dev;
+			}
+			pThis->jitter += ((int) dev - (int) pThis->jitter) / 16;
+			pThis->period += ((int) perFrame - (int) pThis->period) / 16;
+			jitterBuffer_updateTarget(pThis);
+		}
+	}
+
+	if ( !pThis->seqValid || 0 < dSeq || JB_RESYNC_GAP <= -dSeq ) {
+		pThis->lastSeq     = seq;
+		pThis->lastArrival = now;
+	}
+}
+
+
+/** release the frame in the slot of nextSeq and advance
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return void
+ */
+static void jitterBuffer_skip(jitterBuffer_t *pThis)
+{
+	int slot = pThis->nextSeq & (JB_SLOTS - 1);
+
+	if ( NULL != pThis->slots[slot] ) {
+		bufferPool_release(pThis->pBuffP, pThis->slots[slot]);
+		pThis->slots[slot] = NULL;
+		pThis->depth--;
+		pThis->discarded++;
+	} else {
+		pThis->lost++;
+	}
+	pThis->nextSeq++;
+}
+
+
+/** release all buffered frames
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return void
+ */
+static void jitterBuffer_flush(jitterBuffer_t *pThis)
+{
+	int count;
+
+	for ( count = 0; JB_SLOTS > count; count++ ) {
+		if ( NULL != pThis->slots[count] ) {
+			bufferPool_release(pThis->pBuffP, pThis->slots[count]);
+			pThis->slots[count] = NULL;
+			pThis->discarded++;
+		}
+	}
+	pThis->depth = 0;
+}
+
+
+/** Initialize jitter buffer
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pBuffP  pointer to buffer pool to return dropped chunks to
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int jitterBuffer_init(jitterBuffer_t *pThis, bufferPool_t *pBuffP)
+{
+	int count;
+
+	if ( NULL == pThis || NULL == pBuffP ) {
+		printf("[JB]: Failed init\r\n");
+		return FAIL;
+	}
+
+	for ( count = 0; JB_SLOTS > count; count++ ) {
+		pThis->slots[count] = NULL;
+	}
+	pThis->pBuffP        = pBuffP;
+	pThis->seqValid      = 0;
+	pThis->playing       = 0;
+	pThis->dtx           = 0;
+	pThis->dtxSeq        = 0;
+	pThis->nextSeq       = 0;
+	pThis->lastSeq       = 0;
+	pThis->lastArrival   = 0;
+	pThis->period        = 0;
+	pThis->jitter        = 0;
+	pThis->depth         = 0;
+	pThis->boost         = 0;
+	pThis->sinceUnderrun = 0;
+	pThis->sinceShrink   = 0;
+	pThis->late          = 0;
+	pThis->lost          = 0;
+	pThis->underruns     = 0;
+	pThis->discarded     = 0;
+	jitterBuffer_updateTarget(pThis);
+
+	printf("[JB]: Init complete\r\n");
+	return PASS;
+}
+
+
+/** put a received frame
+ *    - ownership of pChunk passes to the jitter buffer
+ *    - late, duplicate and out of window frames are released
+ *    - updates the jitter estimate and the target depth
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pChunk  framed chunk (see frame.h)
+ *
+ * @return Zero on success.
+ * Negative value on failure (chunk dropped).
+ */
+int jitterBuffer_put(jitterBuffer_t *pThis, chunk_t *pChunk)
+{
+	unsigned short seq;
+	int ahead;
+	int slot;
+
+	if ( NULL == pThis || NULL == pChunk ) {
+		return FAIL;
+	}
+
+	seq = frame_seq(pChunk);
+	jitterBuffer_arrival(pThis, seq);
+
+	ahead = (short) (seq - pThis->nextSeq);
+	if ( !pThis->seqValid || JB_RESYNC_GAP <= ahead || -JB_RESYNC_GAP >= ahead ) {
+		// first frame or far end restarted: start over at this frame
+		jitterBuffer_flush(pThis);
+		pThis->nextSeq  = seq;
+		pThis->seqValid = 1;
+		pThis->playing  = 0;
+		ahead = 0;
+	}
+
+	if ( pThis->dtx && 0 == pThis->depth && 0 < (short) (seq - pThis->dtxSeq) ) {
+		// talkspurt after suppressed silence: buffer up from here
+		pThis->nextSeq = seq;
+		pThis->playing = 0;
+		pThis->dtx     = 0;
+		ahead = 0;
+	}
+
+	if ( 0 > ahead ) {
+		// its playout time has passed
+		pThis->late++;
+		bufferPool_release(pThis->pBuffP, pChunk);
+		return FAIL;
+	}
+
+	// no room that far ahead: give up the oldest frames
+	for ( ; JB_SLOTS <= ahead; ahead-- ) {
+		jitterBuffer_skip(pThis);
+	}
+
+	slot = seq & (JB_SLOTS - 1);
+	if ( NULL != pThis->slots[slot] ) {
+		// duplicate
+		pThis->discarded++;
+		bufferPool_release(pThis->pBuffP, pChunk);
+		return FAIL;
+	}
+
+	pThis->slots[slot] = pChunk;
+	pThis->depth++;
+
+	return PASS;
+}
+
+
+/** the far end went silent (SID frame received)
+ *    - missing frames from seq on are suppressed silence, not lost
+ *    - the next talkspurt starts with a freshly filled buffer
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param seq  sequence number of the SID frame
+ *
+ * @return void
+ */
+void jitterBuffer_silence(jitterBuffer_t *pThis, unsigned short seq)
+{
+	pThis->dtx    = 1;
+	pThis->dtxSeq = seq;
+}
+
+
+/** get the frame due for playout
+ *    - call once per frame the sink needs
+ *    - ownership of the returned chunk passes to the caller
+ *    - a frame missing at its playout time is counted lost (unless
+ *      the far end is silent), *ppChunk is set to NULL and the frame
+ *      time is consumed
+ *    - an empty buffer is counted as underrun, playout then waits until
+ *      the target depth is buffered again
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param ppChunk  pointer pointer to the frame, NULL for a lost frame
+ *
+ * @return Zero if a frame time was consumed.
+ * Negative value if playout is (re)buffering.
+ */
+int jitterBuffer_get(jitterBuffer_t *pThis, chunk_t **ppChunk)
+{
+	int slot;
+
+	if ( NULL == pThis || NULL == ppChunk ) {
+		return FAIL;
+	}
+	*ppChunk = NULL;
+
+	if ( !pThis->playing ) {
+		if ( pThis->depth < pThis->target ) {
+			return FAIL;
+		}
+		pThis->playing = 1;
+	}
+
+	if ( 0 == pThis->depth && pThis->dtx ) {
+		// nothing sent, nothing missed
+		pThis->nextSeq++;
+		return PASS;
+	}
+
+	if ( 0 == pThis->depth ) {
+		// ran dry: wait for a deeper buffer
+		pThis->underruns++;
+		pThis->playing = 0;
+		if ( JB_MAX_DEPTH > pThis->target ) {
+			pThis->boost++;
+		}
+		pThis->sinceUnderrun = 0;
+		jitterBuffer_updateTarget(pThis);
+		return FAIL;
+	}
+
+	if ( JB_BOOST_DECAY <= ++pThis->sinceUnderrun ) {
+		pThis->sinceUnderrun = 0;
+		if ( 0 < pThis->boost ) {
+			pThis->boost--;
+			jitterBuffer_updateTarget(pThis);
+		}
+	}
+
+	// more buffered than needed: drop one frame now and then
+	if ( JB_SHRINK_INTERVAL <= ++pThis->sinceShrink && pThis->target + 1 < pThis->depth ) {
+		pThis->sinceShrink = 0;
+		jitterBuffer_skip(pThis);
+	}
+
+	slot = pThis->nextSeq & (JB_SLOTS - 1);
+	pThis->nextSeq++;
+	if ( NULL == pThis->slots[slot] ) {
+		if ( !pThis->dtx || 0 > (short) (pThis->nextSeq - 1 - pThis->dtxSeq) ) {
+			pThis->lost++;
+		}
+		return PASS;
+	}
+
+	*ppChunk = pThis->slots[slot];
+	if ( pThis->dtx && 0 < (short) (frame_seq(*ppChunk) - pThis->dtxSeq) ) {
+		pThis->dtx = 0;
+	}
+	pThis->slots[slot] = NULL;
+	pThis->depth--;
+
+	return PASS;
+}
+
+
+/** frames currently buffered
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return number of frames
+ */
+int jitterBuffer_depth(jitterBuffer_t *pThis)
+{
+	return pThis->depth;
+}
+
+
+/** current playout delay
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return target depth in frames
+ */
+int jitterBuffer_target(jitterBuffer_t *pThis)
+{
+	return pThis->target;
+}
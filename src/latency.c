@@ -0,0 +1,248 @@
+/**
+ *@file latency.c
+ *
+ *@brief
+ *  - mouth to ear latency measurement over the UART link, see latency.h
+ *
+ * Target:   TLL6527v1-0
+ * Compiler: VDSP++     Output format: VDSP++ "*.dxe"
+ *
+ *******************************************************************************/
+#include "tll_common.h"
+#include "latency.h"
+#include "frame.h"
+#include "cycles.h"
+
+
+/** store a 32 bit value little endian
+ *
+ * Parameters:
+ * @param pDst  4 bytes
+ * @param value  value to store
+ *
+ * @return void
+ */
+static void latency_put32(unsigned char *pDst, unsigned int value)
+{
+	pDst[0] = (unsigned char) (value & 0xFF);
+	pDst[1] = (unsigned char) ((value >> 8) & 0xFF);
+	pDst[2] = (unsigned char) ((value >> 16) & 0xFF);
+	pDst[3] = (unsigned char) (value >> 24);
+}
+
+
+/** load a 32 bit value little endian
+ *
+ * Parameters:
+ * @param pSrc  4 bytes
+ *
+ * @return value
+ */
+static unsigned int latency_get32(const unsigned char *pSrc)
+{
+	return pSrc[0] | (pSrc[1] << 8) | (pSrc[2] << 16) | ((unsigned int) pSrc[3] << 24);
+}
+
+
+/** Initialize latency measurement, off
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int latency_init(latency_t *pThis)
+{
+	if ( NULL == pThis ) {
+		return FAIL;
+	}
+
+	pThis->enabled     = 0;
+	pThis->echoStamp   = 0;
+	pThis->echoRx      = 0;
+	pThis->echoValid   = 0;
+	pThis->offset      = 0;
+	pThis->offsetValid = 0;
+	pThis->bestRtt     = 0;
+	pThis->bestOffset  = 0;
+	pThis->samples     = 0;
+	latency_histInit(&pThis->rtt);
+	return PASS;
+}
+
+
+/** clear a distribution
+ *
+ * Parameters:
+ * @param pHist  distribution
+ *
+ * @return void
+ */
+void latency_histInit(latency_hist_t *pHist)
+{
+	int bin;
+
+	pHist->count = 0;
+	pHist->min   = 0;
+	pHist->max   = 0;
+	pHist->sum   = 0;
+	for ( bin = 0; LATENCY_BINS > bin; bin++ ) {
+		pHist->hist[bin] = 0;
+	}
+}
+
+
+/** add a sample to a distribution (ISR or main loop, one writer)
+ *
+ * Parameters:
+ * @param pHist  distribution
+ * @param cycles  latency [cycles]
+ *
+ * @return void
+ */
+void latency_histRecord(latency_hist_t *pHist, unsigned int cycles)
+{
+	unsigned int bin = cycles / (LATENCY_BIN_MS * CYCLES_PER_MS);
+
+	if ( LATENCY_BINS <= bin ) {
+		bin = LATENCY_BINS - 1;
+	}
+	if ( 0 == pHist->count || pHist->min > cycles ) {
+		pHist->min = cycles;
+	}
+	if ( pHist->max < cycles ) {
+		pHist->max = cycles;
+	}
+	pHist->sum += cycles;
+	pHist->count++;
+	pHist->hist[bin]++;
+}
+
+
+/** append the timing trailer to a chunk about to be sent
+ *   nothing if latency mode is off or the trailer does not fit
+ *   the echo of a received frame goes out once
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pChunk  coded chunk, stamp holds the capture time
+ *
+ * @return void
+ */
+void latency_tx(latency_t *pThis, chunk_t *pChunk)
+{
+	unsigned char *pTrailer;
+	unsigned int now;
+
+	if ( !pThis->enabled || pChunk->size < pChunk->len + LATENCY_TRAILER_SIZE ) {
+		return;
+	}
+
+	now      = cycles_read();
+	pTrailer = &pChunk->u08_buff[pChunk->len];
+	latency_put32(&pTrailer[0], pChunk->stamp);
+	latency_put32(&pTrailer[4], now);
+	if ( pThis->echoValid ) {
+		latency_put32(&pTrailer[8],  pThis->echoStamp);
+		latency_put32(&pTrailer[12], now - pThis->echoRx);
+		pThis->echoValid = 0;
+	} else {
+		latency_put32(&pTrailer[8],  0);
+		latency_put32(&pTrailer[12], LATENCY_NO_ECHO);
+	}
+
+	pChunk->len   += LATENCY_TRAILER_SIZE;
+	pChunk->flags |= FRAME_FLAG_TIMING;
+}
+
+
+/** take the timing trailer off a received chunk
+ *   updates the round trip and the clock offset; the chunk keeps
+ *   FRAME_FLAG_TIMING and the capture time in the local clock only
+ *   once the offset is known
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pChunk  received chunk
+ *
+ * @return void
+ */
+void latency_rx(latency_t *pThis, chunk_t *pChunk)
+{
+	unsigned char *pTrailer;
+	unsigned int now;
+	unsigned int sent;
+	unsigned int hold;
+	unsigned int rtt;
+
+	if ( !(pChunk->flags & FRAME_FLAG_TIMING) || LATENCY_TRAILER_SIZE > pChunk->len ) {
+		pChunk->flags &= ~FRAME_FLAG_TIMING;
+		return;
+	}
+
+	now          = cycles_read();
+	pChunk->len -= LATENCY_TRAILER_SIZE;
+	pTrailer     = &pChunk->u08_buff[pChunk->len];
+	sent         = latency_get32(&pTrailer[4]);
+	hold         = latency_get32(&pTrailer[12]);
+
+	if ( LATENCY_NO_ECHO != hold ) {
+		rtt = now - latency_get32(&pTrailer[8]) - hold;
+		// an echo older than the counter wrap comes out negative
+		if ( 0x80000000 > rtt ) {
+			latency_histRecord(&pThis->rtt, rtt);
+			if ( 0 == pThis->samples || pThis->bestRtt > rtt ) {
+				pThis->bestRtt    = rtt;
+				pThis->bestOffset = sent - now + rtt / 2;
+			}
+			if ( LATENCY_WINDOW == ++pThis->samples ) {
+				pThis->offset      = pThis->bestOffset;
+				pThis->offsetValid = 1;
+				pThis->samples     = 0;
+			}
+		}
+	}
+
+	// echoed with our next frame
+	pThis->echoStamp = sent;
+	pThis->echoRx    = now;
+	pThis->echoValid = 1;
+
+	if ( pThis->offsetValid ) {
+		pChunk->stamp = latency_get32(&pTrailer[0]) - pThis->offset;
+	} else {
+		pChunk->flags &= ~FRAME_FLAG_TIMING;
+	}
+}
+
+
+/** print a distribution: count, min / mean / max and the non-empty
+ *   bins [ms]
+ *
+ * Parameters:
+ * @param pName  name printed
+ * @param pHist  distribution
+ *
+ * @return void
+ */
+void latency_histReport(const char *pName, latency_hist_t *pHist)
+{
+	int bin;
+
+	if ( 0 == pHist->count ) {
+		printf("[LATENCY]: %s no samples\r\n", pName);
+		return;
+	}
+	printf("[LATENCY]: %s n %u min %u mean %u max %u us |", pName, pHist->count,
+	       pHist->min / (CYCLES_PER_MS / 1000),
+	       (unsigned int) (pHist->sum / pHist->count / (CYCLES_PER_MS / 1000)),
+	       pHist->max / (CYCLES_PER_MS / 1000));
+	for ( bin = 0; LATENCY_BINS > bin; bin++ ) {
+		if ( 0 != pHist->hist[bin] ) {
+			printf(" %d%s:%u", bin * LATENCY_BIN_MS,
+			       LATENCY_BINS - 1 == bin ? "+" : "", pHist->hist[bin]);
+		}
+	}
+	printf(" ms\r\n");
+}
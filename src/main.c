@@ -20,6 +20,8 @@
  *
  *******************************************************************************/
 #include <stdio.h>
+#include <stdlib.h>
+#include "tll_common.h"
 #include "ssm2602.h"
 #include <tll_config.h>
 #include <sys/exception.h>
@@ -27,6 +29,7 @@
 #include "startup.h"
 #include "tll_sport.h"
 #include "audioPlayer.h"
+#include "fpgaImage.h"
 #include "fpga_gpio_uart.h"
 
 /******************************************************************************
@@ -38,6 +41,40 @@
  */
 audioPlayer_t	audioPlayer;
 
+/**
+ * @var fpgaImage
+ * @brief  unpacks the FPGA bitstream at boot
+ */
+static fpgaImage_t	fpgaImage;
+
+/** Unpack the FPGA bitstream
+ *   streams the packed image through fpgaImage_read, one block at a
+ *   time, into the buffer the programmer takes
+ * Parameters:
+ * @param pBitstream  buffer of FPGA_GPIO_UART_SIZE bytes
+ * @param pLen  gets the bytes unpacked
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+static int fpga_unpack(unsigned char *pBitstream, int *pLen)
+{
+    int count;
+    int done = 0;
+
+    if ( PASS != fpgaImage_init(&fpgaImage, fpga_gpio_uart_lz, sizeof(fpga_gpio_uart_lz))
+         || FPGA_GPIO_UART_SIZE != fpgaImage_size(&fpgaImage) ) {
+        return FAIL;
+    }
+
+    while ( 0 < (count = fpgaImage_read(&fpgaImage, &pBitstream[done], FPGAIMAGE_BLOCK)) ) {
+        done += count;
+    }
+
+    *pLen = done;
+    return 0 == count && FPGA_GPIO_UART_SIZE == done ? PASS : FAIL;
+}
+
 
 /** 
  *
@@ -52,6 +89,8 @@ audioPlayer_t	audioPlayer;
 int main(void)
 {
     int status = -1;
+    int len = 0;
+    unsigned char *pBitstream;
     
     /* Blackfin setup function to configure processor */	
     status = blackfin_setup(); //returns 0 if successful and -1 if failed
@@ -63,7 +102,15 @@ int main(void)
     /* FPGA setup function to configure FPGA, make sure the FPGA configuration
     binary data is loaded in to SDRAM at "FPGA_DATA_START_ADDR" */
     //status = fpga_setup(); //returns 0 if successful and -1 if failed
-    status = fpga_programmer((unsigned char *)fpga_gpio_uart_bin, sizeof(fpga_gpio_uart_bin));
+    /* the bitstream is stored packed (fpga_gpio_uart.h), unpack it first;
+     * the programmer takes it whole, it is held on the heap only while
+     * the FPGA is programmed */
+    pBitstream = malloc(FPGA_GPIO_UART_SIZE);
+    status = (NULL == pBitstream) ? FAIL : fpga_unpack(pBitstream, &len);
+    if (PASS == status) {
+        status = fpga_programmer(pBitstream, len);
+    }
+    free(pBitstream);
     //status = fpga_loader(0x3); //returns 0 if successful and -1 if failed
     if (status) {
         printf("\r\n [Main]: FPGA Setup Failed");
@@ -0,0 +1,270 @@
+/**
+ *@file mixer.c
+ *
+ *@brief
+ *  - digital mixer in front of audio TX, see mixer.h
+ *
+ * Target:   TLL6527v1-0
+ * Compiler: VDSP++     Output format: VDSP++ "*.dxe"
+ *
+ *******************************************************************************/
+#include "tll_common.h"
+#include "mixer.h"
+
+/** 10^(-k/20), k = 0 .. 5 dB, Q15; every 6 dB more halves the gain */
+static const short mixer_db[6] = {
+	32767, 29204, 26028, 23197, 20675, 18426
+};
+
+
+/** both samples of a pair times a gain
+ *   fractional multiply, rounded and saturated per half
+ *
+ * Parameters:
+ * @param pair  two samples, one per half word
+ * @param gain  gain, Q15, 0 .. MIXER_UNITY
+ *
+ * @return the pair scaled
+ */
+static inline unsigned int mixer_scale(unsigned int pair, int gain)
+{
+#if defined(__ADSPBLACKFIN__) || defined(__bfin__)
+	unsigned int out;
+
+	asm("%0.H = %1.H * %2.L, %0.L = %1.L * %2.L;" : "=d" (out) : "d" (pair), "d" (gain));
+	return out;
+#else
+	int lo = ((short) pair * gain + (1 << 14)) >> 15;
+	int hi = ((short) (pair >> 16) * gain + (1 << 14)) >> 15;
+
+	return (unsigned short) lo | ((unsigned int) (unsigned short) hi << 16);
+#endif
+}
+
+
+/** saturating sum of two pairs, per half
+ *
+ * Parameters:
+ * @param a  two samples, one per half word
+ * @param b  two samples, one per half word
+ *
+ * @return the pairs added
+ */
+static inline unsigned int mixer_add(unsigned int a, unsigned int b)
+{
+#if defined(__ADSPBLACKFIN__) || defined(__bfin__)
+	unsigned int out;
+
+	asm("%0 = %1 +|+ %2 (S);" : "=d" (out) : "d" (a), "d" (b));
+	return out;
+#else
+	int lo = (short) a + (short) b;
+	int hi = (short) (a >> 16) + (short) (b >> 16);
+
+	if ( 32767 < lo ) {
+		lo = 32767;
+	} else if ( -32768 > lo ) {
+		lo = -32768;
+	}
+	if ( 32767 < hi ) {
+		hi = 32767;
+	} else if ( -32768 > hi ) {
+		hi = -32768;
+	}
+	return (unsigned short) lo | ((unsigned int) (unsigned short) hi << 16);
+#endif
+}
+
+
+/** Initialize the mixer, unity gain, sidetone off
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int mixer_init(mixer_t *pThis)
+{
+	if ( NULL == pThis ) {
+		return FAIL;
+	}
+
+	pThis->gain     = MIXER_UNITY;
+	pThis->target   = MIXER_UNITY;
+	pThis->sidetone = 0;
+	pThis->sideIn   = 0;
+	pThis->sideOut  = 0;
+	return PASS;
+}
+
+
+/** gain of an attenuation in dB
+ *   6 dB taken as a halving, 0.02 dB off per 6 dB
+ *
+ * Parameters:
+ * @param db  attenuation [dB], 0 or more
+ *
+ * @return gain, Q15
+ */
+int mixer_gainDb(int db)
+{
+	if ( 0 >= db ) {
+		return MIXER_UNITY;
+	} else if ( 96 <= db ) {
+		return 0;
+	}
+	return mixer_db[db % 6] >> (db / 6);
+}
+
+
+/** set the playback gain, ramped to from the next chunk on
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param gain  gain, Q15, 0 .. MIXER_UNITY
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int mixer_setGain(mixer_t *pThis, int gain)
+{
+	if ( NULL == pThis || 0 > gain || MIXER_UNITY < gain ) {
+		return FAIL;
+	}
+
+	pThis->target = gain;
+	return PASS;
+}
+
+
+/** set the sidetone level
+ *   off drops what was kept for it
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param level  level of the local capture, Q15, 0 (off) .. MIXER_SIDETONE_MAX
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int mixer_setSidetone(mixer_t *pThis, int level)
+{
+	if ( NULL == pThis || 0 > level || MIXER_SIDETONE_MAX < level ) {
+		return FAIL;
+	}
+
+	pThis->sidetone = level;
+	if ( 0 == level ) {
+		pThis->sideOut = pThis->sideIn;
+	}
+	return PASS;
+}
+
+
+/** keep a captured chunk for the sidetone
+ *   at most one chunk waits besides this one: the capture and the
+ *   playback run off the same codec clock, the sidetone lags by one to
+ *   two chunks
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pChunk  chunk of 16 bit PCM, not changed
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int mixer_sidetone(mixer_t *pThis, const chunk_t *pChunk)
+{
+	int pairs;
+	int count;
+
+	if ( NULL == pThis || NULL == pChunk ) {
+		return FAIL;
+	}
+	if ( 0 == pThis->sidetone ) {
+		return PASS;
+	}
+
+	pairs = pChunk->len / 4;
+	if ( MIXER_SIDE_PAIRS / 2 < pairs ) {
+		pairs = MIXER_SIDE_PAIRS / 2;
+	}
+	if ( pThis->sideIn - pThis->sideOut > (unsigned int) pairs ) {
+		pThis->sideOut = pThis->sideIn - pairs;
+	}
+	for ( count = 0; pairs > count; count++ ) {
+		pThis->side[pThis->sideIn++ & (MIXER_SIDE_PAIRS - 1)] = pChunk->u32_buff[count];
+	}
+	return PASS;
+}
+
+
+/** gain and sidetone on a chunk for audio TX, in place
+ *   per block the gain moves by up to MIXER_RAMP towards the one set,
+ *   interpolated per pair; the sidetone is mixed in as far as there is
+ *   some, an odd last sample only gets the gain
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pChunk  chunk of 16 bit PCM
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int mixer_process(mixer_t *pThis, chunk_t *pChunk)
+{
+	unsigned int *pData;
+	unsigned int value;
+	int pairs;
+	int start;
+	int count;
+	int index;
+	int target;
+	int gain;
+	int step;
+
+	if ( NULL == pThis || NULL == pChunk ) {
+		return FAIL;
+	}
+	// unity gain and nothing to mix in, leave the chunk alone
+	if ( MIXER_UNITY == pThis->gain && MIXER_UNITY == pThis->target
+	     && pThis->sideIn == pThis->sideOut ) {
+		return PASS;
+	}
+
+	pairs = pChunk->len / 4;
+	for ( start = 0; pairs > start; start += count ) {
+		pData = &pChunk->u32_buff[start];
+		count = pairs - start;
+		if ( MIXER_BLOCK / 2 < count ) {
+			count = MIXER_BLOCK / 2;
+		}
+
+		target = pThis->target;
+		if ( pThis->gain + MIXER_RAMP < target ) {
+			target = pThis->gain + MIXER_RAMP;
+		} else if ( pThis->gain - MIXER_RAMP > target ) {
+			target = pThis->gain - MIXER_RAMP;
+		}
+
+		gain = pThis->gain;
+		step = (target - gain) / count;
+		for ( index = 0; count > index; index++ ) {
+			gain += step;
+			value = mixer_scale(pData[index], gain);
+			if ( pThis->sideOut != pThis->sideIn ) {
+				value = mixer_add(value, mixer_scale(pThis->side[pThis->sideOut++ & (MIXER_SIDE_PAIRS - 1)],
+				                                     pThis->sidetone));
+			}
+			pData[index] = value;
+		}
+		pThis->gain = target;
+	}
+
+	if ( pChunk->len & 2 ) {
+		index = pChunk->len / 2 - 1;
+		pChunk->s16_buff[index] = (short) ((pChunk->s16_buff[index] * pThis->gain + (1 << 14)) >> 15);
+	}
+	return PASS;
+}
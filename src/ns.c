@@ -0,0 +1,549 @@
+/**
+ *@file ns.c
+ *
+ *@brief
+ *  - spectral subtraction noise suppression, see ns.h
+ *
+ * Target:   TLL6527v1-0
+ * Compiler: VDSP++     Output format: VDSP++ "*.dxe"
+ *
+ *******************************************************************************/
+#include "tll_common.h"
+#include "ns.h"
+
+#if NS_FFT > 128
+#error "ns_sine resolves frames of up to 128 samples"
+#endif
+
+/**
+ * @def NS_LIMIT4
+ * @brief largest input of a radix 4 stage that cannot overflow, a
+ * butterfly grows by up to 4 sqrt(2)
+ */
+#define NS_LIMIT4	(5791)
+
+/**
+ * @def NS_LIMIT2
+ * @brief largest input of the radix 2 stage that cannot overflow
+ */
+#define NS_LIMIT2	(11584)
+
+/**
+ * @def NS_INPUT_MAX
+ * @brief the windowed frame is scaled up to just under this peak
+ */
+#define NS_INPUT_MAX	(16383)
+
+/** sin (pi k / 128), k = 0 .. 64, Q15 */
+static const short ns_sine[65] = {
+	     0,    804,   1608,   2411,   3212,   4011,   4808,   5602,
+	  6393,   7180,   7962,   8740,   9512,  10279,  11039,  11793,
+	 12540,  13279,  14010,  14733,  15447,  16151,  16846,  17531,
+	 18205,  18868,  19520,  20160,  20788,  21403,  22006,  22595,
+	 23170,  23732,  24279,  24812,  25330,  25833,  26320,  26791,
+	 27246,  27684,  28106,  28511,  28899,  29269,  29622,  29957,
+	 30274,  30572,  30853,  31114,  31357,  31581,  31786,  31972,
+	 32138,  32286,  32413,  32522,  32610,  32679,  32729,  32758,
+	 32767
+};
+
+
+/** sine of a full circle in 256 steps
+ *
+ * Parameters:
+ * @param index  angle, 2 pi index / 256
+ *
+ * @return sine, Q15
+ */
+static int ns_sin(int index)
+{
+	index &= 255;
+	if ( 64 >= index ) {
+		return ns_sine[index];
+	} else if ( 128 >= index ) {
+		return ns_sine[128 - index];
+	} else if ( 192 >= index ) {
+		return -ns_sine[index - 128];
+	}
+	return -ns_sine[256 - index];
+}
+
+
+/** saturate to 16 bit
+ *
+ * Parameters:
+ * @param value  value to saturate
+ *
+ * @return value in [-32768, 32767]
+ */
+static int ns_sat(int value)
+{
+	if ( 32767 < value ) {
+		return 32767;
+	} else if ( -32768 > value ) {
+		return -32768;
+	}
+	return value;
+}
+
+
+/** Initialize the noise suppressor, no noise known yet
+ *   tables: window, twiddles and where the forward FFT leaves each
+ *   bin (mixed radix digit reversal)
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int ns_init(ns_t *pThis)
+{
+	int count;
+	int bin;
+	int rem;
+	int span;
+	int pos;
+
+	if ( NULL == pThis ) {
+		return FAIL;
+	}
+
+	for ( count = 0; NS_FFT > count; count++ ) {
+		pThis->win[count]   = (short) ns_sin(count * (128 / NS_FFT));
+		pThis->twCos[count] = (short) ns_sin(count * (256 / NS_FFT) + 64);
+		pThis->twSin[count] = (short) ns_sin(count * (256 / NS_FFT));
+		pThis->in[count]    = 0;
+		pThis->ola[count]   = 0;
+
+		// radix 2 stage first (odd NS_LOG2), then radix 4 stages
+		pos  = 0;
+		rem  = count;
+		span = NS_FFT;
+		if ( NS_LOG2 & 1 ) {
+			span /= 2;
+			pos  += (rem % 2) * span;
+			rem  /= 2;
+		}
+		while ( 1 < span ) {
+			span /= 4;
+			pos  += (rem % 4) * span;
+			rem  /= 4;
+		}
+		pThis->pos[count] = (unsigned char) pos;
+	}
+	for ( count = 0; NS_HOP > count; count++ ) {
+		pThis->out[count] = 0;
+	}
+
+	for ( bin = 0; NS_BINS > bin; bin++ ) {
+		pThis->power[bin]  = 0;
+		pThis->minCur[bin] = ~0ULL;
+		for ( count = 0; NS_SUBS > count; count++ ) {
+			pThis->minSub[count][bin] = ~0ULL;
+		}
+		pThis->gain[bin] = 32767;
+	}
+	pThis->fill   = 0;
+	pThis->frames = 0;
+	pThis->sub    = 0;
+	pThis->count  = 0;
+	return PASS;
+}
+
+
+/** shift a stage needs to stay clear of overflow
+ *
+ * Parameters:
+ * @param pData  transform, re and im interleaved
+ * @param limit  largest input the stage takes
+ *
+ * @return right shift
+ */
+static int ns_headroom(const short *pData, int limit)
+{
+	int peak = 0;
+	int value;
+	int count;
+	int shift = 0;
+
+	for ( count = 0; 2 * NS_FFT > count; count++ ) {
+		value = 0 > pData[count] ? -pData[count] : pData[count];
+		if ( value > peak ) {
+			peak = value;
+		}
+	}
+	while ( (peak >> shift) > limit ) {
+		shift++;
+	}
+	return shift;
+}
+
+
+/** rotate by a twiddle, times (cos - i sin) forward, (cos + i sin)
+ *   inverse
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pRe  real part, rotated in place
+ * @param pIm  imaginary part, rotated in place
+ * @param index  twiddle, 2 pi index / NS_FFT
+ * @param inverse  1 for the inverse transform
+ *
+ * @return void
+ */
+static void ns_rotate(ns_t *pThis, int *pRe, int *pIm, int index, int inverse)
+{
+	int c  = pThis->twCos[index];
+	int s  = inverse ? -pThis->twSin[index] : pThis->twSin[index];
+	int re = *pRe;
+
+	*pRe = (re * c + *pIm * s + (1 << 14)) >> 15;
+	*pIm = (*pIm * c - re * s + (1 << 14)) >> 15;
+}
+
+
+/** radix 2 stage over the whole frame
+ *   forward: butterfly, then the difference rotated
+ *   inverse (conjugate transpose): rotate, then butterfly
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param inverse  1 for the inverse transform
+ * @param shift  input scaling
+ *
+ * @return void
+ */
+static void ns_radix2(ns_t *pThis, int inverse, int shift)
+{
+	short *pA;
+	short *pB;
+	int ar, ai, br, bi;
+	int count;
+
+	for ( count = 0; NS_FFT / 2 > count; count++ ) {
+		pA = &pThis->fft[2 * count];
+		pB = &pThis->fft[2 * (count + NS_FFT / 2)];
+		ar = pA[0] >> shift;
+		ai = pA[1] >> shift;
+		br = pB[0] >> shift;
+		bi = pB[1] >> shift;
+
+		if ( inverse ) {
+			ns_rotate(pThis, &br, &bi, count, 1);
+			pA[0] = (short) (ar + br);
+			pA[1] = (short) (ai + bi);
+			pB[0] = (short) (ar - br);
+			pB[1] = (short) (ai - bi);
+		} else {
+			pA[0] = (short) (ar + br);
+			pA[1] = (short) (ai + bi);
+			ar -= br;
+			ai -= bi;
+			ns_rotate(pThis, &ar, &ai, count, 0);
+			pB[0] = (short) ar;
+			pB[1] = (short) ai;
+		}
+	}
+}
+
+
+/** radix 4 stage, groups of span samples
+ *   the quarter m of a group takes twiddle m j, like ns_radix2
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param span  group length
+ * @param inverse  1 for the inverse transform
+ * @param shift  input scaling
+ *
+ * @return void
+ */
+static void ns_radix4(ns_t *pThis, int span, int inverse, int shift)
+{
+	int quarter = span / 4;
+	int step = NS_FFT / span;
+	short *pX;
+	int xr[4], xi[4];
+	int t0r, t0i, t1r, t1i, t2r, t2i, t3r, t3i;
+	int base;
+	int count;
+	int m;
+
+	for ( base = 0; NS_FFT > base; base += span ) {
+		for ( count = 0; quarter > count; count++ ) {
+			pX = &pThis->fft[2 * (base + count)];
+			for ( m = 0; 4 > m; m++ ) {
+				xr[m] = pX[2 * m * quarter] >> shift;
+				xi[m] = pX[2 * m * quarter + 1] >> shift;
+				if ( inverse && 0 < m ) {
+					ns_rotate(pThis, &xr[m], &xi[m], m * count * step, 1);
+				}
+			}
+
+			t0r = xr[0] + xr[2];
+			t0i = xi[0] + xi[2];
+			t1r = xr[0] - xr[2];
+			t1i = xi[0] - xi[2];
+			t2r = xr[1] + xr[3];
+			t2i = xi[1] + xi[3];
+			t3r = xr[1] - xr[3];
+			t3i = xi[1] - xi[3];
+			// forward: t1 - i t3 and t1 + i t3, inverse the other way round
+			if ( inverse ) {
+				t3r = -t3r;
+				t3i = -t3i;
+			}
+			xr[0] = t0r + t2r;
+			xi[0] = t0i + t2i;
+			xr[1] = t1r + t3i;
+			xi[1] = t1i - t3r;
+			xr[2] = t0r - t2r;
+			xi[2] = t0i - t2i;
+			xr[3] = t1r - t3i;
+			xi[3] = t1i + t3r;
+
+			for ( m = 0; 4 > m; m++ ) {
+				if ( !inverse && 0 < m ) {
+					ns_rotate(pThis, &xr[m], &xi[m], m * count * step, 0);
+				}
+				pX[2 * m * quarter]     = (short) xr[m];
+				pX[2 * m * quarter + 1] = (short) xi[m];
+			}
+		}
+	}
+}
+
+
+/** in place FFT of pThis->fft, block floating point
+ *   forward: decimation in frequency, natural order in, bin k left at
+ *   pThis->pos[k]
+ *   inverse: the conjugate transposed stages in reverse order, takes
+ *   the spectrum where the forward left it, natural order out,
+ *   not divided by NS_FFT
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param inverse  1 for the inverse transform
+ *
+ * @return right shifts applied on the way (exponent of the result)
+ */
+static int ns_fft(ns_t *pThis, int inverse)
+{
+	int exponent = 0;
+	int shift;
+	int span;
+
+	if ( !inverse && (NS_LOG2 & 1) ) {
+		shift = ns_headroom(pThis->fft, NS_LIMIT2);
+		ns_radix2(pThis, 0, shift);
+		exponent += shift;
+	}
+
+	if ( inverse ) {
+		for ( span = 4; NS_FFT >= span * ((NS_LOG2 & 1) + 1); span *= 4 ) {
+			shift = ns_headroom(pThis->fft, NS_LIMIT4);
+			ns_radix4(pThis, span, 1, shift);
+			exponent += shift;
+		}
+	} else {
+		for ( span = NS_FFT >> (NS_LOG2 & 1); 4 <= span; span /= 4 ) {
+			shift = ns_headroom(pThis->fft, NS_LIMIT4);
+			ns_radix4(pThis, span, 0, shift);
+			exponent += shift;
+		}
+	}
+
+	if ( inverse && (NS_LOG2 & 1) ) {
+		shift = ns_headroom(pThis->fft, NS_LIMIT2);
+		ns_radix2(pThis, 1, shift);
+		exponent += shift;
+	}
+	return exponent;
+}
+
+
+/** gain of one bin from its power this frame
+ *   tracks the smoothed power and its minimum, noise = minimum times
+ *   1.5 (the minimum of a noisy power lies below its mean)
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param bin  bin index
+ * @param power  |X|^2 of the bin, unscaled transform
+ *
+ * @return gain, Q15
+ */
+static int ns_gain(ns_t *pThis, int bin, unsigned long long power)
+{
+	unsigned long long noise;
+	unsigned int gain = NS_GAIN_MIN;
+	int shift = 0;
+	int count;
+
+	if ( 0 == pThis->count ) {
+		pThis->power[bin] = power;
+	} else {
+		pThis->power[bin] += (power >> 2) - (pThis->power[bin] >> 2);
+	}
+	if ( pThis->power[bin] < pThis->minCur[bin] ) {
+		pThis->minCur[bin] = pThis->power[bin];
+	}
+
+	noise = pThis->minCur[bin];
+	for ( count = 0; NS_SUBS > count; count++ ) {
+		if ( pThis->minSub[count][bin] < noise ) {
+			noise = pThis->minSub[count][bin];
+		}
+	}
+	noise = NS_OVER * (noise + (noise >> 1));
+
+	// 1 - noise / power, in 32 bit once both are scaled to 16 bit
+	if ( noise < power ) {
+		while ( 0xFFFF < (power >> shift) ) {
+			shift++;
+		}
+		gain = 32768 - (((unsigned int) (noise >> shift) << 15) / (unsigned int) (power >> shift));
+		if ( 32767 < gain ) {
+			gain = 32767;
+		} else if ( NS_GAIN_MIN > gain ) {
+			gain = NS_GAIN_MIN;
+		}
+	}
+
+	pThis->gain[bin] = (short) ((pThis->gain[bin] + gain) >> 1);
+	return pThis->gain[bin];
+}
+
+
+/** one frame: analysis, gains, synthesis, overlap-add
+ *   the first hop of the overlap-add is complete afterwards and moves
+ *   to pThis->out
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return void
+ */
+static void ns_frame(ns_t *pThis)
+{
+	unsigned long long power;
+	int peak = 0;
+	int scale = 0;
+	int exponent;
+	int value;
+	int gain;
+	int count;
+	int pos;
+	short *pBin;
+
+	// analysis window, scaled up to the full 16 bit
+	for ( count = 0; NS_FFT > count; count++ ) {
+		value = (pThis->in[count] * pThis->win[count] + (1 << 14)) >> 15;
+		pThis->fft[2 * count]     = (short) value;
+		pThis->fft[2 * count + 1] = 0;
+		if ( 0 > value ) {
+			value = -value;
+		}
+		if ( value > peak ) {
+			peak = value;
+		}
+	}
+	while ( 0 != peak && 15 > scale && NS_INPUT_MAX >= (peak << (scale + 1)) ) {
+		scale++;
+	}
+	for ( count = 0; scale && NS_FFT > count; count++ ) {
+		pThis->fft[2 * count] = (short) (pThis->fft[2 * count] << scale);
+	}
+
+	exponent = ns_fft(pThis, 0);
+
+	/* |X|^2 of the unscaled transform: the spectrum is X 2^(exponent -
+	 * scale) */
+	for ( count = 0; NS_BINS > count; count++ ) {
+		pBin  = &pThis->fft[2 * pThis->pos[count]];
+		power = (unsigned int) (pBin[0] * pBin[0]) + (unsigned int) (pBin[1] * pBin[1]);
+		if ( exponent >= scale ) {
+			power <<= 2 * (exponent - scale);
+		} else {
+			power >>= 2 * (scale - exponent);
+		}
+		gain = ns_gain(pThis, count, power);
+
+		pBin[0] = (short) ((pBin[0] * gain + (1 << 14)) >> 15);
+		pBin[1] = (short) ((pBin[1] * gain + (1 << 14)) >> 15);
+		if ( 0 < count && NS_FFT / 2 > count ) {
+			pBin    = &pThis->fft[2 * pThis->pos[NS_FFT - count]];
+			pBin[0] = (short) ((pBin[0] * gain + (1 << 14)) >> 15);
+			pBin[1] = (short) ((pBin[1] * gain + (1 << 14)) >> 15);
+		}
+	}
+
+	// update the minimum search
+	if ( NS_SUB_FRAMES == ++pThis->frames ) {
+		for ( count = 0; NS_BINS > count; count++ ) {
+			pThis->minSub[pThis->sub][count] = pThis->minCur[count];
+			pThis->minCur[count] = pThis->power[count];
+		}
+		pThis->sub    = (pThis->sub + 1) % NS_SUBS;
+		pThis->frames = 0;
+	}
+	pThis->count++;
+
+	/* back to the time domain: the inverse is not divided by NS_FFT,
+	 * the frame is the result 2^(exponent - scale - NS_LOG2) */
+	exponent += ns_fft(pThis, 1) - scale - NS_LOG2;
+	for ( count = 0; NS_FFT > count; count++ ) {
+		value = pThis->fft[2 * count];
+		if ( 0 <= exponent ) {
+			value <<= exponent;
+		} else {
+			value = (value + (1 << (-exponent - 1))) >> -exponent;
+		}
+		value = (ns_sat(value) * pThis->win[count] + (1 << 14)) >> 15;
+		pThis->ola[count] = (short) ns_sat(pThis->ola[count] + value);
+	}
+
+	// first hop complete, slide both frames by a hop
+	for ( pos = 0; NS_HOP > pos; pos++ ) {
+		pThis->out[pos]          = pThis->ola[pos];
+		pThis->ola[pos]          = pThis->ola[pos + NS_HOP];
+		pThis->ola[pos + NS_HOP] = 0;
+		pThis->in[pos]           = pThis->in[pos + NS_HOP];
+	}
+}
+
+
+/** suppress the noise in a captured chunk, in place
+ *   every sample goes into the frame, the sample NS_FFT before it
+ *   comes out; a frame is processed per NS_HOP samples
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pChunk  chunk of 16 bit PCM
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int ns_process(ns_t *pThis, chunk_t *pChunk)
+{
+	short *pData;
+	int samples;
+	int count;
+
+	if ( NULL == pThis || NULL == pChunk ) {
+		return FAIL;
+	}
+
+	pData   = pChunk->s16_buff;
+	samples = pChunk->len / 2;
+	for ( count = 0; samples > count; count++ ) {
+		pThis->in[NS_HOP + pThis->fill] = pData[count];
+		pData[count] = pThis->out[pThis->fill];
+		if ( NS_HOP == ++pThis->fill ) {
+			ns_frame(pThis);
+			pThis->fill = 0;
+		}
+	}
+	return PASS;
+}
@@ -0,0 +1,307 @@
+/**
+ *@file plc.c
+ *
+ *@brief
+ *  - packet loss concealment for the audio TX path
+ *
+ *  The last PLC_HIST_LEN samples handed to audio TX are kept. Their
+ *  pitch is the lag with the highest normalized autocorrelation of the
+ *  last PLC_CORR_LEN samples. A lost frame is replaced by repeating the
+ *  last pitch period, attenuated linearly to zero over PLC_MAX_FRAMES
+ *  frames; silence follows. Real data resuming after a loss is
+ *  cross-faded from the concealment over PLC_FADE_LEN samples.
+ *
+ * Target:   TLL6527v1-0
+ * Compiler: VDSP++     Output format: VDSP++ "*.dxe"
+ *
+ *******************************************************************************/
+#include "tll_common.h"
+#include "plc.h"
+#include "critical.h"
+
+
+/** append the samples of a chunk to the history
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pIn  samples
+ * @param samples  number of samples
+ *
+ * @return void
+ */
+static void plc_history(plc_t *pThis, const short *pIn, int samples)
+{
+	int count;
+	int keep = PLC_HIST_LEN - samples;
+
+	if ( 0 > keep ) {
+		pIn    += -keep;
+		samples = PLC_HIST_LEN;
+		keep    = 0;
+	}
+
+	// shift the part still needed to the front
+	for ( count = 0; keep > count; count++ ) {
+		pThis->history[count] = pThis->history[count + samples];
+	}
+	for ( count = 0; samples > count; count++ ) {
+		pThis->history[keep + count] = pIn[count];
+	}
+}
+
+
+/** estimate the pitch period of the history
+ *    maximizes corr(lag)^2 / energy(lag) over positive correlations,
+ *    then prefers the shortest sub-multiple of that lag scoring within
+ *    7/8 of it (periods of non integer length peak at multiples);
+ *    samples are scaled down by 4 bit so the sums fit 32 bit
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return pitch period [samples]
+ */
+static int plc_pitch(plc_t *pThis)
+{
+	const short *pRef = &pThis->history[PLC_HIST_LEN - PLC_CORR_LEN];
+	const short *pLag;
+	int lag;
+	int count;
+	int corr;
+	int energy = 0;
+	int best = PLC_PITCH_MAX;
+	int div;
+	long long score[PLC_PITCH_MAX + 2];
+
+	// energy of the window at the shortest lag, then slide it back
+	pLag = pRef - PLC_PITCH_MIN;
+	for ( count = 0; PLC_CORR_LEN > count; count++ ) {
+		energy += (pLag[count] >> 4) * (pLag[count] >> 4);
+	}
+
+	score[PLC_PITCH_MAX]     = 0;	// compared against before it is reached
+	score[PLC_PITCH_MAX + 1] = 0;
+	for ( lag = PLC_PITCH_MIN; PLC_PITCH_MAX >= lag; lag++ ) {
+		pLag = pRef - lag;
+		if ( PLC_PITCH_MIN < lag ) {
+			energy += (pLag[0] >> 4) * (pLag[0] >> 4);
+			energy -= (pLag[PLC_CORR_LEN] >> 4) * (pLag[PLC_CORR_LEN] >> 4);
+		}
+
+		corr = 0;
+		for ( count = 0; PLC_CORR_LEN > count; count++ ) {
+			corr += (pRef[count] >> 4) * (pLag[count] >> 4);
+		}
+
+		score[lag] = 0;
+		if ( 0 < corr ) {
+			score[lag] = ((long long) corr * corr) / (energy + 1);
+			if ( score[lag] > score[best] ) {
+				best = lag;
+			}
+		}
+	}
+
+	for ( div = best / PLC_PITCH_MIN; 1 < div; div-- ) {
+		lag = (best + div / 2) / div;
+		if ( score[lag + 1] > score[lag] ) {
+			lag++;
+		} else if ( PLC_PITCH_MIN < lag && score[lag - 1] > score[lag] ) {
+			lag--;
+		}
+		if ( 8 * score[lag] >= 7 * score[best] ) {
+			return lag;
+		}
+	}
+
+	return best;
+}
+
+
+/** synthesize the concealment frames into a bank
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param bank  bank to fill
+ * @param samples  samples per frame
+ * @param pitch  pitch period of the history [samples]
+ *
+ * @return void
+ */
+static void plc_synthesize(plc_t *pThis, int bank, int samples, int pitch)
+{
+	const short *pPeriod = &pThis->history[PLC_HIST_LEN - pitch];
+	short *pOut;
+	int frame;
+	int count;
+	int phase = 0;
+	int gain  = 32767 << 15;	// Q30
+	int step  = gain / (PLC_MAX_FRAMES * samples);
+
+	for ( frame = 0; PLC_MAX_FRAMES > frame; frame++ ) {
+		pOut = pThis->conceal[bank][frame].s16_buff;
+		for ( count = 0; samples > count; count++ ) {
+			pOut[count] = (short) ((pPeriod[phase] * (gain >> 15)) >> 15);
+			gain -= step;
+			if ( pitch == ++phase ) {
+				phase = 0;
+			}
+		}
+		pThis->conceal[bank][frame].len = samples * 2;
+	}
+}
+
+
+/** Initialize concealment
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int plc_init(plc_t *pThis)
+{
+	int count;
+
+	if ( NULL == pThis ) {
+		printf("[PLC]: Failed init\r\n");
+		return FAIL;
+	}
+
+	for ( count = 0; PLC_HIST_LEN > count; count++ ) {
+		pThis->history[count] = 0;
+	}
+	for ( count = 0; 2 * PLC_MAX_FRAMES > count; count++ ) {
+		chunk_init(&pThis->conceal[count / PLC_MAX_FRAMES][count % PLC_MAX_FRAMES],
+		           pThis->mem[count], SAMPLE_SIZE);
+	}
+	chunk_init(&pThis->silence, pThis->mem[2 * PLC_MAX_FRAMES], SAMPLE_SIZE);
+	for ( count = 0; SAMPLE_SIZE/4 > count; count++ ) {
+		pThis->silence.u32_buff[count] = 0;
+	}
+	pThis->silence.len = SAMPLE_SIZE;
+
+	pThis->pitch     = 0;
+	pThis->bank      = 0;
+	pThis->latched   = 0;
+	pThis->lost      = 0;
+	pThis->concealed = 0;
+	pThis->silenced  = 0;
+
+	printf("[PLC]: Init complete\r\n");
+	return PASS;
+}
+
+
+/** a chunk of 16 bit PCM is about to be played (main loop)
+ *    - cross-fades the chunk start from the concealment if it ends
+ *      a running loss run
+ *    - updates history and pitch, prepares the concealment frames
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pChunk  chunk handed to audio TX
+ * @param next  chunk is played right after the concealment frames
+ * @param lost  plc.lost, read when the chunk was linked
+ * @param latched  plc.latched, read when the chunk was linked
+ *
+ * @return void
+ */
+void plc_update(plc_t *pThis, chunk_t *pChunk, int next, int lost, int latched)
+{
+	unsigned int mask;
+	int count;
+	int samples = pChunk->len / 2;
+	int fade = PLC_FADE_LEN;
+	int target;
+	int pitch;
+	short *pIn = pChunk->s16_buff;
+	const short *pSyn = NULL;
+
+	if ( next && 0 != lost ) {
+		// continue where the concealment would have been next
+		if ( PLC_MAX_FRAMES > lost && 0 != pThis->pitch ) {
+			pSyn = pThis->conceal[latched][lost].s16_buff;
+		}
+		if ( fade > samples ) {
+			fade = samples;
+		}
+		for ( count = 0; fade > count; count++ ) {
+			pIn[count] = (short) ((pIn[count] * count
+			             + (pSyn ? pSyn[count] : 0) * (PLC_FADE_LEN - count)) / PLC_FADE_LEN);
+		}
+	}
+
+	plc_history(pThis, pIn, samples);
+	pitch = plc_pitch(pThis);
+	pThis->silence.len = samples * 2;
+
+	/* never overwrite the bank a running loss run plays from; a loss
+	 * run starting from here on latches pThis->bank, not the target */
+	target = pThis->bank ^ 1;
+	if ( 0 != lost && latched == target ) {
+		pThis->pitch = pitch;
+		return;
+	}
+	plc_synthesize(pThis, target, samples, pitch);
+
+	// the ISR sees the pitch and the bank prepared with it together
+	mask = critical_enter();
+	pThis->pitch = pitch;
+	pThis->bank  = target;
+	critical_exit(mask);
+}
+
+
+/** replacement for a missing chunk (ISR)
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return chunk to play, owned by plc
+ */
+chunk_t *plc_conceal(plc_t *pThis)
+{
+	int lost = pThis->lost;
+
+	if ( 0 == lost ) {
+		pThis->latched = pThis->bank;
+	}
+	pThis->lost = lost + 1;
+
+	if ( PLC_MAX_FRAMES > lost && 0 != pThis->pitch ) {
+		pThis->concealed++;
+		return &pThis->conceal[pThis->latched][lost];
+	}
+
+	pThis->silenced++;
+	return &pThis->silence;
+}
+
+
+/** real data is played again, ends a loss run (ISR)
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return void
+ */
+void plc_resume(plc_t *pThis)
+{
+	pThis->lost = 0;
+}
+
+
+/** chunk belongs to plc (not to the buffer pool)
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pChunk  chunk to test
+ *
+ * @return non-zero if owned by plc
+ */
+int plc_owns(plc_t *pThis, chunk_t *pChunk)
+{
+	return (&pThis->conceal[0][0] <= pChunk && &pThis->silence >= pChunk);
+}
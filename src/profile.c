@@ -0,0 +1,101 @@
+/**
+ *@file profile.c
+ *
+ *@brief
+ *  - cycle counter profiling of the hot paths, see profile.h
+ *
+ * Target:   TLL6527v1-0
+ * Compiler: VDSP++     Output format: VDSP++ "*.dxe"
+ *
+ *******************************************************************************/
+#include "tll_common.h"
+#include "profile.h"
+
+#ifdef PROFILE_ENABLE
+
+/** the stages, zero initialized: min is taken from the first sample */
+profile_t profile;
+
+/** stage names for the report */
+static const char *profile_name[PROFILE_NUM] = {
+	"audioRx isr",
+	"audioTx isr",
+	"uartRx isr",
+	"uartTx isr",
+	"chunk copy",
+	"aec",
+	"ns",
+	"agc",
+	"mix",
+	"encode",
+	"decode",
+	"capture",
+	"receive",
+	"playout",
+};
+
+
+/** record a sample
+ *
+ * Parameters:
+ * @param pStage  stage to record in
+ * @param cycles  cycles of the sample
+ *
+ * @return void
+ */
+void profile_record(profile_stage_t *pStage, unsigned int cycles)
+{
+	int bin = 0;
+
+	if ( 0 == pStage->count || pStage->min > cycles ) {
+		pStage->min = cycles;
+	}
+	if ( pStage->max < cycles ) {
+		pStage->max = cycles;
+	}
+	pStage->sum += cycles;
+	pStage->count++;
+
+	// bit length of the cycles
+	if ( 0 != cycles ) {
+		bin = 32 - __builtin_clz(cycles);
+	}
+	pStage->hist[bin]++;
+}
+
+
+/** print count, min / mean / max and the non-empty histogram bins of
+ *   every stage seen since the last report, then clear all stages
+ *
+ * @return void
+ */
+void profile_report(void)
+{
+	profile_stage_t *pStage;
+	int id;
+	int bin;
+
+	for ( id = 0; PROFILE_NUM > id; id++ ) {
+		pStage = &profile.stage[id];
+		if ( 0 == pStage->count ) {
+			continue;
+		}
+		printf("[PROFILE]: %-12s n %u min %u mean %u max %u cycles |",
+		       profile_name[id], pStage->count, pStage->min,
+		       (unsigned int) (pStage->sum / pStage->count), pStage->max);
+		for ( bin = 0; PROFILE_BINS > bin; bin++ ) {
+			if ( 0 != pStage->hist[bin] ) {
+				// bin n: below 2^n cycles
+				printf(" <2^%d:%u", bin, pStage->hist[bin]);
+			}
+			pStage->hist[bin] = 0;
+		}
+		printf("\r\n");
+
+		pStage->count = 0;
+		pStage->max   = 0;
+		pStage->sum   = 0;
+	}
+}
+
+#endif
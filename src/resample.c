@@ -0,0 +1,207 @@
+/**
+ *@file resample.c
+ *
+ *@brief
+ *  - polyphase FIR decimation / interpolation by 2 or 4, see resample.h
+ *
+ * Target:   TLL6527v1-0
+ * Compiler: VDSP++     Output format: VDSP++ "*.dxe"
+ *
+ *******************************************************************************/
+#include "tll_common.h"
+#include "resample.h"
+
+/** low pass for ratio 2: 48 taps, pass band to 1.7 kHz, stop band
+ *  from 2 kHz (at 8 kHz), symmetric, DC gain 1.0 in Q15 */
+static const short resample_coef2[48] = {
+	    -2,    -17,     -8,     36,     42,    -44,   -108,     10,
+	   190,     99,   -244,   -301,    196,    571,     40,   -830,
+	  -548,    932,   1406,   -631,  -2810,   -726,   6279,  12852,
+	 12852,   6279,   -726,  -2810,   -631,   1406,    932,   -548,
+	  -830,     40,    571,    196,   -301,   -244,     99,    190,
+	    10,   -108,    -44,     42,     36,     -8,    -17,     -2
+};
+
+/** low pass for ratio 4: 64 taps, pass band to 770 Hz, stop band
+ *  from 1 kHz (at 8 kHz), symmetric, DC gain 1.0 in Q15 */
+static const short resample_coef4[64] = {
+	     1,     -4,    -14,    -23,    -25,    -13,     15,     52,
+	    83,     89,     53,    -25,   -126,   -211,   -232,   -157,
+	    18,    248,    450,    526,    397,     50,   -443,   -924,
+	 -1182,  -1021,   -322,    897,   2468,   4100,   5449,   6210,
+	  6210,   5449,   4100,   2468,    897,   -322,  -1021,  -1182,
+	  -924,   -443,     50,    397,    526,    450,    248,     18,
+	  -157,   -232,   -211,   -126,    -25,     53,     89,     83,
+	    52,     15,    -13,    -25,    -23,    -14,     -4,      1
+};
+
+
+/** dot product of taps coefficients and samples, Q15 result saturated
+ *   two accumulators over tap pairs (dual MAC), taps even
+ *
+ * Parameters:
+ * @param pCoef  coefficients
+ * @param pX  samples, oldest first
+ * @param taps  number of taps
+ *
+ * @return filtered sample
+ */
+static short resample_dot(const short *pCoef, const short *pX, int taps)
+{
+	int acc0 = 0;
+	int acc1 = 0;
+	int count;
+
+	for ( count = 0; taps > count; count += 2 ) {
+		acc0 += pCoef[count]     * pX[count];
+		acc1 += pCoef[count + 1] * pX[count + 1];
+	}
+	acc0 = (acc0 + acc1 + (1 << 14)) >> 15;
+
+	if ( 32767 < acc0 ) {
+		acc0 = 32767;
+	} else if ( -32768 > acc0 ) {
+		acc0 = -32768;
+	}
+	return (short) acc0;
+}
+
+
+/** Initialize a resampler, filter state cleared
+ *   the interpolator phases are taken from the low pass: phase p holds
+ *   taps p, p + ratio, p + 2 ratio ... oldest sample first, scaled by
+ *   the ratio for unity gain
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param ratio  1 (pass through), 2 or 4
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int resample_init(resample_t *pThis, int ratio)
+{
+	int taps;
+	int phase;
+	int count;
+
+	if ( NULL == pThis ) {
+		return FAIL;
+	}
+
+	switch ( ratio ) {
+	case 1:
+		pThis->pCoef = NULL;
+		taps = 0;
+		break;
+	case 2:
+		pThis->pCoef = resample_coef2;
+		taps = sizeof(resample_coef2) / sizeof(resample_coef2[0]);
+		break;
+	case 4:
+		pThis->pCoef = resample_coef4;
+		taps = sizeof(resample_coef4) / sizeof(resample_coef4[0]);
+		break;
+	default:
+		return FAIL;
+	}
+
+	pThis->ratio = ratio;
+	pThis->taps  = taps;
+	for ( phase = 0; ratio > phase && 1 < ratio; phase++ ) {
+		for ( count = 0; taps / ratio > count; count++ ) {
+			pThis->phase[phase * (taps / ratio) + count] =
+				(short) (pThis->pCoef[phase + (taps / ratio - 1 - count) * ratio] * ratio);
+		}
+	}
+	for ( count = 0; RESAMPLE_TAPS_MAX > count; count++ ) {
+		pThis->work[count] = 0;
+	}
+	return PASS;
+}
+
+
+/** low pass and keep every ratio-th sample, in place
+ *   the chunk goes behind taps-1 samples of history in the work
+ *   buffer, output n is the filter over work[n*ratio ...]
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pChunk  chunk of 16 bit PCM, samples a multiple of the ratio
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int resample_decimate(resample_t *pThis, chunk_t *pChunk)
+{
+	int samples = pChunk->len / 2;
+	int hist = pThis->taps - 1;
+	int count;
+
+	if ( 1 == pThis->ratio ) {
+		return PASS;
+	}
+	if ( RESAMPLE_SAMPLES_MAX < samples || 0 != samples % pThis->ratio ) {
+		return FAIL;
+	}
+
+	for ( count = 0; samples > count; count++ ) {
+		pThis->work[hist + count] = pChunk->s16_buff[count];
+	}
+	for ( count = 0; samples / pThis->ratio > count; count++ ) {
+		pChunk->s16_buff[count] = resample_dot(pThis->pCoef,
+		                                       &pThis->work[count * pThis->ratio],
+		                                       pThis->taps);
+	}
+	// keep the newest samples as history
+	for ( count = 0; hist > count; count++ ) {
+		pThis->work[count] = pThis->work[samples + count];
+	}
+
+	pChunk->len = samples / pThis->ratio * 2;
+	return PASS;
+}
+
+
+/** insert ratio-1 samples after every sample and low pass, in place
+ *   the chunk goes behind taps/ratio-1 samples of history in the
+ *   work buffer, output n*ratio+p is phase p over work[n ...]
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pChunk  chunk of 16 bit PCM, size for ratio times the samples
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int resample_interpolate(resample_t *pThis, chunk_t *pChunk)
+{
+	int samples = pChunk->len / 2;
+	int taps = pThis->taps / pThis->ratio;
+	int hist = taps - 1;
+	int count;
+	int phase;
+
+	if ( 1 == pThis->ratio ) {
+		return PASS;
+	}
+	if ( RESAMPLE_SAMPLES_MAX < samples || pChunk->size < pChunk->len * pThis->ratio ) {
+		return FAIL;
+	}
+
+	for ( count = 0; samples > count; count++ ) {
+		pThis->work[hist + count] = pChunk->s16_buff[count];
+	}
+	for ( count = 0; samples > count; count++ ) {
+		for ( phase = 0; pThis->ratio > phase; phase++ ) {
+			pChunk->s16_buff[count * pThis->ratio + phase] =
+				resample_dot(&pThis->phase[phase * taps], &pThis->work[count], taps);
+		}
+	}
+	for ( count = 0; hist > count; count++ ) {
+		pThis->work[count] = pThis->work[samples + count];
+	}
+
+	pChunk->len *= pThis->ratio;
+	return PASS;
+}
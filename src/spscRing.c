@@ -0,0 +1,81 @@
+/**
+ *@file spscRing.c
+ *
+ *@brief
+ *  - single producer / single consumer ring of pointers, no locking
+ *
+ * Target:   TLL6527v1-0
+ * Compiler: VDSP++     Output format: VDSP++ "*.dxe"
+ *
+ *******************************************************************************/
+#include "tll_common.h"
+#include "spscRing.h"
+
+
+/** Initialize the ring empty
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param size  slots, a power of two up to SPSCRING_SIZE_MAX
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int spscRing_init(spscRing_t *pThis, unsigned int size)
+{
+	if ( NULL == pThis || 0 == size || SPSCRING_SIZE_MAX < size
+	     || 0 != (size & (size - 1)) ) {
+		return FAIL;
+	}
+
+	pThis->head = 0;
+	pThis->tail = 0;
+	pThis->size = size;
+	return PASS;
+}
+
+
+/** put an item (producer side)
+ *   the slot is filled before head publishes it
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pItem  item to put
+ *
+ * @return Zero on success.
+ * Negative value on failure (ring full).
+ */
+int spscRing_put(spscRing_t *pThis, void *pItem)
+{
+	unsigned int head = pThis->head;
+
+	if ( head - pThis->tail >= pThis->size ) {
+		return FAIL;
+	}
+	pThis->slot[head & (pThis->size - 1)] = pItem;
+	pThis->head = head + 1;
+	return PASS;
+}
+
+
+/** get the oldest item (consumer side)
+ *   the slot is read before tail hands it back to the producer
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param ppItem  pointer to the item taken
+ *
+ * @return Zero on success.
+ * Negative value on failure (ring empty).
+ */
+int spscRing_get(spscRing_t *pThis, void **ppItem)
+{
+	unsigned int tail = pThis->tail;
+
+	if ( pThis->head == tail ) {
+		return FAIL;
+	}
+	*ppItem = pThis->slot[tail & (pThis->size - 1)];
+	pThis->tail = tail + 1;
+	return PASS;
+}
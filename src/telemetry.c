@@ -0,0 +1,76 @@
+/**
+ *@file telemetry.c
+ *
+ *@brief
+ *  - per path counters, snapshot and reset against a baseline
+ *
+ * Target:   TLL6527v1-0
+ * Compiler: VDSP++     Output format: VDSP++ "*.dxe"
+ *
+ *******************************************************************************/
+#include "tll_common.h"
+#include "telemetry.h"
+
+
+/** initialize counters
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return void
+ */
+void telemetry_init(telemetry_t *pThis)
+{
+	int count;
+
+	pThis->in        = 0;
+	pThis->out       = 0;
+	pThis->poolEmpty = 0;
+	pThis->underruns = 0;
+	pThis->queueHigh = 0;
+	for ( count = 0; TELEMETRY_DROP_NUM > count; count++ ) {
+		pThis->drops[count] = 0;
+	}
+}
+
+
+/** counters since the last reset
+ *
+ * Parameters:
+ * @param pThis  live counters
+ * @param pBase  baseline taken at the last reset
+ * @param pSnap  result
+ *
+ * @return void
+ */
+void telemetry_snapshot(const telemetry_t *pThis, const telemetry_t *pBase, telemetry_t *pSnap)
+{
+	int count;
+
+	pSnap->in        = pThis->in        - pBase->in;
+	pSnap->out       = pThis->out       - pBase->out;
+	pSnap->poolEmpty = pThis->poolEmpty - pBase->poolEmpty;
+	pSnap->underruns = pThis->underruns - pBase->underruns;
+	pSnap->queueHigh = pThis->queueHigh;
+	for ( count = 0; TELEMETRY_DROP_NUM > count; count++ ) {
+		pSnap->drops[count] = pThis->drops[count] - pBase->drops[count];
+	}
+}
+
+
+/** start a new measurement interval
+ *    - baseline = live counters
+ *    - the high-water mark restarts at the current queue level, it is
+ *      the only live field written; a concurrent update may be lost
+ *
+ * Parameters:
+ * @param pThis  live counters
+ * @param pBase  baseline to update
+ *
+ * @return void
+ */
+void telemetry_reset(telemetry_t *pThis, telemetry_t *pBase)
+{
+	*pBase = *pThis;
+	pThis->queueHigh = pThis->in - pThis->out;
+}
@@ -3,6 +3,12 @@
  *
  *@brief
  *  - receive data over UART
+ *  - frames are delimited by sync word and length, see frame.h
+ *  - DMA10 writes a ring buffer circularly, the main loop parses frames
+ *    out of it as soon as their last byte arrived
+ *  - DMA10 interrupts once per ring row only; a core timer tick wakes
+ *    the main loop for the bytes in between, a frame is parsed at most
+ *    UARTRX_TICK_CYCLES after its last byte
  *
  * Target:   TLL6527v1-0
  * Compiler: VDSP++     Output format: VDSP++ "*.dxe"
@@ -14,69 +20,190 @@
 #include "uartRx.h"
 #include "bufferPool.h"
 #include "isrDisp.h"
+#include "profile.h"
+#include "frame.h"
+#include "compression.h"
+#include "cycles.h"
 #include <tll_config.h>
 #include <tll_sport.h>
-#include <queue.h>
 #include <power_mode.h>
+#include <sys/exception.h>
+
+/**
+ * @def UARTRX_SLOT
+ * @brief ring index of a stream position
+ */
+#define UARTRX_SLOT(pos)	((pos) & (UARTRX_RING_SIZE - 1))
+
+/**
+ * @def UARTRX_ROWS
+ * @brief rows of the 2D ring
+ */
+#define UARTRX_ROWS		(UARTRX_RING_SIZE / UARTRX_ROW_SIZE)
+
+/**
+ * @var uartRx_pTick
+ * @brief object of the core timer tick, its handler takes no argument
+ */
+static uartRx_t *uartRx_pTick = NULL;
+
 
 /** Configure the UART DMA
- * Configures the DMA rx with the buffer and the buffer length to
- * receive
+ * Configures DMA10 to write the ring buffer circularly (autobuffer),
+ * 2D with one interrupt per ring row
  * Parameters:
- * @param pchunk  pointer to receive chunk
+ * @param pThis  pointer to own object
  *
  * @return void
  */
-void uartRx_dmaConfig(chunk_t *pChunk)
+void uartRx_dmaConfig(uartRx_t *pThis)
 {
 	/* 1. Disable DMA 10 */
 	DISABLE_DMA(*pDMA10_CONFIG);
 
 	/* 2. Configure start address */
-	*pDMA10_START_ADDR = &pChunk->u08_buff[0];	// should this match audioRx?
+	*pDMA10_START_ADDR = &pThis->ring[0];
+
+	/* 3. set X and Y count, a row per interrupt */
+	*pDMA10_X_COUNT = UARTRX_ROW_SIZE;
+	*pDMA10_Y_COUNT = UARTRX_ROWS;
+
+	/* 4. set X and Y modify, rows are back to back */
+	*pDMA10_X_MODIFY = 1;
+	*pDMA10_Y_MODIFY = 1;
+
+	/* 5. Re-enable DMA, restarts at the ring start after the last row */
+	*pDMA10_CONFIG = FLOW_AUTO | DMA2D | DI_SEL | DI_EN | WDSIZE_8 | WNR | DMAEN;
+}
+
+
+/** stream position the DMA has written up to
+ *   the row count of the ISR tells the ring laps, the DMA address the
+ *   position inside the ring; a row interrupt still pending is
+ *   accounted for by the address
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return number of bytes received since start (wraps)
+ */
+static unsigned int uartRx_written(uartRx_t *pThis)
+{
+	unsigned int rows;
+	unsigned int offset;
+
+	do {
+		rows   = pThis->rows;
+		offset = UARTRX_SLOT((unsigned char *) *pDMA10_CURR_ADDR - &pThis->ring[0]);
+	} while ( rows != pThis->rows );
+
+	rows += (offset / UARTRX_ROW_SIZE - rows) & (UARTRX_ROWS - 1);
+
+	return rows * UARTRX_ROW_SIZE + offset % UARTRX_ROW_SIZE;
+}
+
+
+/** copy bytes out of the ring
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pDst  destination
+ * @param pos  stream position of the first byte
+ * @param len  number of bytes
+ *
+ * @return void
+ */
+static void uartRx_copy(uartRx_t *pThis, unsigned char *pDst, unsigned int pos, int len)
+{
+	int count;
+
+	// copy manually since memcpy does not work currently
+	for ( count = 0; len > count; count++ ) {
+		pDst[count] = pThis->ring[UARTRX_SLOT(pos + count)];
+	}
+}
+
+
+/** resynchronize on the next sync word
+ *   the frame in parsing is given up, the bytes behind its sync word
+ *   are still in the ring and are scanned again
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return void
+ */
+static void uartRx_resync(uartRx_t *pThis)
+{
+	pThis->rdPos = pThis->frameStart + 1;
+	pThis->bytesSkipped++;
+	pThis->state = UARTRX_HUNT;
+}
 
-	/* 3. set X count */
-	*pDMA10_X_COUNT = pChunk->size;//*pDMA10_X_COUNT = 2;
-	//*pDMA10_Y_COUNT = pChunk->size/2; // 16 bit data so we change the stride and count
 
-	/* 4. set X modify */
-	*pDMA10_X_MODIFY = 1; //*pDMA10_X_MODIFY = 0;
-	//*pDMA10_Y_MODIFY = 2;
+/** uartRx_tickIsr
+ *   - core timer tick, clears TINT
+ *   - post EVENT_UART_RX if bytes arrived since the last parse, or if
+ *     the frame in parsing is due for the idle flush; a quiet line
+ *     does not wake the main loop
 
-	/* 5. Re-enable DMA */
-	ENABLE_DMA(*pDMA10_CONFIG);
+ * @return None
+ */
+EX_INTERRUPT_HANDLER(uartRx_tickIsr)
+{
+	uartRx_t *pThis = uartRx_pTick;
+
+	*pTCNTL = TMPWR | TMREN | TAUTORLD;
+
+	if ( uartRx_written(pThis) != pThis->lastPos
+	     || (UARTRX_HUNT != pThis->state
+	         && pThis->idleCycles < cycles_read() - pThis->lastCycles) ) {
+		event_post(pThis->pEvent, EVENT_UART_RX);
+	}
 }
 
 
 /** Initialize uart rx
  *    - get pointer to buffer pool
  *    - register interrupt handler
- *    - initialize RX queue
+ *    - reset the frame parser
 
  * Parameters:
  * @param pThis  pointer to own object
  * @param pBuffP  pointer to buffer pool to take and return chunks from
  * @param pIsrDisp   pointer to interrupt dispatcher to get ISR registered
+ * @param pEvent  events to post to the main loop, NULL for none
  *
  * @return Zero on success.
  * Negative value on failure.
  */
-int uartRx_init(uartRx_t *pThis, bufferPool_t *pBuffP, isrDisp_t *pIsrDisp)
+int uartRx_init(uartRx_t *pThis, bufferPool_t *pBuffP, isrDisp_t *pIsrDisp,
+                event_t *pEvent)
 {
 	if ( NULL == pThis || NULL == pBuffP || NULL == pIsrDisp) {
 		printf("[UART RX]: Failed init \r\n");
 		return FAIL;
 	}
 
-	pThis->pPending = NULL;
-	pThis->pBuffP = pBuffP;
-
-	// init queue with
-	if(FAIL == queue_init(&pThis->queue, UARTRX_QUEUE_DEPTH))
-		printf("[UART RX]: Queue init failed \r\n");
-
-	/* Configure the DMA10 for RX (data receive/memory write) */
-	*pDMA10_CONFIG = WDSIZE_8 | DI_EN | WNR; //| DMA2D; // not sure if this should be 2D
+	pThis->rows          = 0;
+	pThis->rdPos         = 0;
+	pThis->frameStart    = 0;
+	pThis->lastPos       = 0;
+	pThis->lastCycles    = cycles_read();
+	pThis->idleCycles    = UARTRX_IDLE_CYCLES(SAMPLE_SIZE / 2);
+	pThis->len           = 0;
+	pThis->pBuffP        = pBuffP;
+	pThis->pEvent        = pEvent;
+	pThis->state         = UARTRX_HUNT;
+	pThis->seqValid      = 0;
+	pThis->expectSeq     = 0;
+	pThis->silent        = 0;
+	pThis->bytesSkipped  = 0;
+	pThis->overruns      = 0;
+	telemetry_init(&pThis->stats);
+
+	/* DMA10 stays off until uartRx_start */
+	*pDMA10_CONFIG = 0;
 
 	// register own ISR to the ISR dispatcher
 	isrDisp_registerCallback(pIsrDisp, ISR_DMA10_UART1_RX, uartRx_isr, pThis);
@@ -88,10 +215,9 @@ int uartRx_init(uartRx_t *pThis, bufferPool_t *pBuffP, isrDisp_t *pIsrDisp)
 
 
 /** start uart rx
- *    - start receiving first chunk from DMA
- * 		- acquire chunk from pool
- *      - config DMA
- *      - start DMA + SPORT
+ *    - set the line idle timeout for the frame duration of the pool
+ *    - start the circular DMA into the ring
+ *    - enable the UART receive DMA request
  * Parameters:
  * @param pThis  pointer to own object
  *
@@ -102,22 +228,60 @@ int uartRx_start(uartRx_t *pThis)
 {
 	printf("[UART RX]: uartRx_start: implemented \r\n");
 
-	/* prime the system by getting the first buffer filled */
-	if ( FAIL == bufferPool_acquire(pThis->pBuffP, &pThis->pPending ) ) {
-		printf("[UART RX]: Failed to acquire buffer \r\n");
-		return FAIL;
-	}
+	// frame duration is known now, as carved by the buffer pool
+	pThis->idleCycles = UARTRX_IDLE_CYCLES(pThis->pBuffP->frameSize / 2);
 
-	uartRx_dmaConfig(pThis->pPending);
+	uartRx_dmaConfig(pThis);
 
 	/* 6. enable interrupt register */
 	*pUART1_IER |= ERBFI;
 
+	/* 7. core timer tick, taken over from the board library
+	 * (coreTimer_init), auto reload at the core clock */
+	uartRx_pTick = pThis;
+	register_handler(ik_timer, uartRx_tickIsr);
+	*pTCNTL   = TMPWR;
+	*pTSCALE  = 0;
+	*pTPERIOD = UARTRX_TICK_CYCLES;
+	*pTCOUNT  = UARTRX_TICK_CYCLES;
+	*pTCNTL   = TMPWR | TMREN | TAUTORLD;
+
 	return PASS;
 }
 
 
+/** a frame passed the header check
+ *   - account for sequence gaps
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pChunk  chunk holding the frame header
+ *
+ * @return void
+ */
+static void uartRx_frameDone(uartRx_t *pThis, chunk_t *pChunk)
+{
+	unsigned short seq = frame_seq(pChunk);
+	unsigned short gap;
+
+	if ( pThis->seqValid ) {
+		gap = (unsigned short) (seq - pThis->expectSeq);
+		// frames from before a far end restart show up as huge gaps,
+		// after a SID the far end leaves out silent frames on purpose
+		if ( 0x8000 > gap && !pThis->silent ) {
+			telemetry_drop(&pThis->stats, TELEMETRY_DROP_LINK_LOSS, gap);
+		}
+	}
+	pThis->expectSeq = (unsigned short) (seq + 1);
+	pThis->seqValid  = 1;
+	pThis->silent    = (COMPRESSION_CODEC_SID == frame_codec(pChunk));
+}
+
+
 /** uartRx_isr
+ *   - a ring row is complete, count it
+ *   - post EVENT_UART_RX
+ *   - the DMA runs on, frames are parsed in uartRx_getNbNc
 
  * Parameters:
  * @param pThisArg  pointer to own object
@@ -126,52 +290,141 @@ int uartRx_start(uartRx_t *pThis)
  */
 void uartRx_isr(void *pThisArg)
 {
-	int queueFail = 0;
-	int bufferPoolFail = 0;
 	//printf("[UART RX ISR]\r\n");
 	// local pThis to avoid constant casting
 	uartRx_t *pThis = (uartRx_t*) pThisArg;
 
+	PROFILE_BEGIN(PROFILE_UART_RX_ISR);
 	if ( *pDMA10_IRQ_STATUS & 0x1 ) {
+		*pDMA10_IRQ_STATUS |= DMA_DONE;		// clear the interrupt
+		pThis->rows++;
+		event_post(pThis->pEvent, EVENT_UART_RX);
+	}
+	PROFILE_END(PROFILE_UART_RX_ISR);
+}
+
+
+/** parse the received bytes up to the next complete frame
+ *   - hunt for the sync word, check the header, wait for the payload
+ *   - a complete frame is copied into a pool chunk and CRC checked
+ *   - after a bad header or CRC the bytes behind the sync word are
+ *     scanned again, a frame that started inside is not lost
+ *   - a frame still incomplete once the line is idle is flushed
+ *   - if the DMA laps the parser the unparsed bytes are dropped
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param ppChunk  the frame, valid on success
+ *
+ * @return Zero on success.
+ * Negative value if no complete frame was received.
+ */
+static int uartRx_parse(uartRx_t *pThis, chunk_t **ppChunk)
+{
+	unsigned int wrPos = uartRx_written(pThis);
+	unsigned int now   = cycles_read();
+	unsigned int start;
+	chunk_t *pChunk = NULL;
+
+	// bytes still needed may have been overwritten, keep a row of margin
+	start = (UARTRX_HUNT == pThis->state) ? pThis->rdPos : pThis->frameStart;
+	if ( UARTRX_RING_SIZE - UARTRX_ROW_SIZE < wrPos - start ) {
+		pThis->overruns++;
+		// frames lost show up as a sequence gap
+		pThis->bytesSkipped += wrPos - start;
+		pThis->rdPos = wrPos;
+		pThis->state = UARTRX_HUNT;
+	}
 
-		//  chunk is now filled, so update the length
-        pThis->pPending->len = pThis->pPending->size;
-
-        /* Insert the chunk previously read by the DMA RX on the
-         * RX QUEUE and a data is inserted to queue
-         */
-        if ( FAIL == queue_put(&pThis->queue, pThis->pPending) ) {
-        	queueFail = 1;
-        	// reuse the same buffer and overwrite last samples
-        	uartRx_dmaConfig(pThis->pPending);
-        	//printf("[UART RX INT]: RX Packet Dropped \r\n");
-        } else {
-
-        	/* Otherwise, attempt to acquire a chunk from the buffer
-			 * pool.
-			 */
-			if ( PASS == bufferPool_acquire(pThis->pBuffP, &pThis->pPending) ) {
-				/* If successful, configure the DMA to write
-				 * to this chunk.
-				 */
-				uartRx_dmaConfig(pThis->pPending);
+	// line idle check
+	if ( wrPos != pThis->lastPos ) {
+		pThis->lastPos    = wrPos;
+		pThis->lastCycles = now;
+	} else if ( UARTRX_HUNT != pThis->state
+	            && pThis->idleCycles < now - pThis->lastCycles ) {
+		// the rest of the frame is not coming
+		telemetry_drop(&pThis->stats, TELEMETRY_DROP_CORRUPT, 1);
+		uartRx_resync(pThis);
+	}
+
+	while ( 1 ) {
+		switch ( pThis->state ) {
+		case UARTRX_HUNT:
+			if ( 2 > (int) (wrPos - pThis->rdPos) ) {
+				return FAIL;
+			}
+			if ( FRAME_SYNC0 == pThis->ring[UARTRX_SLOT(pThis->rdPos)]
+			     && FRAME_SYNC1 == pThis->ring[UARTRX_SLOT(pThis->rdPos + 1)] ) {
+				pThis->frameStart = pThis->rdPos;
+				pThis->state      = UARTRX_HEADER;
 			} else {
-				bufferPoolFail = 1;
-				/* If not successful, then we are out of
-				 * memory because the buffer pool is empty.
-				 */
-				//printf("Buffer pool is empty!\n");
+				pThis->rdPos++;
+				pThis->bytesSkipped++;
 			}
-        }
-		*pDMA10_IRQ_STATUS |= DMA_DONE;		// clear the interrupt
+			break;
+
+		case UARTRX_HEADER:
+			if ( FRAME_HDR_SIZE > (int) (wrPos - pThis->frameStart) ) {
+				return FAIL;
+			}
+			uartRx_copy(pThis, pThis->hdr, pThis->frameStart, FRAME_HDR_SIZE);
+			pThis->len = frame_checkHeader(pThis->hdr, SAMPLE_SIZE);
+			if ( 0 < pThis->len ) {
+				pThis->state = UARTRX_PAYLOAD;
+			} else {
+				// sync word followed by a bad length
+				telemetry_drop(&pThis->stats, TELEMETRY_DROP_CORRUPT, 1);
+				uartRx_resync(pThis);
+			}
+			break;
+
+		case UARTRX_PAYLOAD:
+			if ( FRAME_HDR_SIZE + pThis->len > (int) (wrPos - pThis->frameStart) ) {
+				return FAIL;
+			}
+			if ( pThis->len > pThis->pBuffP->frameSize ) {
+				// longer than a frame of the pool, far end uses longer frames
+				telemetry_drop(&pThis->stats, TELEMETRY_DROP_INVALID, 1);
+				pThis->rdPos = pThis->frameStart + FRAME_HDR_SIZE + pThis->len;
+				pThis->state = UARTRX_HUNT;
+				break;
+			}
+			// coded payload, a chunk of the size class that fits
+			if ( PASS != bufferPool_acquireSize(pThis->pBuffP, pThis->len, &pChunk) ) {
+				// pool empty, drop
+				pThis->stats.poolEmpty++;
+				telemetry_drop(&pThis->stats, TELEMETRY_DROP_NO_BUFFER, 1);
+				pThis->rdPos = pThis->frameStart + FRAME_HDR_SIZE + pThis->len;
+				pThis->state = UARTRX_HUNT;
+				break;
+			}
+			uartRx_copy(pThis, pChunk->hdr, pThis->frameStart, FRAME_HDR_SIZE + pThis->len);
+			pChunk->len = pThis->len;
+
+			if ( PASS == frame_checkCrc(pChunk) ) {
+				pChunk->flags = frame_flags(pChunk);
+				uartRx_frameDone(pThis, pChunk);
+				pThis->rdPos = pThis->frameStart + FRAME_HDR_SIZE + pThis->len;
+				pThis->state = UARTRX_HUNT;
+				*ppChunk = pChunk;
+				return PASS;
+			}
+
+			/* bytes lost or added: the next header may already
+			 * have started inside this payload */
+			bufferPool_release(pThis->pBuffP, pChunk);
+			telemetry_drop(&pThis->stats, TELEMETRY_DROP_CORRUPT, 1);
+			uartRx_resync(pThis);
+			break;
+		}
 	}
 }
 
 
 /** uart rx get
  *   copies a filled chunk into pChunk
- *   blocking call, blocks if queue is empty
- *     - get from queue
+ *   does not block, fails if no complete frame was received
+ *     - get next frame
  *     - copy in to pChunk
  *     - release chunk to buffer pool
  * Parameters:
@@ -185,31 +438,45 @@ int uartRx_get(uartRx_t *pThis, chunk_t *pChunk)
 {
 	chunk_t *chunk_rx;
 
-	/* Block till a chunk arrives on the rx queue */
-	//while( queue_is_empty(&pThis->queue) )
-	if( queue_is_empty(&pThis->queue) )
-	{
-		//printf("[UART RX] Queue is empty\r\n");
+	// does not block, FAIL if no frame is complete
+	if ( FAIL == uartRx_getNbNc(pThis, &chunk_rx) ) {
 		return FAIL;
-		//powerMode_change(PWR_ACTIVE);
-		//asm("idle;");
 	}
-	//powerMode_change(PWR_FULL_ON);
 
-	 if(FAIL == queue_get(&pThis->queue, (void**)&chunk_rx))
+	chunk_copy(chunk_rx, pChunk);
+	bufferPool_release(pThis->pBuffP, chunk_rx);
+	return PASS;
+}
+
+
+/** uart rx get (no block, no copy)
+ *    parses the bytes received so far, returns a frame as soon as its
+ *    last byte is in the ring
+ *    caller is responsible for releasing the chunk
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param ppChunk  Pointer Pointer to the received chunk
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int uartRx_getNbNc(uartRx_t *pThis, chunk_t **ppChunk)
+{
+	if ( PASS != uartRx_parse(pThis, ppChunk) ) {
+		//printf("[UART RX] No frame\r\n");
 		return FAIL;
-	else {
-		 chunk_copy(chunk_rx, pChunk);
-		 bufferPool_release(pThis->pBuffP, chunk_rx);
-		 return PASS;
 	}
+	// parsed straight into the caller's hands
+	telemetry_in(&pThis->stats);
+	telemetry_out(&pThis->stats);
 
-	return FAIL;
+	return PASS;
 }
 
 
 /* uart rx dma stop
- * - empty for now
+ * - disables the receive DMA request, DMA10 and the tick
  *
  * @return
  */
@@ -221,5 +488,8 @@ void uartRx_dmaStop(void)
 	// disable the DMA
 	DISABLE_DMA(*pDMA10_CONFIG);
 
+	// stop the tick
+	*pTCNTL = TMPWR;
+
 	return;
 }
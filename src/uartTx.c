@@ -14,16 +14,17 @@
 #include "uartTx.h"
 #include "bufferPool.h"
 #include "isrDisp.h"
+#include "frame.h"
+#include "profile.h"
+#include "critical.h"
 #include <tll_config.h>
 #include <tll_sport.h>
-#include <queue.h>
 #include <power_mode.h>
 
 /** Configure the UART DMA
- * Configures the DMA tx with the buffer and the buffer length to
- * receive
+ * Configures the DMA tx to send the framed chunk, header + payload
  * Parameters:
- * @param pchunk  pointer to receive chunk
+ * @param pchunk  pointer to framed chunk
  *
  * @return void
  */
@@ -33,10 +34,10 @@ void uartTx_dmaConfig(chunk_t *pChunk)
 	DISABLE_DMA(*pDMA11_CONFIG);
 
 	/* 2. Configure start address */
-	*pDMA11_START_ADDR = &pChunk->u08_buff[0]; // should this match audioTx?
+	*pDMA11_START_ADDR = &pChunk->hdr[0];	// header sits right in front of the data
 
 	/* 3. set X count */
-	*pDMA11_X_COUNT = pChunk->len;//*pDMA11_X_COUNT = 2; // should this match audioTx?
+	*pDMA11_X_COUNT = FRAME_HDR_SIZE + pChunk->len;
 	//*pDMA11_Y_COUNT = pChunk->len/2;
 
 	/* 4. set X modify */
@@ -75,9 +76,11 @@ int uartTx_init(uartTx_t *pThis, bufferPool_t *pBuffP, isrDisp_t *pIsrDisp)
 	pThis->pPending     = NULL;
 	pThis->pBuffP       = pBuffP;
 	pThis->running      = 0;
+	pThis->seq          = 0;
+	telemetry_init(&pThis->stats);
 
 	// init queue
-	if(FAIL == queue_init(&pThis->queue, UARTTX_QUEUE_DEPTH))
+	if(FAIL == spscRing_init(&pThis->queue, UARTTX_QUEUE_DEPTH))
 	{
 		printf("[UART TX]: Failed to init queue \r\n");
 		return FAIL;
@@ -130,11 +133,13 @@ void uartTx_isr(void *pThisArg)
 
 	chunk_t *pchunk = NULL;
 
+	PROFILE_BEGIN(PROFILE_UART_TX_ISR);
 	// validate that TX DMA IRQ was triggered
 	if ( *pDMA11_IRQ_STATUS & 0x1  ) {
 		/* 1. Attempt to get the new chunk, and check if it's available: */
-		if (PASS == queue_get(&pThis->queue, (void **)&pchunk) ) {
+		if (PASS == spscRing_get(&pThis->queue, (void **)&pchunk) ) {
 			//printf("[UTX ISR] AC\r\n");
+			telemetry_out(&pThis->stats);
 			/* 2. If so, release old chunk on success back to buffer pool */
 			bufferPool_release(pThis->pBuffP, pThis->pPending);
 
@@ -149,11 +154,16 @@ void uartTx_isr(void *pThisArg)
 			// queue is empty, stop the DMA
 			uartTx_dmaStop();
 
+			// last chunk is sent, return it to the pool
+			bufferPool_release(pThis->pBuffP, pThis->pPending);
+			pThis->pPending = NULL;
+
 			// indicate that the DMA has stopped
 			pThis->running = 0;
 		}
 		*pDMA11_IRQ_STATUS |= DMA_DONE;		// Clear the interrupt
 	}
+	PROFILE_END(PROFILE_UART_TX_ISR);
 }
 
 
@@ -170,9 +180,6 @@ void uartTx_isr(void *pThisArg)
 int uartTx_put(uartTx_t *pThis, chunk_t *pChunk)
 {
 	chunk_t *pchunk_temp = NULL;
-	int queueFull = 0;
-	int bufferAcquired = 0;
-	int queuePut = 0;
 	    if ( NULL == pThis || NULL == pChunk ) {
 	        //printf("[UART TX]: Failed to put \r\n");
 	        return FAIL;
@@ -180,48 +187,33 @@ int uartTx_put(uartTx_t *pThis, chunk_t *pChunk)
 
 	    // block if queue is full
 	    //while(queue_is_full(&pThis->queue)) {
-	    if(queue_is_full(&pThis->queue)) {
+	    if(spscRing_isFull(&pThis->queue)) {
 	        //printf("[UART TX]: Queue Full \r\n");
-	    	queueFull = 1;
+	    	telemetry_drop(&pThis->stats, TELEMETRY_DROP_QUEUE_FULL, 1);
 	        return FAIL;
 	        //powerMode_change(PWR_ACTIVE);
 	        //asm("idle;");
 	    }
 	    //powerMode_change(PWR_FULL_ON);
 
-	    // get free chunk from pool
-		if ( PASS == bufferPool_acquire(pThis->pBuffP, &pchunk_temp) ) {
+	    // get free chunk from pool, the smallest that holds the frame
+		if ( PASS == bufferPool_acquireSize(pThis->pBuffP, pChunk->len, &pchunk_temp) ) {
 			// copy chunk into free buffer for queue
-			chunk_copy(pChunk, pchunk_temp);
-			bufferAcquired = 1;
-			/* If DMA not running ? */
-			if ( 0 == pThis->running ) {
-				/* directly put chunk to DMA transfer & enable */
-				//printf("[UART TX] put chunk directly onto DMA transfer\r\n");
-				pThis->running  = 1;
-				pThis->pPending = pchunk_temp;
-				uartTx_dmaConfig(pThis->pPending);
-				return PASS;
-
-			} else {
-				//printf("[UART TX] Chunk added to queue\r\n");
-				/* DMA already running add chunk to queue */
-				if ( FAIL == queue_put(&pThis->queue, pchunk_temp) ) {
-					//printf("[UART TX] Failed to add to queue\r\n");
-					// return chunk to pool if queue is full, effectively dropping the chunk
-					queuePut = 1;
-					bufferPool_release(pThis->pBuffP, pchunk_temp);
-					return FAIL;
-				}
-				else
-				{
-					return PASS;
-				}
+			if ( PASS != chunk_copy(pChunk, pchunk_temp) ) {
+				// longer than a frame of the pool
+				bufferPool_release(pThis->pBuffP, pchunk_temp);
+				telemetry_drop(&pThis->stats, TELEMETRY_DROP_INVALID, 1);
+				return FAIL;
 			}
 
+			// hand the copy over, released by the ISR once sent
+			return uartTx_putNc(pThis, pchunk_temp);
+
 		} else {
 			// drop if we don't get free space
 			//printf("[UART TX]: failed to get buffer \r\n");
+			pThis->stats.poolEmpty++;
+			telemetry_drop(&pThis->stats, TELEMETRY_DROP_NO_BUFFER, 1);
 			return FAIL;
 		}
 
@@ -230,6 +222,75 @@ int uartTx_put(uartTx_t *pThis, chunk_t *pChunk)
 }
 
 
+/** uart tx put (no copy)
+ *   frames the chunk (sync, sequence number, length, CRC) and
+ *   hands it over for transmission, ownership passes to
+ *   uartTx: the chunk is released to the buffer pool by the ISR once
+ *   sent, or right away if it has to be dropped
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pChunk  chunk acquired from the buffer pool
+ *
+ * @return Zero on success.
+ * Negative value on failure (chunk dropped).
+ */
+int uartTx_putNc(uartTx_t *pThis, chunk_t *pChunk)
+{
+	unsigned int mask;
+
+	if ( NULL == pThis || NULL == pChunk ) {
+		return FAIL;
+	}
+
+	// header goes into the chunk headroom, main loop context
+	if ( FAIL == frame_build(pChunk, pThis->seq) ) {
+		bufferPool_release(pThis->pBuffP, pChunk);
+		telemetry_drop(&pThis->stats, TELEMETRY_DROP_INVALID, 1);
+		return FAIL;
+	}
+	pThis->seq++;
+
+	/* queue, check the DMA and start it as one: the ISR may have found
+	 * the queue empty just before the put and be about to stop the DMA,
+	 * the chunk would sit in the queue with nothing to send it */
+	mask = critical_enter();
+	if ( FAIL == spscRing_put(&pThis->queue, pChunk) ) {
+		critical_exit(mask);
+		// return chunk to pool if queue is full, effectively dropping the chunk
+		bufferPool_release(pThis->pBuffP, pChunk);
+		telemetry_drop(&pThis->stats, TELEMETRY_DROP_QUEUE_FULL, 1);
+		return FAIL;
+	}
+	telemetry_in(&pThis->stats);
+
+	/* If DMA not running ? the ISR is done with the queue, it is ours */
+	if ( 0 == pThis->running && PASS == spscRing_get(&pThis->queue, (void **)&pChunk) ) {
+		/* directly put chunk to DMA transfer & enable */
+		pThis->running  = 1;
+		pThis->pPending = pChunk;
+		telemetry_out(&pThis->stats);
+		uartTx_dmaConfig(pThis->pPending);
+	}
+	critical_exit(mask);
+
+	return PASS;
+}
+
+
+/** uart tx skip
+ *   a frame time passes without a frame (suppressed silence),
+ *   the receiver sees the gap in the sequence numbers
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return void
+ */
+void uartTx_skip(uartTx_t *pThis)
+{
+	pThis->seq++;
+}
+
+
 /* uart tx dma stop
  * - empty for now
  *
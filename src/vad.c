@@ -0,0 +1,150 @@
+/**
+ *@file vad.c
+ *
+ *@brief
+ *  - voice activity detection for the transmit path
+ *
+ *  A chunk is speech if its mean magnitude is well above the noise
+ *  floor, or moderately above it with a zero crossing count unlike the
+ *  noise (fricatives are quiet but cross zero often). The noise floor
+ *  follows the level quickly downwards and slowly upwards during
+ *  silence, and creeps up during speech so a rise of the background
+ *  noise cannot lock the detector on speech.
+ *
+ * Target:   TLL6527v1-0
+ * Compiler: VDSP++     Output format: VDSP++ "*.dxe"
+ *
+ *******************************************************************************/
+#include "tll_common.h"
+#include "vad.h"
+#include "compression.h"
+
+
+/** Initialize voice activity detection
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int vad_init(vad_t *pThis)
+{
+	if ( NULL == pThis ) {
+		printf("[VAD]: Failed init\r\n");
+		return FAIL;
+	}
+
+	pThis->noiseLevel = VAD_LEVEL_MIN;
+	pThis->noiseZcr   = 0;
+	pThis->hangover   = 0;
+	pThis->sinceSid   = VAD_SID_INTERVAL;
+	pThis->speech     = 0;
+	pThis->sid        = 0;
+	pThis->silent     = 0;
+
+	printf("[VAD]: Init complete\r\n");
+	return PASS;
+}
+
+
+/** classify a chunk of 16 bit PCM
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pChunk  captured chunk
+ *
+ * @return VAD_SPEECH, VAD_SID or VAD_SILENT
+ */
+vad_decision_t vad_process(vad_t *pThis, chunk_t *pChunk)
+{
+	int count;
+	int samples = pChunk->len / 2;
+	int sum = 0;
+	int zcr = 0;
+	int level;
+	int zcrDiff;
+	int active;
+	short *pIn = pChunk->s16_buff;
+	short prev;
+
+	if ( 0 >= samples ) {
+		return VAD_SILENT;
+	}
+
+	prev = pIn[0];
+	for ( count = 0; samples > count; count++ ) {
+		sum += (0 > pIn[count]) ? -pIn[count] : pIn[count];
+		zcr += (prev ^ pIn[count]) < 0;
+		prev = pIn[count];
+	}
+	level = sum / samples;
+
+	zcrDiff = zcr - pThis->noiseZcr;
+	if ( 0 > zcrDiff ) {
+		zcrDiff = -zcrDiff;
+	}
+
+	active = VAD_LEVEL_MIN < level
+	         && ( VAD_LEVEL_RATIO * pThis->noiseLevel < level
+	              || ( 3 * pThis->noiseLevel < 2 * level
+	                   && samples < VAD_ZCR_DELTA * zcrDiff ) );
+
+	if ( active ) {
+		pThis->hangover = VAD_HANGOVER;
+		pThis->noiseLevel += 1 + pThis->noiseLevel / 512;
+	} else {
+		if ( level < pThis->noiseLevel ) {
+			pThis->noiseLevel = level;
+		} else {
+			pThis->noiseLevel += (level - pThis->noiseLevel) / 8;
+		}
+		pThis->noiseZcr += (zcr - pThis->noiseZcr) / 8;
+		if ( VAD_LEVEL_MIN > pThis->noiseLevel ) {
+			pThis->noiseLevel = VAD_LEVEL_MIN;
+		}
+	}
+
+	if ( active || 0 < pThis->hangover-- ) {
+		// first silent chunk after speech gets a SID
+		pThis->sinceSid = VAD_SID_INTERVAL;
+		pThis->speech++;
+		return VAD_SPEECH;
+	}
+	pThis->hangover = 0;
+
+	if ( VAD_SID_INTERVAL <= pThis->sinceSid ) {
+		pThis->sinceSid = 1;
+		pThis->sid++;
+		return VAD_SID;
+	}
+
+	pThis->sinceSid++;
+	pThis->silent++;
+	return VAD_SILENT;
+}
+
+
+/** turn a chunk into a SID frame with the current noise level
+ *   (COMPRESSION_HDR_SIZE bytes, see compression.h)
+ *
+ * Parameters:
+ * @param pThis  pointer to own object
+ * @param pChunk  chunk to overwrite
+ *
+ * @return void
+ */
+void vad_sid(vad_t *pThis, chunk_t *pChunk)
+{
+	int level = pThis->noiseLevel;
+
+	if ( 0xFFFF < level ) {
+		level = 0xFFFF;
+	}
+
+	pChunk->u08_buff[0] = COMPRESSION_CODEC_SID;
+	pChunk->u08_buff[1] = 0;
+	pChunk->u08_buff[2] = (unsigned char) (level & 0xFF);
+	pChunk->u08_buff[3] = (unsigned char) (level >> 8);
+	pChunk->len         = COMPRESSION_HDR_SIZE;
+}
@@ -0,0 +1,352 @@
+/**
+ *@file aecbench.c
+ *
+ *@brief
+ *  - host benchmark of the echo canceller (src/aec.c): echo return
+ *    loss enhancement, near end kept through double talk, and cost
+ *    per chunk against AEC_CYCLES_PER_SAMPLE
+ *
+ *  aecbench                     generated scenarios
+ *  aecbench <far.raw> <mic.raw> a recording, 16 bit little endian
+ *                               8 kHz mono: the far end as played and
+ *                               the microphone, sample aligned
+ *
+ *  The generated scenarios play a speech like far end (shaped noise,
+ *  syllable envelope) through a synthetic room (direct path plus
+ *  exponentially decaying reflections) at -60 dBFS microphone noise:
+ *  - far end only
+ *  - double talk: near end talks from 5 s to 7 s
+ *  - echo path change at 5 s
+ *  - near end only: output has to be the input, bit exact
+ *
+ *  Chunks of 20 ms go through aec_reference / aec_process as on the
+ *  target, playback and capture aligned. Cycles are the host monotonic
+ *  clock at 600 MHz (cycles.h), an estimate only: the target figure is
+ *  the "aec" stage of the profile (PROFILE_ENABLE).
+ *
+ *******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "tll_common.h"
+#include "aec.h"
+#include "cycles.h"
+
+/**
+ * @def BENCH_RATE
+ * @brief samples per second
+ */
+#define BENCH_RATE	(8000)
+
+/**
+ * @def BENCH_CHUNK
+ * @brief samples per chunk, 20 ms
+ */
+#define BENCH_CHUNK	(160)
+
+/**
+ * @def BENCH_SECONDS
+ * @brief length of a generated scenario
+ */
+#define BENCH_SECONDS	(10)
+
+/**
+ * @def BENCH_ROOM
+ * @brief taps of the synthetic room, within AEC_TAPS
+ */
+#define BENCH_ROOM	(200)
+
+
+/** result of one run */
+typedef struct {
+	double cycles;        /* mean per chunk */
+	double cyclesMax;     /* worst chunk */
+	int    exact;         /* output equals input */
+} bench_result_t;
+
+static aec_t aec;
+static unsigned int bench_seed = 1;
+
+
+static double bench_noise(void)
+{
+	bench_seed = bench_seed * 1103515245u + 12345u;
+	return ((bench_seed >> 8) & 0xFFFF) / 32768.0 - 1.0;
+}
+
+
+static short bench_sat(double value)
+{
+	if ( 32767.0 < value ) {
+		return 32767;
+	} else if ( -32768.0 > value ) {
+		return -32768;
+	}
+	return (short) lrint(value);
+}
+
+
+/** speech like signal: noise through a two pole resonance, syllables
+ *  of 150..400 ms with pauses of 50..250 ms */
+static void bench_talker(double *pOut, int len, double formant, double level)
+{
+	double r = 0.95;
+	double a1 = 2.0 * r * cos(2.0 * M_PI * formant / BENCH_RATE);
+	double a2 = -r * r;
+	double y1 = 0.0;
+	double y2 = 0.0;
+	double env = 0.0;
+	double target = 0.0;
+	int left = 0;
+	int on = 0;
+	int count;
+
+	for ( count = 0; len > count; count++ ) {
+		if ( 0 >= left-- ) {
+			on     = !on;
+			left   = (on ? 1200 : 400) + (int) (fabs(bench_noise()) * (on ? 2000 : 1600));
+			target = on ? level * (0.5 + 0.5 * fabs(bench_noise())) : 0.0;
+		}
+		env += 0.005 * (target - env);
+		double y = bench_noise() + a1 * y1 + a2 * y2;
+		y2 = y1;
+		y1 = y;
+		pOut[count] = env * y * (1.0 - r);
+	}
+}
+
+
+/** room impulse response: direct path, then decaying reflections */
+static void bench_room(double *pH, int delay, double gain)
+{
+	int count;
+
+	for ( count = 0; BENCH_ROOM > count; count++ ) {
+		pH[count] = 0.0;
+		if ( count == delay ) {
+			pH[count] = gain;
+		} else if ( count > delay ) {
+			pH[count] = 0.15 * gain * bench_noise() * exp(-(count - delay) / 40.0);
+		}
+	}
+}
+
+
+/** run the canceller over far end and microphone, PCM */
+static void bench_run(const short *pFar, const short *pMic, short *pOut, int len,
+                      bench_result_t *pResult)
+{
+	static unsigned int farMem[CHUNK_WORDS(BENCH_CHUNK * 2)];
+	static unsigned int micMem[CHUNK_WORDS(BENCH_CHUNK * 2)];
+	chunk_t far;
+	chunk_t mic;
+	unsigned int start;
+	unsigned int cycles;
+	double sum = 0.0;
+	int chunks = 0;
+	int pos;
+	int count;
+
+	aec_init(&aec);
+	chunk_init(&far, farMem, BENCH_CHUNK * 2);
+	chunk_init(&mic, micMem, BENCH_CHUNK * 2);
+	pResult->cyclesMax = 0.0;
+
+	for ( pos = 0; len >= pos + BENCH_CHUNK; pos += BENCH_CHUNK ) {
+		for ( count = 0; BENCH_CHUNK > count; count++ ) {
+			far.s16_buff[count] = pFar[pos + count];
+			mic.s16_buff[count] = pMic[pos + count];
+		}
+		far.len = mic.len = BENCH_CHUNK * 2;
+
+		aec_reference(&aec, &far, pos);
+		start  = cycles_read();
+		aec_process(&aec, &mic, pos);
+		cycles = cycles_read() - start;
+
+		sum += cycles;
+		chunks++;
+		if ( cycles > pResult->cyclesMax ) {
+			pResult->cyclesMax = cycles;
+		}
+		for ( count = 0; BENCH_CHUNK > count; count++ ) {
+			pOut[pos + count] = mic.s16_buff[count];
+		}
+	}
+	pResult->cycles = chunks ? sum / chunks : 0.0;
+}
+
+
+/** 10 log10 of the energy ratio over [from, to) */
+static double bench_db(const double *pNum, const short *pDen, int from, int to)
+{
+	double num = 1e-3;
+	double den = 1e-3;
+	int count;
+
+	for ( count = from; to > count; count++ ) {
+		num += pNum[count] * pNum[count];
+		den += (double) pDen[count] * pDen[count];
+	}
+	return 10.0 * log10(num / den);
+}
+
+
+/** generated scenario
+ * @param nearFrom  near end talks from this second, -1 for none
+ * @param change  echo path changes at this second, -1 for none
+ * @param farOn  far end plays
+ */
+static void bench_scenario(const char *pName, int nearFrom, int nearTo, int change, int farOn)
+{
+	int len = BENCH_SECONDS * BENCH_RATE;
+	double *pFarD  = calloc(len, sizeof(double));
+	double *pNearD = calloc(len, sizeof(double));
+	double *pEcho  = calloc(len, sizeof(double));
+	short *pFar = calloc(len, sizeof(short));
+	short *pMic = calloc(len, sizeof(short));
+	short *pOut = calloc(len, sizeof(short));
+	double room[2][BENCH_ROOM];
+	bench_result_t result;
+	double err;
+	double nearE = 1e-3;
+	double errE  = 1e-3;
+	int count;
+	int tap;
+
+	bench_seed = 1;
+	bench_talker(pFarD, len, 600.0, farOn ? 36000.0 : 0.0);
+	bench_talker(pNearD, len, 1100.0, 0 <= nearFrom ? 60000.0 : 0.0);
+	bench_room(room[0], 12, 0.25);
+	bench_room(room[1], 30, 0.2);
+
+	for ( count = 0; len > count; count++ ) {
+		pFar[count] = bench_sat(pFarD[count]);
+		if ( count < nearFrom * BENCH_RATE || count >= nearTo * BENCH_RATE ) {
+			pNearD[count] = 0.0;
+		}
+	}
+	for ( count = 0; len > count; count++ ) {
+		const double *pH = room[0 <= change && count >= change * BENCH_RATE];
+		double sum = 0.0;
+
+		for ( tap = 0; BENCH_ROOM > tap && tap <= count; tap++ ) {
+			sum += pH[tap] * pFar[count - tap];
+		}
+		pEcho[count] = sum;
+		pMic[count]  = bench_sat(sum + pNearD[count] + 32.0 * bench_noise());
+	}
+
+	bench_run(pFar, pMic, pOut, len, &result);
+
+	printf("%-16s", pName);
+	if ( farOn ) {
+		// echo before / residual after, near end free part at the end
+		for ( count = len - 2 * BENCH_RATE; len > count; count++ ) {
+			nearE += pEcho[count] * pEcho[count];
+			errE  += (double) pOut[count] * pOut[count];
+		}
+		printf(" ERLE %5.1f dB", 10.0 * log10(nearE / errE));
+	}
+	if ( 0 <= nearFrom && farOn ) {
+		// what is left of the near end while both talk
+		for ( count = nearFrom * BENCH_RATE, nearE = errE = 1e-3; nearTo * BENCH_RATE > count; count++ ) {
+			err    = pOut[count] - pNearD[count];
+			nearE += pNearD[count] * pNearD[count];
+			errE  += err * err;
+		}
+		printf(" near end / distortion %5.1f dB", 10.0 * log10(nearE / errE));
+	}
+	if ( !farOn ) {
+		result.exact = 0 == memcmp(pMic, pOut, len * sizeof(short));
+		printf(" output %s", result.exact ? "bit exact" : "CHANGED");
+	}
+	printf(" | %6.0f cycles/chunk (max %6.0f), %4.0f/sample, budget %d\n",
+	       result.cycles, result.cyclesMax, result.cycles / BENCH_CHUNK, AEC_CYCLES_PER_SAMPLE);
+
+	free(pFarD);
+	free(pNearD);
+	free(pEcho);
+	free(pFar);
+	free(pMic);
+	free(pOut);
+}
+
+
+/** read a raw 16 bit file */
+static short *bench_load(const char *pName, int *pLen)
+{
+	FILE *pFile = fopen(pName, "rb");
+	short *pData;
+	long size;
+
+	if ( NULL == pFile ) {
+		perror(pName);
+		exit(1);
+	}
+	fseek(pFile, 0, SEEK_END);
+	size = ftell(pFile) / 2;
+	fseek(pFile, 0, SEEK_SET);
+	pData = calloc(size ? size : 1, sizeof(short));
+	*pLen = (int) fread(pData, sizeof(short), size, pFile);
+	fclose(pFile);
+	return pData;
+}
+
+
+/** recorded scenario, ERLE over all and the last 2 s (far end only) */
+static void bench_recording(const char *pFarName, const char *pMicName)
+{
+	bench_result_t result;
+	double *pMicD;
+	short *pFar;
+	short *pMic;
+	short *pOut;
+	int farLen;
+	int len;
+	int count;
+
+	pFar = bench_load(pFarName, &farLen);
+	pMic = bench_load(pMicName, &len);
+	if ( farLen < len ) {
+		len = farLen;
+	}
+	pOut  = calloc(len + 1, sizeof(short));
+	pMicD = calloc(len + 1, sizeof(double));
+
+	bench_run(pFar, pMic, pOut, len, &result);
+	len -= len % BENCH_CHUNK;
+	for ( count = 0; len > count; count++ ) {
+		pMicD[count] = pMic[count];
+	}
+	printf("%s: ERLE %5.1f dB, last 2 s %5.1f dB | %6.0f cycles/chunk (max %6.0f), %4.0f/sample, budget %d\n",
+	       pMicName, bench_db(pMicD, pOut, 0, len),
+	       bench_db(pMicD, pOut, len > 2 * BENCH_RATE ? len - 2 * BENCH_RATE : 0, len),
+	       result.cycles, result.cyclesMax, result.cycles / BENCH_CHUNK, AEC_CYCLES_PER_SAMPLE);
+
+	free(pFar);
+	free(pMic);
+	free(pOut);
+	free(pMicD);
+}
+
+
+int main(int argc, char *argv[])
+{
+	if ( 3 == argc ) {
+		bench_recording(argv[1], argv[2]);
+		return 0;
+	}
+	if ( 1 != argc ) {
+		fprintf(stderr, "usage: aecbench [<far.raw> <mic.raw>]\n");
+		return 1;
+	}
+
+	printf("aec: %d taps, blocks of %d, chunks of %d samples\n", AEC_TAPS, AEC_BLOCK, BENCH_CHUNK);
+	bench_scenario("far end only", -1, -1, -1, 1);
+	bench_scenario("double talk", 5, 7, -1, 1);
+	bench_scenario("path change", -1, -1, 5, 1);
+	bench_scenario("near end only", 0, BENCH_SECONDS, -1, 0);
+	return 0;
+}
@@ -0,0 +1,161 @@
+/**
+ *@file codecbench.c
+ *
+ *@brief
+ *  - host benchmark of the G.711 codecs (src/compression.c,
+ *    src/decompression.c) against the raw chunk_copy() path, ADPCM
+ *    alongside for reference
+ *
+ *  codecbench
+ *
+ *  For chunks of 10, 20, 40 and 128 ms of a generated talker, each
+ *  codec encodes into one chunk and decodes into another, BENCH_REPEAT
+ *  times; chunk_copy() copies the PCM chunk as the uncompressed path
+ *  does. Figures are the best of BENCH_RUNS runs, in cycles per chunk
+ *  and per sample, and as a multiple of the chunk_copy() cost.
+ *
+ *  Cycles are the host monotonic clock at 600 MHz (cycles.h), an
+ *  estimate only: the host has caches and a wider core than the
+ *  Blackfin, the ratios carry over better than the figures. The
+ *  target figures are the "encode" and "decode" stages of the
+ *  profile (PROFILE_ENABLE).
+ *
+ *******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "tll_common.h"
+#include "chunk.h"
+#include "compression.h"
+#include "decompression.h"
+#include "cycles.h"
+
+/**
+ * @def BENCH_RATE
+ * @brief samples per second
+ */
+#define BENCH_RATE	(8000)
+
+/**
+ * @def BENCH_REPEAT
+ * @brief chunks per run
+ */
+#define BENCH_REPEAT	(2000)
+
+/**
+ * @def BENCH_RUNS
+ * @brief runs, the fastest is taken
+ */
+#define BENCH_RUNS	(5)
+
+static compression_t comp;
+static decompression_t decomp;
+static unsigned int pcmMem[CHUNK_WORDS(SAMPLE_SIZE)];
+static unsigned int codedMem[CHUNK_WORDS(SAMPLE_SIZE)];
+static unsigned int outMem[CHUNK_WORDS(SAMPLE_SIZE)];
+static chunk_t pcm;
+static chunk_t coded;
+static chunk_t out;
+
+
+/** speech like talker: noise through a formant at a syllable rate */
+static void bench_talker(short *pData, int len)
+{
+	unsigned int seed = 1;
+	double r = 0.95;
+	double a1 = 2.0 * r * cos(2.0 * M_PI * 700.0 / BENCH_RATE);
+	double a2 = -r * r;
+	double y1 = 0.0;
+	double y2 = 0.0;
+	double y;
+	int count;
+
+	for ( count = 0; len > count; count++ ) {
+		seed = seed * 1103515245u + 12345u;
+		y    = ((seed >> 8) & 0xFFFF) / 32768.0 - 1.0 + a1 * y1 + a2 * y2;
+		y2   = y1;
+		y1   = y;
+		pData[count] = (short) lrint(y * (1.0 - r) * 20000.0 * fabs(sin(M_PI * 4.0 * count / BENCH_RATE)));
+	}
+}
+
+
+/** cycles per chunk of one operation, best of BENCH_RUNS
+ *   codec 0 is chunk_copy(), a negative codec decodes the chunk
+ *   encoded with -codec */
+static double bench_run(int codec, int len)
+{
+	unsigned int start;
+	unsigned int cycles;
+	unsigned int best = ~0u;
+	int run;
+	int count;
+
+	pcm.len = len;
+	if ( 0 > codec ) {
+		compression_setCodec(&comp, -codec);
+		compressDataTo(&comp, &pcm, &coded);
+	} else if ( 0 < codec ) {
+		compression_setCodec(&comp, codec);
+	}
+
+	for ( run = 0; BENCH_RUNS > run; run++ ) {
+		start = cycles_read();
+		for ( count = 0; BENCH_REPEAT > count; count++ ) {
+			if ( 0 == codec ) {
+				chunk_copy(&pcm, &out);
+			} else if ( 0 < codec ) {
+				compressDataTo(&comp, &pcm, &coded);
+			} else {
+				decompressDataTo(&decomp, &coded, &out);
+			}
+		}
+		cycles = cycles_read() - start;
+		if ( best > cycles ) {
+			best = cycles;
+		}
+	}
+	return (double) best / BENCH_REPEAT;
+}
+
+
+int main(void)
+{
+	static const int ms[] = { 10, 20, 40, SAMPLE_SIZE / 16 };
+	static const struct {
+		const char *pName;
+		int        codec;
+	} op[] = {
+		{ "ulaw encode",  COMPRESSION_CODEC_ULAW },
+		{ "ulaw decode",  -COMPRESSION_CODEC_ULAW },
+		{ "alaw encode",  COMPRESSION_CODEC_ALAW },
+		{ "alaw decode",  -COMPRESSION_CODEC_ALAW },
+		{ "adpcm encode", COMPRESSION_CODEC_ADPCM },
+		{ "adpcm decode", -COMPRESSION_CODEC_ADPCM },
+	};
+	double copy;
+	double cycles;
+	int len;
+	int index;
+	int count;
+
+	chunk_init(&pcm, pcmMem, SAMPLE_SIZE);
+	chunk_init(&coded, codedMem, SAMPLE_SIZE);
+	chunk_init(&out, outMem, SAMPLE_SIZE);
+	bench_talker(pcm.s16_buff, SAMPLE_SIZE / 2);
+	compression_init(&comp);
+	decompression_init(&decomp);
+
+	for ( index = 0; sizeof(ms) / sizeof(ms[0]) > index; index++ ) {
+		len  = ms[index] * BENCH_RATE / 1000 * 2;
+		copy = bench_run(0, len);
+		printf("%3d ms, %4d bytes of PCM\n", ms[index], len);
+		printf("  %-13s %8.0f cycles/chunk %6.2f cycles/sample\n", "chunk_copy", copy, copy * 2 / len);
+		for ( count = 0; sizeof(op) / sizeof(op[0]) > count; count++ ) {
+			cycles = bench_run(op[count].codec, len);
+			printf("  %-13s %8.0f cycles/chunk %6.2f cycles/sample %6.1f x chunk_copy\n",
+			       op[count].pName, cycles, cycles * 2 / len, cycles / copy);
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,231 @@
+/**
+ *@file codectest.c
+ *
+ *@brief
+ *  - host round trip test of the codecs (src/compression.c,
+ *    src/decompression.c): a WAV file encoded and decoded chunk by
+ *    chunk the way the audio path does it, SNR and cycles per chunk
+ *
+ *  codectest [-c adpcm|ulaw|alaw] [-f <ms>] [<in.wav> [<out.wav>]]
+ *
+ *  -c  codec, IMA ADPCM by default
+ *  -f  frame duration, 128 ms (a full SAMPLE_SIZE chunk) by default
+ *
+ *  The input is 16 bit PCM at 8 kHz, the first channel of it. Without
+ *  one a generated signal is taken (a speech like talker over a tone
+ *  sweep). The decoded signal goes to out.wav if given. The test fails
+ *  (exit code 1) if the SNR is below what the codec should give, or if
+ *  a chunk fails to encode or decode, or decodes to another length.
+ *
+ *  Chunks are encoded and decoded in place, as the audio path does.
+ *  Cycles are the host monotonic clock at 600 MHz (cycles.h), an
+ *  estimate only: the target figure is the "encode" and "decode"
+ *  stages of the profile (PROFILE_ENABLE).
+ *
+ *******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "tll_common.h"
+#include "chunk.h"
+#include "compression.h"
+#include "decompression.h"
+#include "cycles.h"
+#include "wav.h"
+
+/**
+ * @def TEST_RATE
+ * @brief samples per second
+ */
+#define TEST_RATE	(8000)
+
+/**
+ * @def TEST_SECONDS
+ * @brief length of the generated signal
+ */
+#define TEST_SECONDS	(10)
+
+/**
+ * @def TEST_SNR_ADPCM
+ * @brief lowest SNR passed for ADPCM [dB]
+ */
+#define TEST_SNR_ADPCM	(20.0)
+
+/**
+ * @def TEST_SNR_G711
+ * @brief lowest SNR passed for mu-law and A-law [dB]
+ */
+#define TEST_SNR_G711	(30.0)
+
+static compression_t comp;
+static decompression_t decomp;
+static unsigned int mem[CHUNK_WORDS(SAMPLE_SIZE)];
+static unsigned int test_seed = 1;
+
+
+static double test_noise(void)
+{
+	test_seed = test_seed * 1103515245u + 12345u;
+	return ((test_seed >> 8) & 0xFFFF) / 32768.0 - 1.0;
+}
+
+
+/** speech like talker (noise through a formant, syllables and pauses)
+ *  over a quiet sweep from 100 Hz to 3.9 kHz */
+static short *test_generate(int len)
+{
+	short *pData = calloc(len, sizeof(short));
+	double r = 0.95;
+	double a1 = 2.0 * r * cos(2.0 * M_PI * 700.0 / TEST_RATE);
+	double a2 = -r * r;
+	double y1 = 0.0;
+	double y2 = 0.0;
+	double y;
+	double env = 0.0;
+	double target = 0.0;
+	double phase = 0.0;
+	double value;
+	int left = 0;
+	int on = 0;
+	int count;
+
+	for ( count = 0; len > count; count++ ) {
+		if ( 0 >= left-- ) {
+			on     = !on;
+			left   = (on ? 1200 : 400) + (int) (fabs(test_noise()) * (on ? 2000 : 1600));
+			target = on ? 36000.0 * (0.5 + 0.5 * fabs(test_noise())) : 0.0;
+		}
+		env += 0.005 * (target - env);
+		y    = test_noise() + a1 * y1 + a2 * y2;
+		y2   = y1;
+		y1   = y;
+
+		phase += 2.0 * M_PI * (100.0 + 3800.0 * count / len) / TEST_RATE;
+		value  = env * y * (1.0 - r) + 1000.0 * sin(phase);
+		pData[count] = (short) (32767.0 < value ? 32767 : -32768.0 > value ? -32768 : lrint(value));
+	}
+	return pData;
+}
+
+
+int main(int argc, char *argv[])
+{
+	static const char *pNames[] = { "", "adpcm", "ulaw", "alaw" };
+	chunk_t chunk;
+	const char *pIn = NULL;
+	const char *pOut = NULL;
+	short *pData;
+	short *pDecoded;
+	unsigned int start;
+	double encCycles = 0.0;
+	double decCycles = 0.0;
+	double signal = 1e-3;
+	double noise = 1e-3;
+	double err;
+	double snr;
+	int codec = COMPRESSION_CODEC_ADPCM;
+	int ms = SAMPLE_SIZE / 16;
+	int samples;
+	int rate = TEST_RATE;
+	int coded = 0;
+	int chunks = 0;
+	int errors = 0;
+	int len;
+	int pos;
+	int count;
+
+	for ( count = 1; argc > count; count++ ) {
+		if ( 0 == strcmp(argv[count], "-c") && argc > count + 1 ) {
+			for ( codec = COMPRESSION_CODEC_ALAW; COMPRESSION_CODEC_ADPCM <= codec; codec-- ) {
+				if ( 0 == strcmp(argv[count + 1], pNames[codec]) ) {
+					break;
+				}
+			}
+			count++;
+		} else if ( 0 == strcmp(argv[count], "-f") && argc > count + 1 ) {
+			ms = atoi(argv[++count]);
+		} else if ( '-' != argv[count][0] && NULL == pIn ) {
+			pIn = argv[count];
+		} else if ( '-' != argv[count][0] && NULL == pOut ) {
+			pOut = argv[count];
+		} else {
+			codec = 0;
+			break;
+		}
+	}
+	samples = ms * (TEST_RATE / 1000);
+	if ( COMPRESSION_CODEC_ADPCM > codec || 0 >= ms || SAMPLE_SIZE < samples * 2 ) {
+		fprintf(stderr, "usage: codectest [-c adpcm|ulaw|alaw] [-f <ms>, up to %d] [<in.wav> [<out.wav>]]\n",
+		        SAMPLE_SIZE / 16);
+		return 1;
+	}
+
+	if ( NULL != pIn ) {
+		pData = wav_read(pIn, &rate, &len);
+		if ( NULL == pData ) {
+			return 1;
+		}
+		if ( TEST_RATE != rate ) {
+			fprintf(stderr, "%s: %d Hz, taken as %d Hz\n", pIn, rate, TEST_RATE);
+		}
+	} else {
+		len   = TEST_SECONDS * TEST_RATE;
+		pData = test_generate(len);
+	}
+	len -= len % samples;
+	pDecoded = calloc(len + 1, sizeof(short));
+
+	compression_init(&comp);
+	compression_setCodec(&comp, codec);
+	decompression_init(&decomp);
+	chunk_init(&chunk, mem, SAMPLE_SIZE);
+
+	for ( pos = 0; len > pos; pos += samples ) {
+		for ( count = 0; samples > count; count++ ) {
+			chunk.s16_buff[count] = pData[pos + count];
+		}
+		chunk.len = samples * 2;
+
+		start      = cycles_read();
+		errors    += PASS != compressData(&comp, &chunk);
+		encCycles += cycles_read() - start;
+		coded     += chunk.len;
+
+		start      = cycles_read();
+		errors    += PASS != decompressData(&decomp, &chunk);
+		decCycles += cycles_read() - start;
+		errors    += samples * 2 != chunk.len;
+
+		for ( count = 0; samples > count; count++ ) {
+			pDecoded[pos + count] = chunk.s16_buff[count];
+		}
+		chunks++;
+	}
+
+	for ( count = 0; len > count; count++ ) {
+		err     = pDecoded[count] - pData[count];
+		signal += (double) pData[count] * pData[count];
+		noise  += err * err;
+	}
+	snr = 10.0 * log10(signal / noise);
+
+	printf("%s, %d ms chunks: %d chunks, %d bytes coded per chunk of %d (%.2f:1)\n",
+	       pNames[codec], ms, chunks, chunks ? coded / chunks : 0, samples * 2,
+	       coded ? (double) chunks * samples * 2 / coded : 0.0);
+	printf("  SNR %.1f dB | encode %.0f, decode %.0f cycles/chunk | %d errors\n",
+	       snr, chunks ? encCycles / chunks : 0.0, chunks ? decCycles / chunks : 0.0, errors);
+
+	if ( NULL != pOut && PASS != wav_write(pOut, rate, pDecoded, len) ) {
+		errors++;
+	}
+	free(pData);
+	free(pDecoded);
+
+	if ( 0 != errors || (COMPRESSION_CODEC_ADPCM == codec ? TEST_SNR_ADPCM : TEST_SNR_G711) > snr ) {
+		printf("FAIL\n");
+		return 1;
+	}
+	printf("PASS\n");
+	return 0;
+}
@@ -0,0 +1,206 @@
+/**
+ *@file copybench.c
+ *
+ *@brief
+ *  - host benchmark of the chunk copy engine: the byte loop chunk_copy()
+ *    used to be, the word copy it is now (src/chunk.c) and the memory
+ *    DMA copy (src/chunkDma.c), for every fill level of a chunk
+ *
+ *  copybench       fill levels 0..8, the frame sizes and a few odd ones
+ *  copybench -a    every fill level, 0..SAMPLE_SIZE bytes
+ *
+ *  Every fill level is checked: the data copied, the length set, the
+ *  bytes past it left alone; the figures averaged over all levels are
+ *  printed at the end. A chunk too long for the destination has to be
+ *  refused.
+ *
+ *  The memory DMA runs on a model of the registers (sim/simMdma.c),
+ *  so for it the figure is what the core spends: starting the copy
+ *  (and the 1..3 tail bytes) plus the poll that sees it done. The
+ *  engine time is an estimate, one 32 bit word per system clock
+ *  (BENCH_SCLK_RATIO core cycles), during which the core is free.
+ *
+ *  Cycles are the host monotonic clock at 600 MHz (cycles.h), best of
+ *  BENCH_RUNS, an estimate only; the tools are built without auto
+ *  vectorization, the Blackfin has no vector unit to copy with.
+ *
+ *******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "tll_common.h"
+#include "chunk.h"
+#include "chunkDma.h"
+#include "cycles.h"
+#include <tll_config.h>
+
+/**
+ * @def BENCH_RUNS
+ * @brief runs per fill level, the fastest is taken
+ */
+#define BENCH_RUNS	(200)
+
+/**
+ * @def BENCH_SCLK_RATIO
+ * @brief core cycles per system clock, 600 / 120 MHz
+ */
+#define BENCH_SCLK_RATIO	(5)
+
+/**
+ * @def BENCH_GUARD
+ * @brief pattern past the copied length, must survive the copy
+ */
+#define BENCH_GUARD	(0xA5)
+
+static unsigned int srcMem[CHUNK_WORDS(SAMPLE_SIZE)];
+static unsigned int dstMem[CHUNK_WORDS(SAMPLE_SIZE)];
+static chunk_t src;
+static chunk_t dst;
+static chunkDma_t chunkDma;
+
+
+/** chunk_copy() as it was: one byte at a time */
+static int bench_byteCopy(chunk_t *pSrc, chunk_t *pDst)
+{
+	unsigned int count;
+	unsigned int len = pSrc->len;
+
+	for ( count = 0; len > count; count++ ) {
+		pDst->u08_buff[count] = pSrc->u08_buff[count];
+	}
+	pDst->len = pSrc->len;
+
+	return PASS;
+}
+
+
+/** memory DMA copy, blocking: start, let the model run, poll
+ *   only the core's part is counted in *pCycles */
+static int bench_dmaCopy(chunk_t *pSrc, chunk_t *pDst, unsigned int *pCycles)
+{
+	unsigned int start;
+	unsigned int cycles;
+
+	start  = cycles_read();
+	chunkDma_copy(&chunkDma, pSrc, pDst, NULL, NULL);
+	cycles = cycles_read() - start;
+
+	sim_mdma();
+
+	start   = cycles_read();
+	chunkDma_poll(&chunkDma);
+	*pCycles = cycles + (cycles_read() - start);
+
+	return chunkDma_isBusy(&chunkDma) ? FAIL : PASS;
+}
+
+
+/** copy len bytes with one of the methods, best of BENCH_RUNS
+ *   method 0 byte loop, 1 chunk_copy(), 2 memory DMA
+ *
+ * @return cycles, negative if the copy is wrong
+ */
+static int bench_level(int method, int len)
+{
+	unsigned int start;
+	unsigned int cycles;
+	unsigned int best = ~0u;
+	int run;
+	int count;
+
+	src.len = len;
+	for ( run = 0; BENCH_RUNS > run; run++ ) {
+		if ( 0 == run ) {
+			for ( count = 0; SAMPLE_SIZE > count; count++ ) {
+				dst.u08_buff[count] = BENCH_GUARD;
+			}
+			dst.len = -1;
+		}
+
+		if ( 2 == method ) {
+			if ( PASS != bench_dmaCopy(&src, &dst, &cycles) ) {
+				return -1;
+			}
+		} else {
+			start = cycles_read();
+			if ( 0 == method ) {
+				bench_byteCopy(&src, &dst);
+			} else {
+				chunk_copy(&src, &dst);
+			}
+			cycles = cycles_read() - start;
+		}
+		if ( best > cycles ) {
+			best = cycles;
+		}
+
+		if ( 0 == run ) {
+			if ( len != dst.len || 0 != memcmp(src.u08_buff, dst.u08_buff, len) ) {
+				return -1;
+			}
+			for ( count = len; SAMPLE_SIZE > count; count++ ) {
+				if ( BENCH_GUARD != dst.u08_buff[count] ) {
+					return -1;
+				}
+			}
+		}
+	}
+	return (int) best;
+}
+
+
+int main(int argc, char *argv[])
+{
+	static const char *pNames[3] = { "byte loop", "chunk_copy", "MDMA core" };
+	double sum[3] = { 0.0, 0.0, 0.0 };
+	int cycles[3];
+	int all = (2 == argc && 0 == strcmp(argv[1], "-a"));
+	int errors = 0;
+	int method;
+	int len;
+
+	if ( 1 != argc && !all ) {
+		fprintf(stderr, "usage: copybench [-a]\n");
+		return 1;
+	}
+
+	chunk_init(&src, srcMem, SAMPLE_SIZE);
+	chunk_init(&dst, dstMem, SAMPLE_SIZE);
+	chunkDma_init(&chunkDma);
+	for ( len = 0; SAMPLE_SIZE > len; len++ ) {
+		src.u08_buff[len] = (unsigned char) (len * 7 + 1);
+	}
+
+	printf("bytes  %10s %10s %10s %10s   cycles\n", pNames[0], pNames[1], pNames[2], "MDMA engine");
+	for ( len = 0; SAMPLE_SIZE >= len; len++ ) {
+		for ( method = 0; 3 > method; method++ ) {
+			cycles[method] = bench_level(method, len);
+			if ( 0 > cycles[method] ) {
+				printf("%5d  %s: wrong copy\n", len, pNames[method]);
+				errors++;
+				cycles[method] = 0;
+			}
+			sum[method] += cycles[method];
+		}
+
+		if ( all || 8 >= len || 0 == len % 160 || 0 == len % 512 || 1 == len % 511 ) {
+			printf("%5d  %10d %10d %10d %10d\n", len, cycles[0], cycles[1], cycles[2],
+			       len / 4 * BENCH_SCLK_RATIO);
+		}
+	}
+
+	// data that does not fit is refused, the MDMA is left off
+	src.len = SAMPLE_SIZE;
+	dst.size = SAMPLE_SIZE - 1;
+	if ( FAIL != chunk_copy(&src, &dst) || FAIL != chunkDma_copy(&chunkDma, &src, &dst, NULL, NULL)
+	     || 0 != *pMDMA_D0_CONFIG || chunkDma_isBusy(&chunkDma) ) {
+		printf("%5d  into %d bytes: copied\n", SAMPLE_SIZE, dst.size);
+		errors++;
+	}
+	dst.size = SAMPLE_SIZE;
+
+	len = SAMPLE_SIZE + 1;
+	printf("mean   %10.0f %10.0f %10.0f %10.0f   over %d fill levels, %d wrong\n",
+	       sum[0] / len, sum[1] / len, sum[2] / len,
+	       (double) (SAMPLE_SIZE / 2) / 4 * BENCH_SCLK_RATIO, len, errors);
+	return errors ? 1 : 0;
+}
@@ -0,0 +1,307 @@
+/**
+ *@file fpgapack.c
+ *
+ *@brief
+ *  - host tool: packs an FPGA bitstream into the format of fpgaImage.h
+ *    and writes it as a C header
+ *
+ *  fpgapack <bitstream> <header.h> <name>
+ *
+ *  The bitstream is the raw .bin, or a C header holding it as a byte
+ *  array (every 0xNN in the file is taken). The packed image is
+ *  unpacked again with the target decompressor (src/fpgaImage.c),
+ *  block by block, and compared before the header is written.
+ *
+ *  The header defines <name>_lz[] (packed image) and <NAME>_SIZE
+ *  (unpacked bytes).
+ *
+ *******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "tll_common.h"
+#include "fpgaImage.h"
+
+/**
+ * @def PACK_HASH_SIZE
+ * @brief entries of the match finder hash table
+ */
+#define PACK_HASH_SIZE	(1 << 16)
+
+/**
+ * @def PACK_CHAIN_MAX
+ * @brief candidates tried per position
+ */
+#define PACK_CHAIN_MAX	(256)
+
+/**
+ * @def PACK_MATCH_MAX
+ * @brief longest match a token can hold
+ */
+#define PACK_MATCH_MAX	(0x7F + FPGAIMAGE_MATCH_MIN + 0xFFFF)
+
+/**
+ * @def PACK_LITERAL_MAX
+ * @brief longest literal run of a token
+ */
+#define PACK_LITERAL_MAX	(0x80)
+
+/**
+ * @def PACK_BLOCK
+ * @brief block size of the round trip check, as on the target
+ */
+#define PACK_BLOCK	(256)
+
+
+/** growing output buffer */
+typedef struct {
+	unsigned char *pData;
+	size_t len;
+	size_t cap;
+} pack_buf_t;
+
+
+static void pack_put(pack_buf_t *pBuf, unsigned char value)
+{
+	if ( pBuf->len == pBuf->cap ) {
+		pBuf->cap   = pBuf->cap ? 2 * pBuf->cap : 4096;
+		pBuf->pData = realloc(pBuf->pData, pBuf->cap);
+		if ( NULL == pBuf->pData ) {
+			fprintf(stderr, "fpgapack: out of memory\n");
+			exit(1);
+		}
+	}
+	pBuf->pData[pBuf->len++] = value;
+}
+
+
+/** read the whole input, raw or hex bytes of a C header */
+static unsigned char *pack_load(const char *pName, size_t *pLen)
+{
+	FILE *pFile = fopen(pName, "rb");
+	pack_buf_t raw = { NULL, 0, 0 };
+	pack_buf_t bin = { NULL, 0, 0 };
+	size_t count;
+	int c;
+
+	if ( NULL == pFile ) {
+		perror(pName);
+		exit(1);
+	}
+	while ( EOF != (c = fgetc(pFile)) ) {
+		pack_put(&raw, (unsigned char) c);
+	}
+	fclose(pFile);
+
+	count = strlen(pName);
+	if ( 2 > count || 0 != strcmp(&pName[count - 2], ".h") ) {
+		*pLen = raw.len;
+		return raw.pData;
+	}
+
+	for ( count = 0; count + 3 < raw.len; count++ ) {
+		if ( '0' == raw.pData[count] && 'x' == tolower(raw.pData[count + 1])
+		     && isxdigit(raw.pData[count + 2]) && isxdigit(raw.pData[count + 3]) ) {
+			char hex[3] = { (char) raw.pData[count + 2], (char) raw.pData[count + 3], 0 };
+			pack_put(&bin, (unsigned char) strtol(hex, NULL, 16));
+			count += 3;
+		}
+	}
+	free(raw.pData);
+	*pLen = bin.len;
+	return bin.pData;
+}
+
+
+/** emit pending literals */
+static void pack_literals(pack_buf_t *pOut, const unsigned char *pData, size_t start, size_t end)
+{
+	size_t run;
+
+	while ( start < end ) {
+		run = end - start;
+		if ( PACK_LITERAL_MAX < run ) {
+			run = PACK_LITERAL_MAX;
+		}
+		pack_put(pOut, (unsigned char) (run - 1));
+		while ( run-- ) {
+			pack_put(pOut, pData[start++]);
+		}
+	}
+}
+
+
+/** emit a match */
+static void pack_match(pack_buf_t *pOut, size_t len, size_t dist)
+{
+	len -= FPGAIMAGE_MATCH_MIN;
+	if ( 0x7F <= len ) {
+		pack_put(pOut, FPGAIMAGE_MATCH_EXT);
+		pack_put(pOut, (unsigned char) ((len - 0x7F) & 0xFF));
+		pack_put(pOut, (unsigned char) ((len - 0x7F) >> 8));
+	} else {
+		pack_put(pOut, (unsigned char) (0x80 | len));
+	}
+	pack_put(pOut, (unsigned char) ((dist - 1) & 0xFF));
+	pack_put(pOut, (unsigned char) ((dist - 1) >> 8));
+}
+
+
+/** greedy LZ77 over a hash chain match finder */
+static void pack_image(pack_buf_t *pOut, const unsigned char *pData, size_t len)
+{
+	long *pHead = malloc(PACK_HASH_SIZE * sizeof(long));
+	long *pPrev = malloc((len + 1) * sizeof(long));
+	size_t pos = 0;
+	size_t lit = 0;
+	size_t best;
+	size_t bestDist;
+	size_t run;
+	long cand;
+	int chain;
+	unsigned int hash;
+
+	if ( NULL == pHead || NULL == pPrev ) {
+		fprintf(stderr, "fpgapack: out of memory\n");
+		exit(1);
+	}
+	for ( hash = 0; PACK_HASH_SIZE > hash; hash++ ) {
+		pHead[hash] = -1;
+	}
+
+	pack_put(pOut, 'F');
+	pack_put(pOut, 'Z');
+	pack_put(pOut, FPGAIMAGE_VERSION);
+	pack_put(pOut, 0);
+	pack_put(pOut, (unsigned char) (len & 0xFF));
+	pack_put(pOut, (unsigned char) ((len >> 8) & 0xFF));
+	pack_put(pOut, (unsigned char) ((len >> 16) & 0xFF));
+	pack_put(pOut, (unsigned char) (len >> 24));
+
+	while ( pos < len ) {
+		best     = 0;
+		bestDist = 0;
+		if ( pos + FPGAIMAGE_MATCH_MIN <= len ) {
+			hash = ((pData[pos] << 8) ^ (pData[pos + 1] << 4) ^ pData[pos + 2]) & (PACK_HASH_SIZE - 1);
+			for ( cand = pHead[hash], chain = PACK_CHAIN_MAX;
+			      0 <= cand && FPGAIMAGE_WINDOW >= pos - cand && chain--; cand = pPrev[cand] ) {
+				for ( run = 0; pos + run < len && PACK_MATCH_MAX > run
+				      && pData[cand + run] == pData[pos + run]; run++ ) {
+				}
+				if ( run > best ) {
+					best     = run;
+					bestDist = pos - cand;
+				}
+			}
+		}
+
+		if ( FPGAIMAGE_MATCH_MIN > best ) {
+			best = 1;
+		} else {
+			pack_literals(pOut, pData, lit, pos);
+			pack_match(pOut, best, bestDist);
+			lit = pos + best;
+		}
+
+		// every position covered goes into the match finder
+		for ( run = 0; best > run; run++, pos++ ) {
+			if ( pos + FPGAIMAGE_MATCH_MIN <= len ) {
+				hash = ((pData[pos] << 8) ^ (pData[pos + 1] << 4) ^ pData[pos + 2]) & (PACK_HASH_SIZE - 1);
+				pPrev[pos]  = pHead[hash];
+				pHead[hash] = (long) pos;
+			}
+		}
+	}
+	pack_literals(pOut, pData, lit, len);
+
+	free(pHead);
+	free(pPrev);
+}
+
+
+/** unpack with the target decompressor and compare */
+static int pack_verify(const pack_buf_t *pOut, const unsigned char *pData, size_t len)
+{
+	static fpgaImage_t image;
+	unsigned char block[PACK_BLOCK];
+	size_t pos = 0;
+	int count;
+
+	if ( PASS != fpgaImage_init(&image, pOut->pData, (int) pOut->len )
+	     || len != fpgaImage_size(&image) ) {
+		return FAIL;
+	}
+	while ( 0 < (count = fpgaImage_read(&image, block, PACK_BLOCK)) ) {
+		if ( pos + count > len || 0 != memcmp(block, &pData[pos], count) ) {
+			return FAIL;
+		}
+		pos += count;
+	}
+	return 0 == count && pos == len ? PASS : FAIL;
+}
+
+
+/** write the C header */
+static void pack_header(const pack_buf_t *pOut, size_t len, const char *pIn,
+                        const char *pName, const char *pFile)
+{
+	FILE *pHdr = fopen(pFile, "w");
+	char upper[256];
+	size_t count;
+
+	if ( NULL == pHdr ) {
+		perror(pFile);
+		exit(1);
+	}
+	for ( count = 0; pName[count] && sizeof(upper) - 1 > count; count++ ) {
+		upper[count] = (char) toupper((unsigned char) pName[count]);
+	}
+	upper[count] = 0;
+
+	fprintf(pHdr, "/**\n *@file %s\n *\n *@brief\n", strrchr(pFile, '/') ? strrchr(pFile, '/') + 1 : pFile);
+	fprintf(pHdr, " *  - packed FPGA bitstream, unpack with fpgaImage_read (fpgaImage.h)\n");
+	fprintf(pHdr, " *  - generated by tools/fpgapack from %s, do not edit\n", pIn);
+	fprintf(pHdr, " *\n *******************************************************************************/\n");
+	fprintf(pHdr, "#ifndef %s_H\n#define %s_H\n\n", upper, upper);
+	fprintf(pHdr, "/**\n * @def %s_SIZE\n * @brief bytes of the unpacked bitstream\n */\n", upper);
+	fprintf(pHdr, "#define %s_SIZE\t(%lu)\n\n", upper, (unsigned long) len);
+	fprintf(pHdr, "/** packed bitstream, %lu bytes */\n", (unsigned long) pOut->len);
+	fprintf(pHdr, "static const unsigned char %s_lz[] = {", pName);
+	for ( count = 0; pOut->len > count; count++ ) {
+		fprintf(pHdr, "%s0x%02x,", 0 == count % 12 ? "\n    " : " ", pOut->pData[count]);
+	}
+	fprintf(pHdr, "\n};\n\n#endif\n");
+	fclose(pHdr);
+}
+
+
+int main(int argc, char *argv[])
+{
+	pack_buf_t out = { NULL, 0, 0 };
+	unsigned char *pData;
+	size_t len;
+
+	if ( 4 != argc ) {
+		fprintf(stderr, "usage: fpgapack <bitstream.bin|header.h> <out.h> <name>\n");
+		return 1;
+	}
+
+	pData = pack_load(argv[1], &len);
+	if ( 0 == len ) {
+		fprintf(stderr, "fpgapack: %s is empty\n", argv[1]);
+		return 1;
+	}
+	pack_image(&out, pData, len);
+
+	if ( PASS != pack_verify(&out, pData, len) ) {
+		fprintf(stderr, "fpgapack: round trip failed\n");
+		return 1;
+	}
+	pack_header(&out, len, argv[1], argv[3], argv[2]);
+	printf("fpgapack: %lu -> %lu bytes, round trip ok\n", (unsigned long) len, (unsigned long) out.len);
+
+	free(pData);
+	free(out.pData);
+	return 0;
+}
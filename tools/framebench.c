@@ -0,0 +1,195 @@
+/**
+ *@file framebench.c
+ *
+ *@brief
+ *  - host benchmark of the frame durations: the latency the player
+ *    measures, not a formula; each duration runs the whole player on
+ *    the simulated board (sim.h) over the UART loopback in latency
+ *    mode, with the generated talker as capture
+ *
+ *  framebench [-c adpcm|ulaw|alaw] [-v]
+ *
+ *  -c  codec on the link, ADPCM by default
+ *  -v  keep the output of the player
+ *
+ *  The figures are the latency_t histograms of the run: one way is
+ *  capture to playback start (audio TX records it as a stamped chunk
+ *  starts playing), round trip is the link alone (frame sent to its
+ *  echo received). Both start with the run, the jitter buffer filling
+ *  included. A run is shorter than the report period of the player,
+ *  which restarts the histograms. The underruns and drops of the run
+ *  are printed with them, a run that lost frames is not a latency
+ *  figure.
+ *
+ *  The CPU load is the main loop's share of the run, 100 % minus the
+ *  idle fraction of event_t (ISRs run inside idle, as on the board),
+ *  also given as cycles per frame. Those are host cycles (cycles.h),
+ *  so compare the settings with each other; the target figures are
+ *  in the player's reports built with PROFILE_ENABLE.
+ *
+ *  The simulation runs in real time, BENCH_MS per duration.
+ *
+ *******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "tll_common.h"
+#include "audioPlayer.h"
+#include "sim.h"
+#include "cycles.h"
+
+/**
+ * @def BENCH_MS
+ * @brief run per frame duration [ms], below the report period of the
+ * player (AP_REPORT_MS, 10 s)
+ */
+#define BENCH_MS	(6000)
+
+/**
+ * @var audioPlayer
+ * @brief  global audio player object, as in main.c
+ */
+audioPlayer_t	audioPlayer;
+
+
+/** count, mean and range of a histogram [ms]
+ *
+ * @return void
+ */
+static void bench_hist(const latency_hist_t *pHist)
+{
+	if ( 0 == pHist->count ) {
+		printf("  %5s %7s %7s %7s", "0", "-", "-", "-");
+		return;
+	}
+	printf("  %5u %7.1f %7.1f %7.1f", pHist->count,
+	       pHist->min / (double) CYCLES_PER_MS,
+	       (double) pHist->sum / pHist->count / CYCLES_PER_MS,
+	       pHist->max / (double) CYCLES_PER_MS);
+}
+
+
+/** main loop load of the run [0.01 %] and cycles per frame
+ *   against the run's own duration: event_t counts its cycles up to the
+ *   last return of event_wait, the run ends inside the idle of the next
+ *
+ * @return void
+ */
+static void bench_load(const event_stats_t *pStats, unsigned int runCycles, int frameMs)
+{
+	unsigned long long busy = 0;
+	int load = 0;
+
+	if ( runCycles > pStats->idleCycles ) {
+		busy = runCycles - pStats->idleCycles;
+		load = (int) (busy * 10000 / runCycles);
+	}
+	printf("  %3d.%02d %9u", load / 100, load % 100, (unsigned int) (busy * frameMs / BENCH_MS));
+}
+
+
+/** dropped frames of a path, all reasons
+ *
+ * @return number of frames dropped
+ */
+static unsigned int bench_drops(const telemetry_t *pStats)
+{
+	unsigned int drops = 0;
+	int count;
+
+	for ( count = 0; TELEMETRY_DROP_NUM > count; count++ ) {
+		drops += pStats->drops[count];
+	}
+	return drops;
+}
+
+
+int main(int argc, char *argv[])
+{
+	static const int frameMs[] = { 10, 20, 40, 128 };
+	static const char *pCodecs[] = { "", "adpcm", "ulaw", "alaw" };
+	audioPlayer_telemetry_t snap;
+	sim_run_t run;
+	unsigned int runCycles;
+	int codec = COMPRESSION_CODEC_ADPCM;
+	int verbose = 0;
+	int stdoutFd = -1;
+	int nullFd;
+	int setting;
+	int count;
+
+	for ( count = 1; argc > count; count++ ) {
+		if ( 0 == strcmp(argv[count], "-v") ) {
+			verbose = 1;
+		} else if ( 0 == strcmp(argv[count], "-c") && argc > count + 1 ) {
+			count++;
+			for ( codec = COMPRESSION_CODEC_ALAW; COMPRESSION_CODEC_ADPCM <= codec; codec-- ) {
+				if ( 0 == strcmp(argv[count], pCodecs[codec]) ) {
+					break;
+				}
+			}
+		} else {
+			codec = 0;
+		}
+		if ( COMPRESSION_CODEC_ADPCM > codec ) {
+			fprintf(stderr, "usage: framebench [-c adpcm|ulaw|alaw] [-v]\n");
+			return 1;
+		}
+	}
+
+	run.inLen  = BENCH_MS * SIM_RATE / 1000;
+	run.pIn    = sim_talker(run.inLen);
+	run.outMax = 0;
+	run.pOut   = NULL;
+	if ( NULL == run.pIn || PASS != sim_init(NULL) ) {
+		return 1;
+	}
+
+	printf("%s, %d ms per frame duration, latency [ms] against CPU load\n", pCodecs[codec], BENCH_MS);
+	printf("%6s  %-29s  %-29s\n", "", "one way", "round trip");
+	printf("frame   %5s %7s %7s %7s  %5s %7s %7s %7s   cpu %% cyc/frame  underruns drops\n",
+	       "n", "min", "mean", "max", "n", "min", "mean", "max");
+	for ( setting = 0; sizeof(frameMs) / sizeof(frameMs[0]) > setting; setting++ ) {
+		if ( !verbose ) {
+			fflush(stdout);
+			stdoutFd = dup(STDOUT_FILENO);
+			nullFd   = open("/dev/null", O_WRONLY);
+			dup2(nullFd, STDOUT_FILENO);
+			close(nullFd);
+		}
+
+		sim_reset();
+		if ( PASS != audioPlayer_init(&audioPlayer)
+		     || PASS != audioPlayer_setFrameDuration(&audioPlayer, frameMs[setting])
+		     || PASS != audioPlayer_setCodec(&audioPlayer, codec) ) {
+			return 1;
+		}
+		audioPlayer_setLatencyMode(&audioPlayer, 1);
+		if ( PASS != audioPlayer_start(&audioPlayer) ) {
+			return 1;
+		}
+		runCycles = cycles_read();
+		sim_run(&run, &audioPlayer, BENCH_MS);
+		runCycles = cycles_read() - runCycles;
+		audioPlayer_telemetrySnapshot(&audioPlayer, &snap);
+
+		if ( !verbose ) {
+			fflush(stdout);
+			dup2(stdoutFd, STDOUT_FILENO);
+			close(stdoutFd);
+		}
+
+		printf("%3d ms", frameMs[setting]);
+		bench_hist(&audioPlayer.tx.latency);
+		bench_hist(&audioPlayer.latency.rtt);
+		bench_load(&audioPlayer.event.stats, runCycles, frameMs[setting]);
+		printf("  %9u %5u\n", snap.audioTx.underruns,
+		       bench_drops(&snap.audioRx) + bench_drops(&snap.uartTx)
+		       + bench_drops(&snap.uartRx) + bench_drops(&snap.audioTx));
+	}
+
+	free((void *) run.pIn);
+	return 0;
+}
@@ -0,0 +1,290 @@
+/**
+ *@file nsbench.c
+ *
+ *@brief
+ *  - host benchmark of the noise suppressor (src/ns.c): SNR before and
+ *    after, noise left in the speech pauses, cycles per frame
+ *
+ *  nsbench                          generated scenarios
+ *  nsbench <clean.raw> <noisy.raw>  a recording, 16 bit little endian
+ *                                   8 kHz mono, the clean speech and
+ *                                   the same with noise, sample aligned
+ *
+ *  The generated scenarios mix a speech like talker (shaped noise,
+ *  syllable envelope) with white noise and with shop floor noise (low
+ *  rumble, mains hum and harmonics, a machine whine), at 0 to 20 dB
+ *  SNR. The first 2 s are left out of the figures, the noise estimate
+ *  settles in 1.5 s. The output is compared NS_FFT samples late (the
+ *  delay of the suppressor).
+ *
+ *  Cycles are the host monotonic clock at 600 MHz (cycles.h), an
+ *  estimate only: the target figure is the "ns" stage of the profile
+ *  (PROFILE_ENABLE), per chunk.
+ *
+ *******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "tll_common.h"
+#include "ns.h"
+#include "cycles.h"
+
+/**
+ * @def BENCH_RATE
+ * @brief samples per second
+ */
+#define BENCH_RATE	(8000)
+
+/**
+ * @def BENCH_CHUNK
+ * @brief samples per chunk, 20 ms
+ */
+#define BENCH_CHUNK	(160)
+
+/**
+ * @def BENCH_SECONDS
+ * @brief length of a generated scenario
+ */
+#define BENCH_SECONDS	(12)
+
+/**
+ * @def BENCH_SKIP
+ * @brief samples left out of the figures
+ */
+#define BENCH_SKIP	(2 * BENCH_RATE)
+
+static ns_t ns;
+static unsigned int bench_seed = 1;
+
+
+static double bench_noise(void)
+{
+	bench_seed = bench_seed * 1103515245u + 12345u;
+	return ((bench_seed >> 8) & 0xFFFF) / 32768.0 - 1.0;
+}
+
+
+static short bench_sat(double value)
+{
+	if ( 32767.0 < value ) {
+		return 32767;
+	} else if ( -32768.0 > value ) {
+		return -32768;
+	}
+	return (short) lrint(value);
+}
+
+
+/** speech like signal: noise through a two pole resonance, syllables
+ *  of 150..400 ms with pauses of 50..250 ms */
+static void bench_talker(double *pOut, int len, double formant, double level)
+{
+	double r = 0.95;
+	double a1 = 2.0 * r * cos(2.0 * M_PI * formant / BENCH_RATE);
+	double a2 = -r * r;
+	double y1 = 0.0;
+	double y2 = 0.0;
+	double env = 0.0;
+	double target = 0.0;
+	int left = 0;
+	int on = 0;
+	int count;
+
+	for ( count = 0; len > count; count++ ) {
+		if ( 0 >= left-- ) {
+			on     = !on;
+			left   = (on ? 1200 : 400) + (int) (fabs(bench_noise()) * (on ? 2000 : 1600));
+			target = on ? level * (0.5 + 0.5 * fabs(bench_noise())) : 0.0;
+		}
+		env += 0.005 * (target - env);
+		double y = bench_noise() + a1 * y1 + a2 * y2;
+		y2 = y1;
+		y1 = y;
+		pOut[count] = env * y * (1.0 - r);
+	}
+}
+
+
+/** noise: white, or shop floor (rumble, 50 Hz hum and harmonics,
+ *  machine whine) */
+static void bench_background(double *pOut, int len, int shop)
+{
+	double rumble = 0.0;
+	double t;
+	int count;
+
+	for ( count = 0; len > count; count++ ) {
+		if ( !shop ) {
+			pOut[count] = bench_noise();
+			continue;
+		}
+		t       = (double) count / BENCH_RATE;
+		rumble  = 0.98 * rumble + 0.2 * bench_noise();
+		pOut[count] = rumble + 0.3 * bench_noise()
+		              + 0.4 * sin(2.0 * M_PI * 50.0 * t) + 0.2 * sin(2.0 * M_PI * 150.0 * t)
+		              + 0.1 * sin(2.0 * M_PI * 1230.0 * t);
+	}
+}
+
+
+/** energy of a signal over [BENCH_SKIP, len) */
+static double bench_energy(const double *pSig, int len)
+{
+	double sum = 1e-3;
+	int count;
+
+	for ( count = BENCH_SKIP; len > count; count++ ) {
+		sum += pSig[count] * pSig[count];
+	}
+	return sum;
+}
+
+
+/** run the suppressor over the noisy signal, print the figures
+ *   pClean is the speech alone, pNoisy speech and noise, both as PCM */
+static void bench_run(const char *pName, const double *pClean, const short *pNoisy, int len)
+{
+	static unsigned int mem[CHUNK_WORDS(BENCH_CHUNK * 2)];
+	double *pOut = calloc(len, sizeof(double));
+	chunk_t chunk;
+	unsigned int start;
+	double cycles = 0.0;
+	double err;
+	double errIn = 1e-3;
+	double errOut = 1e-3;
+	double pauseIn = 1e-3;
+	double pauseOut = 1e-3;
+	double speech;
+	int pos;
+	int count;
+
+	ns_init(&ns);
+	chunk_init(&chunk, mem, BENCH_CHUNK * 2);
+	len -= len % BENCH_CHUNK;
+
+	for ( pos = 0; len > pos; pos += BENCH_CHUNK ) {
+		for ( count = 0; BENCH_CHUNK > count; count++ ) {
+			chunk.s16_buff[count] = pNoisy[pos + count];
+		}
+		chunk.len = BENCH_CHUNK * 2;
+
+		start   = cycles_read();
+		ns_process(&ns, &chunk);
+		cycles += cycles_read() - start;
+
+		for ( count = 0; BENCH_CHUNK > count; count++ ) {
+			pOut[pos + count] = chunk.s16_buff[count];
+		}
+	}
+
+	// output NS_FFT late; pauses: no speech within a frame
+	for ( count = BENCH_SKIP; len - NS_FFT > count; count++ ) {
+		err     = pNoisy[count] - pClean[count];
+		errIn  += err * err;
+		err     = pOut[count + NS_FFT] - pClean[count];
+		errOut += err * err;
+		if ( 1.0 > fabs(pClean[count]) ) {
+			pauseIn  += (double) pNoisy[count] * pNoisy[count];
+			pauseOut += pOut[count + NS_FFT] * pOut[count + NS_FFT];
+		}
+	}
+	speech = bench_energy(pClean, len - NS_FFT);
+
+	printf("%-22s SNR in %5.1f out %5.1f (%+5.1f) dB, pauses %+6.1f dB | %5.0f cycles/frame\n",
+	       pName, 10.0 * log10(speech / errIn), 10.0 * log10(speech / errOut),
+	       10.0 * log10(errIn / errOut), 10.0 * log10(pauseOut / pauseIn),
+	       ns.count ? cycles / ns.count : 0.0);
+	free(pOut);
+}
+
+
+/** generated scenario, noise scaled to the SNR asked for */
+static void bench_scenario(int shop, double snr)
+{
+	int len = BENCH_SECONDS * BENCH_RATE;
+	double *pClean = calloc(len, sizeof(double));
+	double *pNoise = calloc(len, sizeof(double));
+	short *pNoisy  = calloc(len, sizeof(short));
+	char name[32];
+	double gain;
+	int count;
+
+	bench_seed = 1;
+	bench_talker(pClean, len, 700.0, 36000.0);
+	bench_background(pNoise, len, shop);
+	gain = sqrt(bench_energy(pClean, len) / bench_energy(pNoise, len) / pow(10.0, snr / 10.0));
+	for ( count = 0; len > count; count++ ) {
+		pClean[count] = bench_sat(pClean[count]);
+		pNoisy[count] = bench_sat(pClean[count] + gain * pNoise[count]);
+	}
+
+	snprintf(name, sizeof(name), "%s, %2.0f dB", shop ? "shop floor" : "white", snr);
+	bench_run(name, pClean, pNoisy, len);
+
+	free(pClean);
+	free(pNoise);
+	free(pNoisy);
+}
+
+
+/** read a raw 16 bit file */
+static short *bench_load(const char *pName, int *pLen)
+{
+	FILE *pFile = fopen(pName, "rb");
+	short *pData;
+	long size;
+
+	if ( NULL == pFile ) {
+		perror(pName);
+		exit(1);
+	}
+	fseek(pFile, 0, SEEK_END);
+	size = ftell(pFile) / 2;
+	fseek(pFile, 0, SEEK_SET);
+	pData = calloc(size ? size : 1, sizeof(short));
+	*pLen = (int) fread(pData, sizeof(short), size, pFile);
+	fclose(pFile);
+	return pData;
+}
+
+
+int main(int argc, char *argv[])
+{
+	static const double snr[] = { 0.0, 5.0, 10.0, 20.0 };
+	double *pClean;
+	short *pRaw;
+	short *pNoisy;
+	int len;
+	int noisyLen;
+	int count;
+
+	if ( 3 == argc ) {
+		pRaw   = bench_load(argv[1], &len);
+		pNoisy = bench_load(argv[2], &noisyLen);
+		if ( noisyLen < len ) {
+			len = noisyLen;
+		}
+		pClean = calloc(len + 1, sizeof(double));
+		for ( count = 0; len > count; count++ ) {
+			pClean[count] = pRaw[count];
+		}
+		bench_run(argv[2], pClean, pNoisy, len);
+		free(pRaw);
+		free(pNoisy);
+		free(pClean);
+		return 0;
+	}
+	if ( 1 != argc ) {
+		fprintf(stderr, "usage: nsbench [<clean.raw> <noisy.raw>]\n");
+		return 1;
+	}
+
+	printf("ns: frames of %d, hop %d, %d bins\n", NS_FFT, NS_HOP, NS_BINS);
+	for ( count = 0; 4 > count; count++ ) {
+		bench_scenario(0, snr[count]);
+	}
+	for ( count = 0; 4 > count; count++ ) {
+		bench_scenario(1, snr[count]);
+	}
+	return 0;
+}
@@ -0,0 +1,253 @@
+/**
+ *@file ringbench.c
+ *
+ *@brief
+ *  - host stress test and benchmark of the SPSC ring (src/spscRing.c)
+ *    between an ISR and the main loop
+ *
+ *  ringbench
+ *
+ *  burst  the ring is filled and drained in pseudo random bursts of up
+ *         to two ring sizes, starting just below the wrap of its
+ *         indices
+ *  isr    the producer is a signal handler (SIGALRM every
+ *         BENCH_TICK_US) putting bursts, the main loop drains the ring
+ *         as the player does; the handler interrupts it anywhere
+ *  cost   put/get pair, SPSC ring against queue_t (the host stand-in
+ *         of sim/)
+ *
+ *  In both stress tests every item has to come out exactly once and in
+ *  order, a put may only fail on a full ring and a get only on an
+ *  empty one. Run for the depth of the player queues and for
+ *  SPSCRING_SIZE_MAX.
+ *
+ *  Cycles are the host monotonic clock at 600 MHz (cycles.h), best of
+ *  BENCH_RUNS, an estimate only. Built with TLL_SIM, the queue_t
+ *  stand-in masks the timer signal around each put and get as the
+ *  board queue masks interrupts; on the host that is a system call per
+ *  critical section, far more than cli/sti on the Blackfin, so the
+ *  figure shows that queue_t pays for masking, not how much.
+ *
+ *******************************************************************************/
+#include <stdio.h>
+#include <signal.h>
+#include <sys/time.h>
+#include "tll_common.h"
+#include "spscRing.h"
+#include "queue.h"
+#include "cycles.h"
+
+/**
+ * @def BENCH_ITEMS
+ * @brief distinct items, a power of two
+ */
+#define BENCH_ITEMS	(1024)
+
+/**
+ * @def BENCH_STRESS
+ * @brief items passed through the ring per stress test
+ */
+#define BENCH_STRESS	(BENCH_ITEMS * 256)
+
+/**
+ * @def BENCH_TICK_US
+ * @brief period of the producer signal [us]
+ */
+#define BENCH_TICK_US	(20)
+
+/**
+ * @def BENCH_RUNS
+ * @brief runs of the cost loop, the fastest is taken
+ */
+#define BENCH_RUNS	(20)
+
+/**
+ * @def BENCH_DEPTH
+ * @brief depth of the player queues (AUDIORX_QUEUE_DEPTH,
+ * UARTTX_QUEUE_DEPTH)
+ */
+#define BENCH_DEPTH	(8)
+
+static char item[BENCH_ITEMS];
+static spscRing_t ring;
+static queue_t queue;
+
+/* producer side of the isr test, the signal handler only */
+static volatile int isrPut;
+static volatile int isrErrors;
+static unsigned int isrSeed;
+
+
+/** next pseudo random number */
+static unsigned int bench_rand(unsigned int *pSeed)
+{
+	*pSeed = *pSeed * 1664525 + 1013904223;
+	return *pSeed;
+}
+
+
+/** burst stress from the wrap of the indices
+ *
+ * @return errors
+ */
+static int bench_burst(unsigned int size)
+{
+	void *pItem = NULL;
+	unsigned int seed = 1;
+	int put = 0;
+	int get = 0;
+	int errors = 0;
+	int burst;
+	int count;
+
+	spscRing_init(&ring, size);
+	ring.head = ring.tail = 0xFFFFFFF0;
+
+	while ( BENCH_STRESS > get ) {
+		burst = (bench_rand(&seed) >> 24) % (2 * size + 1);
+		for ( count = 0; burst > count; count++ ) {
+			if ( PASS == spscRing_put(&ring, &item[put & (BENCH_ITEMS - 1)]) ) {
+				put++;
+			} else if ( (int) size != put - get ) {
+				errors++;
+			}
+		}
+		burst = (seed >> 16) % (2 * size + 1);
+		for ( count = 0; burst > count; count++ ) {
+			if ( PASS == spscRing_get(&ring, &pItem) ) {
+				if ( pItem != &item[get & (BENCH_ITEMS - 1)] ) {
+					errors++;
+				}
+				get++;
+			} else if ( put != get ) {
+				errors++;
+			}
+		}
+		if ( (unsigned int) (put - get) != spscRing_count(&ring) ) {
+			errors++;
+		}
+	}
+	return errors;
+}
+
+
+/** producer of the isr test: a burst of puts per signal
+ *   a put may fail on a full ring only, the consumer can only have
+ *   taken items, never added */
+static void bench_producer(int sig)
+{
+	int burst = (bench_rand(&isrSeed) >> 24) % (2 * ring.size + 1);
+	int count;
+
+	(void) sig;
+	for ( count = 0; burst > count; count++ ) {
+		if ( PASS == spscRing_put(&ring, &item[isrPut & (BENCH_ITEMS - 1)]) ) {
+			isrPut++;
+		} else if ( ring.size != spscRing_count(&ring) ) {
+			isrErrors++;
+		}
+	}
+}
+
+
+/** ISR to main loop stress from the wrap of the indices
+ *
+ * @return errors
+ */
+static int bench_isr(unsigned int size)
+{
+	struct itimerval timer;
+	struct sigaction action;
+	void *pItem = NULL;
+	int get = 0;
+	int errors = 0;
+
+	spscRing_init(&ring, size);
+	ring.head = ring.tail = 0xFFFFFFF0;
+	isrPut    = 0;
+	isrErrors = 0;
+	isrSeed   = 1;
+
+	action.sa_handler = bench_producer;
+	action.sa_flags   = SA_RESTART;
+	sigemptyset(&action.sa_mask);
+	sigaction(SIGALRM, &action, NULL);
+	timer.it_interval.tv_sec  = 0;
+	timer.it_interval.tv_usec = BENCH_TICK_US;
+	timer.it_value            = timer.it_interval;
+	setitimer(ITIMER_REAL, &timer, NULL);
+
+	while ( BENCH_STRESS > get ) {
+		if ( PASS == spscRing_get(&ring, &pItem) ) {
+			if ( pItem != &item[get & (BENCH_ITEMS - 1)] ) {
+				errors++;
+			}
+			get++;
+		}
+		if ( isrPut - get > (int) size || isrPut < get ) {
+			errors++;
+		}
+	}
+
+	timer.it_value.tv_sec  = 0;
+	timer.it_value.tv_usec = 0;
+	setitimer(ITIMER_REAL, &timer, NULL);
+	return errors + isrErrors;
+}
+
+
+/** cycles of a put/get pair, ring (0) or queue_t (1), best of BENCH_RUNS */
+static unsigned int bench_cost(int method, unsigned int size)
+{
+	void *pItem = NULL;
+	unsigned int start;
+	unsigned int cycles;
+	unsigned int best = ~0u;
+	int run;
+	int count;
+
+	spscRing_init(&ring, size);
+	queue_init(&queue, size);
+	for ( run = 0; BENCH_RUNS > run; run++ ) {
+		start = cycles_read();
+		if ( 0 == method ) {
+			for ( count = 0; BENCH_ITEMS > count; count++ ) {
+				spscRing_put(&ring, &item[count]);
+				spscRing_get(&ring, &pItem);
+			}
+		} else {
+			for ( count = 0; BENCH_ITEMS > count; count++ ) {
+				queue_put(&queue, &item[count]);
+				queue_get(&queue, &pItem);
+			}
+		}
+		cycles = cycles_read() - start;
+		if ( best > cycles ) {
+			best = cycles;
+		}
+	}
+	return best / BENCH_ITEMS;
+}
+
+
+int main(void)
+{
+	static const unsigned int sizes[] = { BENCH_DEPTH, SPSCRING_SIZE_MAX };
+	int failed = 0;
+	int errors;
+	int setting;
+
+	for ( setting = 0; sizeof(sizes) / sizeof(sizes[0]) > setting; setting++ ) {
+		errors  = bench_burst(sizes[setting]);
+		failed |= errors;
+		printf("depth %2u  burst: %d items, %d errors\n", sizes[setting], BENCH_STRESS, errors);
+
+		errors  = bench_isr(sizes[setting]);
+		failed |= errors;
+		printf("depth %2u  isr:   %d items, %d errors\n", sizes[setting], BENCH_STRESS, errors);
+
+		printf("depth %2u  put/get pair: spsc ring %u cycles, queue_t %u cycles\n", sizes[setting],
+		       bench_cost(0, sizes[setting]), bench_cost(1, sizes[setting]));
+	}
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,14 @@
+/**
+ *@file bf52xI2cMaster.h
+ *
+ *@brief
+ *  - host stand-in for the TWI driver of the board library, no I2C
+ *
+ *******************************************************************************/
+#ifndef _BF52XI2CMASTER_H_
+#define _BF52XI2CMASTER_H_
+
+/** Initialize the TWI as I2C master, does nothing */
+void bf52xI2cMaster_init(int port, int clock);
+
+#endif
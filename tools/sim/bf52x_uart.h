@@ -0,0 +1,14 @@
+/**
+ *@file bf52x_uart.h
+ *
+ *@brief
+ *  - host stand-in for the UART header of the board library: UART1 is
+ *    a model in simHw.c, its registers are in tll_config.h
+ *
+ *******************************************************************************/
+#ifndef _BF52X_UART_H_
+#define _BF52X_UART_H_
+
+#include <tll_config.h>
+
+#endif
@@ -0,0 +1,20 @@
+/**
+ *@file extio.h
+ *
+ *@brief
+ *  - host stand-in for the extension I/O driver of the board library,
+ *    no LEDs or buttons
+ *
+ *******************************************************************************/
+#ifndef _EXTIO_H_
+#define _EXTIO_H_
+
+#include "isrDisp.h"
+
+/** Initialize the extension I/O, does nothing
+ *
+ * @return Zero on success.
+ */
+int extio_init(isrDisp_t *pIsrDisp);
+
+#endif
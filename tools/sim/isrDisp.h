@@ -0,0 +1,49 @@
+/**
+ *@file isrDisp.h
+ *
+ *@brief
+ *  - host stand-in for the interrupt dispatcher of the board library:
+ *    the peripheral models of simHw.c call the registered callback
+ *    where the hardware would raise the interrupt
+ *
+ *******************************************************************************/
+#ifndef _ISRDISP_H_
+#define _ISRDISP_H_
+
+/** interrupts the audio player registers for */
+typedef enum {
+  ISR_DMA3_SPORT0_RX,
+  ISR_DMA4_SPORT0_TX,
+  ISR_DMA10_UART1_RX,
+  ISR_DMA11_UART1_TX,
+  ISR_NUM
+} isrDisp_irq_t;
+
+/** an interrupt handler and its argument */
+typedef struct {
+  void  (*callback)(void *pArg);
+  void  *pArg;
+} isrDisp_entry_t;
+
+/** dispatcher object
+ */
+typedef struct {
+  isrDisp_entry_t  entry[ISR_NUM];
+} isrDisp_t;
+
+/** Initialize the dispatcher, no handler registered
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int isrDisp_init(isrDisp_t *pThis);
+
+/** register the handler of an interrupt
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int isrDisp_registerCallback(isrDisp_t *pThis, isrDisp_irq_t irq,
+                             void (*callback)(void *pArg), void *pArg);
+
+#endif
@@ -0,0 +1,12 @@
+/**
+ *@file power_mode.h
+ *
+ *@brief
+ *  - host stand-in for the power mode header of the board library,
+ *    nothing of it is used
+ *
+ *******************************************************************************/
+#ifndef _POWER_MODE_H_
+#define _POWER_MODE_H_
+
+#endif
@@ -0,0 +1,56 @@
+/**
+ *@file queue.h
+ *
+ *@brief
+ *  - host stand-in for the pointer queue of the board library, safe
+ *    against the ISRs of the simulation (critical.h)
+ *
+ *******************************************************************************/
+#ifndef _QUEUE_H_
+#define _QUEUE_H_
+
+/**
+ * @def QUEUE_SIZE_MAX
+ * @brief capacity of a queue, queue_init fails above it; the depth the
+ * board library queue is known to take (see CHUNK_NUM_MAX), so a deeper
+ * queue fails here as well
+ */
+#define QUEUE_SIZE_MAX	(32)
+
+/** queue object
+ */
+typedef struct {
+  void          *pElem[QUEUE_SIZE_MAX];
+  unsigned int  head;     /* elements put */
+  unsigned int  tail;     /* elements taken */
+  unsigned int  size;     /* capacity asked for */
+} queue_t;
+
+/** Initialize an empty queue
+ *
+ * @return Zero on success.
+ * Negative value on failure (size above QUEUE_SIZE_MAX).
+ */
+int queue_init(queue_t *pThis, int size);
+
+/** append an element
+ *
+ * @return Zero on success.
+ * Negative value on failure (full).
+ */
+int queue_put(queue_t *pThis, void *pElem);
+
+/** take the oldest element
+ *
+ * @return Zero on success.
+ * Negative value on failure (empty).
+ */
+int queue_get(queue_t *pThis, void **ppElem);
+
+/** Returns true (non-zero) if the queue is empty */
+int queue_is_empty(queue_t *pThis);
+
+/** Returns true (non-zero) if the queue is full */
+int queue_is_full(queue_t *pThis);
+
+#endif
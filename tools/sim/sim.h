@@ -0,0 +1,108 @@
+/**
+ *@file sim.h
+ *
+ *@brief
+ *  - host simulation of the board around the audio player: SPORT0 on
+ *    DMA3 (capture) and DMA4 (playback), UART1 on DMA10 (receive) and
+ *    DMA11 (transmit), the interrupts as a timer signal
+ *
+ *  The peripherals are models run every SIM_TICK_US from SIGALRM, in
+ *  real time against the host monotonic clock (the clock cycles.h
+ *  reads on the host):
+ *  - SPORT0 moves a sample per 1/8000 s each way; capture comes from
+ *    the input samples (silence after them), playback is recorded
+ *  - UART1 transmits a byte per SIM_UART_BYTE_NS (115200 baud, 8N1)
+ *    into a file descriptor and receives what can be read from one:
+ *    by default the two ends of a pipe (loopback, the player talks to
+ *    itself), or a terminal or pty given by path
+ *  - the DMA channels follow their registers: descriptor list (large
+ *    model), autobuffer 1D/2D and stop mode, an interrupt per
+ *    completed descriptor or row as the config asks for it; the
+ *    registered handler is called in the signal handler, handlers do
+ *    not nest
+ *  - the core timer counts at the core clock from the tick it was
+ *    enabled in, its handler (register_handler, sys/exception.h) is
+ *    called at most once per tick
+ *
+ *  critical.h built with TLL_SIM blocks the signal for a critical
+ *  section and waits for it in critical_idle, which is also where a
+ *  run ends: audioPlayer_run does not return, sim_run jumps out of it.
+ *
+ *******************************************************************************/
+#ifndef _SIM_H_
+#define _SIM_H_
+
+#include "audioPlayer.h"
+
+/**
+ * @def SIM_RATE
+ * @brief SPORT0 samples per second
+ */
+#define SIM_RATE	(8000)
+
+/**
+ * @def SIM_TICK_US
+ * @brief period the models are run at [us]
+ */
+#define SIM_TICK_US	(250)
+
+/**
+ * @def SIM_UART_BYTE_NS
+ * @brief UART1 byte time [ns], 10 bits at 115200 baud
+ */
+#define SIM_UART_BYTE_NS	(10 * 1000000000LL / 115200)
+
+/** a run of the simulation
+ */
+typedef struct {
+  const short   *pIn;       /* capture samples, NULL for silence */
+  int           inLen;      /* their number */
+  short         *pOut;      /* playback samples recorded, NULL for none */
+  int           outMax;     /* room in pOut */
+  int           inUsed;     /* samples SPORT0 captured into DMA3, set by sim_run */
+  int           outLen;     /* samples recorded, set by sim_run */
+  unsigned int  uartBytes;  /* bytes sent on UART1, set by sim_run */
+  unsigned int  uartLost;   /* bytes received with the receiver off */
+} sim_run_t;
+
+/** open UART1
+ *
+ * Parameters:
+ * @param pPath  terminal or pty to talk through, NULL for a loopback pipe
+ *
+ * @return Zero on success.
+ * Negative value on failure (reported on stderr).
+ */
+int sim_init(const char *pPath);
+
+/** reset the peripherals and the registers, before each audioPlayer_init
+ *   bytes waiting on UART1 are dropped
+ *
+ * @return void
+ */
+void sim_reset(void);
+
+/** run the audio player in the simulation
+ *   calls audioPlayer_run (after audioPlayer_init and _start) until ms
+ *   have passed
+ *
+ * Parameters:
+ * @param pRun  the samples in and out
+ * @param pPlayer  audio player, initialized and started
+ * @param ms  duration [ms]
+ *
+ * @return void
+ */
+void sim_run(sim_run_t *pRun, audioPlayer_t *pPlayer, int ms);
+
+/** generate a speech like talker: noise through a formant, syllables
+ *   and pauses, at SIM_RATE
+ *
+ * Parameters:
+ * @param len  number of samples
+ *
+ * @return the samples (free them), NULL on failure
+ */
+short *sim_talker(int len);
+
+#endif
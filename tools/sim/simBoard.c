@@ -0,0 +1,139 @@
+/**
+ *@file simBoard.c
+ *
+ *@brief
+ *  - host stand-ins for the board library: interrupt dispatcher,
+ *    pointer queue, codec, TWI, core timer and extension I/O drivers
+ *
+ *******************************************************************************/
+#include "tll_common.h"
+#include "critical.h"
+#include "isrDisp.h"
+#include "queue.h"
+#include "ssm2602.h"
+#include "bf52xI2cMaster.h"
+#include "extio.h"
+#include "tll6527_core_timer.h"
+
+
+/** Initialize the dispatcher, no handler registered */
+int isrDisp_init(isrDisp_t *pThis)
+{
+	int count;
+
+	if ( NULL == pThis ) {
+		return FAIL;
+	}
+	for ( count = 0; ISR_NUM > count; count++ ) {
+		pThis->entry[count].callback = NULL;
+		pThis->entry[count].pArg     = NULL;
+	}
+	return PASS;
+}
+
+
+/** register the handler of an interrupt */
+int isrDisp_registerCallback(isrDisp_t *pThis, isrDisp_irq_t irq,
+                             void (*callback)(void *pArg), void *pArg)
+{
+	unsigned int mask;
+
+	if ( NULL == pThis || ISR_NUM <= (unsigned int) irq ) {
+		return FAIL;
+	}
+	mask = critical_enter();
+	pThis->entry[irq].callback = callback;
+	pThis->entry[irq].pArg     = pArg;
+	critical_exit(mask);
+	return PASS;
+}
+
+
+/** Initialize an empty queue */
+int queue_init(queue_t *pThis, int size)
+{
+	if ( NULL == pThis || 0 >= size || QUEUE_SIZE_MAX < size ) {
+		return FAIL;
+	}
+	pThis->head = 0;
+	pThis->tail = 0;
+	pThis->size = size;
+	return PASS;
+}
+
+
+/** append an element, ISR safe */
+int queue_put(queue_t *pThis, void *pElem)
+{
+	unsigned int mask;
+	int status = FAIL;
+
+	mask = critical_enter();
+	if ( pThis->head - pThis->tail < pThis->size ) {
+		pThis->pElem[pThis->head++ % QUEUE_SIZE_MAX] = pElem;
+		status = PASS;
+	}
+	critical_exit(mask);
+	return status;
+}
+
+
+/** take the oldest element, ISR safe */
+int queue_get(queue_t *pThis, void **ppElem)
+{
+	unsigned int mask;
+	int status = FAIL;
+
+	mask = critical_enter();
+	if ( pThis->head != pThis->tail ) {
+		*ppElem = pThis->pElem[pThis->tail++ % QUEUE_SIZE_MAX];
+		status = PASS;
+	}
+	critical_exit(mask);
+	return status;
+}
+
+
+/** Returns true (non-zero) if the queue is empty */
+int queue_is_empty(queue_t *pThis)
+{
+	return pThis->head == pThis->tail;
+}
+
+
+/** Returns true (non-zero) if the queue is full */
+int queue_is_full(queue_t *pThis)
+{
+	return pThis->head - pThis->tail >= pThis->size;
+}
+
+
+/** Initialize the codec, SPORT0 runs at 8 kHz whatever is asked for */
+int ssm2602_init(isrDisp_t *pIsrDisp, int volume, eSsm2602SampleFreq frequency, int flags)
+{
+	(void) volume;
+	(void) frequency;
+	(void) flags;
+	return NULL == pIsrDisp ? FAIL : PASS;
+}
+
+
+/** Initialize the TWI as I2C master, does nothing */
+void bf52xI2cMaster_init(int port, int clock)
+{
+	(void) port;
+	(void) clock;
+}
+
+
+/** Initialize the core timer, does nothing */
+void coreTimer_init(void)
+{
+}
+
+
+/** Initialize the extension I/O, does nothing */
+int extio_init(isrDisp_t *pIsrDisp)
+{
+	return NULL == pIsrDisp ? FAIL : PASS;
+}
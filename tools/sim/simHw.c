@@ -0,0 +1,471 @@
+/**
+ *@file simHw.c
+ *
+ *@brief
+ *  - host models of SPORT0 and UART1 with their DMA channels, the
+ *    interrupts and the run control of the simulation, see sim.h
+ *
+ *******************************************************************************/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <setjmp.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include <sys/time.h>
+#include "tll_common.h"
+#include "critical.h"
+#include "cycles.h"
+#include "dmaDesc.h"
+#include "sim.h"
+#include <tll_config.h>
+#include <tll_sport.h>
+#include <sys/exception.h>
+
+/**
+ * @def SIM_UART_READ
+ * @brief bytes read from UART1 per tick at most
+ */
+#define SIM_UART_READ	(256)
+
+/** a DMA channel as the model runs it
+ */
+typedef struct {
+  int            active;    /* transfer in progress */
+  unsigned short config;    /* config of the transfer */
+  unsigned char  *pAddr;    /* next element */
+  unsigned int   xLeft;     /* elements left in the row */
+  unsigned int   yLeft;     /* rows left, 2D */
+  isrDisp_irq_t  irq;       /* interrupt raised */
+} simChan_t;
+
+/** state of the simulation
+ */
+typedef struct {
+  simChan_t          chan[12];      /* channels 3, 4, 10, 11 are modelled */
+  isrDisp_t          *pIsrDisp;     /* handlers, of the player run */
+  sim_run_t          *pRun;         /* samples in and out */
+  long long          start;         /* start of the run [ns] */
+  long long          end;           /* end of the run [ns] */
+  long long          samples;       /* SPORT0 samples moved each way */
+  long long          txTime;        /* UART1 transmitter free from [ns] */
+  ex_handler_fn      timerFn;       /* core timer handler */
+  int                timerOn;       /* core timer counting */
+  long long          timerNext;     /* its next interrupt [ns] */
+  int                rdFd;          /* UART1 receive */
+  int                wrFd;          /* UART1 transmit */
+  volatile int       stop;          /* the run is over */
+  sigjmp_buf         jmp;           /* back to sim_run */
+} sim_t;
+
+simDma_t sim_dma[12];
+volatile unsigned short sim_uart1Ier;
+volatile unsigned short sim_portfFer;
+volatile unsigned short sim_portfMux;
+volatile unsigned int sim_sport0;
+volatile unsigned long sim_tcntl;
+volatile unsigned long sim_tperiod;
+volatile unsigned long sim_tscale;
+volatile unsigned long sim_tcount;
+
+static sim_t sim;
+
+
+/** host monotonic clock [ns] */
+static long long sim_now(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+
+/** block the timer signal
+ *
+ * @return 1 if it was blocked already, for sim_sti
+ */
+unsigned int sim_cli(void)
+{
+	sigset_t set;
+	sigset_t old;
+
+	sigemptyset(&set);
+	sigaddset(&set, SIGALRM);
+	sigprocmask(SIG_BLOCK, &set, &old);
+	return sigismember(&old, SIGALRM);
+}
+
+
+/** unblock the timer signal, unless it was blocked before sim_cli */
+void sim_sti(unsigned int mask)
+{
+	sigset_t set;
+
+	if ( 0 == mask ) {
+		sigemptyset(&set);
+		sigaddset(&set, SIGALRM);
+		sigprocmask(SIG_UNBLOCK, &set, NULL);
+	}
+}
+
+
+/** wait for the timer signal with it blocked, as idle does for an
+ *   interrupt; the end of a run leaves from here */
+void sim_idle(unsigned int mask)
+{
+	sigset_t set;
+
+	sigprocmask(SIG_SETMASK, NULL, &set);
+	sigdelset(&set, SIGALRM);
+	sigsuspend(&set);
+	if ( sim.stop ) {
+		siglongjmp(sim.jmp, 1);
+	}
+	sim_sti(mask);
+}
+
+
+/** raise the interrupt of a channel: DMA_DONE set for the handler,
+ *   cleared after it as its write 1 to clear would */
+static void sim_irq(int c)
+{
+	isrDisp_entry_t *pEntry = &sim.pIsrDisp->entry[sim.chan[c].irq];
+
+	sim_dma[c].irqStatus |= DMA_DONE;
+	if ( NULL != pEntry->callback ) {
+		pEntry->callback(pEntry->pArg);
+	}
+	sim_dma[c].irqStatus &= ~DMA_DONE;
+}
+
+
+/** load a transfer from the registers or, in descriptor list mode,
+ *   from the next descriptor */
+static void sim_load(int c, int fetch)
+{
+	simDma_t *pReg = &sim_dma[c];
+	simChan_t *pCh = &sim.chan[c];
+	dmaDesc_t *pDesc;
+
+	if ( fetch ) {
+		pDesc = pReg->nextDescPtr;
+		pReg->currDescPtr = pDesc;
+		pReg->nextDescPtr = pDesc->pNext;
+		pReg->startAddr   = pDesc->pStart;
+		pReg->config      = pDesc->config;
+		pReg->xCount      = pDesc->xCount;
+		pReg->xModify     = pDesc->xModify;
+	}
+
+	pCh->config = pReg->config;
+	pCh->pAddr  = pReg->startAddr;
+	pCh->xLeft  = pReg->xCount;
+	pCh->yLeft  = (pCh->config & DMA2D) ? pReg->yCount : 1;
+	pCh->active = (pCh->config & DMAEN) && 0 != pCh->xLeft && 0 != pCh->yLeft;
+	pReg->irqStatus &= ~DMA_DONE;
+	pReg->currAddr   = pCh->pAddr;
+}
+
+
+/** move one element of a channel, start it first if it was enabled
+ *   since the last one; interrupt and next transfer at the end of a
+ *   row or of the whole transfer
+ *
+ * @param c  channel
+ * @param pData  element to write to memory, or read from it
+ *
+ * @return 1 if an element was moved, 0 if the channel is idle
+ */
+static int sim_step(int c, unsigned char *pData)
+{
+	simDma_t *pReg = &sim_dma[c];
+	simChan_t *pCh = &sim.chan[c];
+	int size;
+	int count;
+	int flow;
+
+	if ( !pCh->active ) {
+		if ( 0 == (pReg->config & DMAEN) ) {
+			return 0;
+		}
+		sim_load(c, FLOW_LARGE == (pReg->config & FLOW) || FLOW_SMALL == (pReg->config & FLOW));
+		if ( !pCh->active ) {
+			return 0;
+		}
+	}
+
+	size = (pCh->config & WDSIZE_32) ? 4 : (pCh->config & WDSIZE_16) ? 2 : 1;
+	for ( count = 0; size > count; count++ ) {
+		if ( pCh->config & WNR ) {
+			pCh->pAddr[count] = pData[count];
+		} else {
+			pData[count] = pCh->pAddr[count];
+		}
+	}
+
+	if ( 0 != --pCh->xLeft ) {
+		pCh->pAddr    += pReg->xModify;
+		pReg->currAddr = pCh->pAddr;
+		return 1;
+	}
+
+	// end of a row
+	if ( 0 != --pCh->yLeft ) {
+		pCh->pAddr    += pReg->yModify;
+		pReg->currAddr = pCh->pAddr;
+		pCh->xLeft     = pReg->xCount;
+		if ( (pCh->config & DI_EN) && (pCh->config & DI_SEL) ) {
+			sim_irq(c);
+		}
+		return 1;
+	}
+
+	// end of the transfer: the next one is set up before the interrupt
+	flow = pCh->config & FLOW;
+	if ( FLOW_STOP == flow ) {
+		pCh->active    = 0;
+		pReg->config  &= ~DMAEN;
+		pReg->currAddr = pCh->pAddr + pReg->xModify;
+	} else {
+		sim_load(c, FLOW_AUTO != flow);
+	}
+	if ( pCh->config & DI_EN ) {
+		sim_irq(c);
+	}
+	return 1;
+}
+
+
+/** SPORT0 samples due up to now, capture and playback */
+static void sim_sport(long long now)
+{
+	sim_run_t *pRun = sim.pRun;
+	long long due = (now - sim.start) * SIM_RATE / 1000000000LL;
+	short sample;
+
+	for ( ; due > sim.samples; sim.samples++ ) {
+		if ( sim_sport0 & SIM_SPORT_RX ) {
+			sample = 0;
+			if ( NULL != pRun->pIn && pRun->inLen > sim.samples ) {
+				sample = pRun->pIn[sim.samples];
+			}
+			if ( sim_step(3, (unsigned char *) &sample) ) {
+				pRun->inUsed++;
+			}
+		}
+		if ( sim_sport0 & SIM_SPORT_TX ) {
+			sample = 0;
+			if ( sim_step(4, (unsigned char *) &sample)
+			     && NULL != pRun->pOut && pRun->outMax > pRun->outLen ) {
+				pRun->pOut[pRun->outLen++] = sample;
+			}
+		}
+	}
+}
+
+
+/** UART1: bytes due on the transmitter, bytes arrived at the receiver */
+static void sim_uart(long long now)
+{
+	unsigned char data[SIM_UART_READ];
+	int len;
+	int count;
+
+	/* the DMA request comes from the transmitter, a byte time apart;
+	 * an idle transmitter takes the first byte right away */
+	if ( !sim.chan[11].active && sim.txTime < now - SIM_UART_BYTE_NS ) {
+		sim.txTime = now - SIM_UART_BYTE_NS;
+	}
+	while ( sim.txTime + SIM_UART_BYTE_NS <= now && (sim_uart1Ier & ETBEI) ) {
+		if ( !sim_step(11, data) ) {
+			break;
+		}
+		if ( 1 == write(sim.wrFd, data, 1) ) {
+			sim.pRun->uartBytes++;
+		}
+		sim.txTime += SIM_UART_BYTE_NS;
+	}
+
+	len = read(sim.rdFd, data, sizeof(data));
+	for ( count = 0; len > count; count++ ) {
+		if ( !(sim_uart1Ier & ERBFI) || !sim_step(10, &data[count]) ) {
+			sim.pRun->uartLost++;
+		}
+	}
+}
+
+
+/** core timer: counts TCOUNT down at the core clock divided by
+ *   TSCALE + 1 from the tick it was enabled in, interrupts at zero and
+ *   reloads TPERIOD with TAUTORLD, stops without; interrupts missed
+ *   while the host lagged are taken as one, as ILAT latches one */
+static void sim_timer(long long now)
+{
+	long long scale = (sim_tscale + 1) * 1000000LL / CYCLES_PER_MS;   // [ns per count]
+
+	if ( (TMPWR | TMREN) != (sim_tcntl & (TMPWR | TMREN)) ) {
+		sim.timerOn = 0;
+		return;
+	}
+	if ( !sim.timerOn ) {
+		sim.timerOn   = 1;
+		sim.timerNext = now + sim_tcount * scale;
+	}
+	if ( sim.timerNext > now ) {
+		return;
+	}
+
+	if ( sim_tcntl & TAUTORLD ) {
+		while ( sim.timerNext <= now ) {
+			sim.timerNext += sim_tperiod * scale;
+		}
+	} else {
+		sim_tcntl  &= ~TMREN;
+		sim.timerOn = 0;
+	}
+	sim_tcntl |= TINT;
+	if ( NULL != sim.timerFn ) {
+		sim.timerFn();
+	}
+}
+
+
+/** the timer signal: run the models up to now */
+static void sim_tick(int sig)
+{
+	long long now = sim_now();
+
+	(void) sig;
+	if ( now >= sim.end ) {
+		sim.stop = 1;
+		return;
+	}
+	sim_sport(now);
+	sim_uart(now);
+	sim_timer(now);
+}
+
+
+/** register the handler of a core event, the core timer only */
+ex_handler_fn register_handler(interrupt_kind kind, ex_handler_fn fn)
+{
+	ex_handler_fn old = sim.timerFn;
+
+	if ( ik_timer != kind ) {
+		return NULL;
+	}
+	sim.timerFn = fn;
+	return old;
+}
+
+
+/** open UART1 */
+int sim_init(const char *pPath)
+{
+	struct termios tio;
+	struct sigaction action;
+	int fd[2];
+
+	if ( NULL == pPath ) {
+		if ( 0 != pipe(fd) ) {
+			perror("pipe");
+			return FAIL;
+		}
+		sim.rdFd = fd[0];
+		sim.wrFd = fd[1];
+	} else {
+		sim.rdFd = open(pPath, O_RDWR | O_NOCTTY);
+		if ( 0 > sim.rdFd ) {
+			perror(pPath);
+			return FAIL;
+		}
+		if ( 0 == tcgetattr(sim.rdFd, &tio) ) {
+			cfmakeraw(&tio);
+			cfsetspeed(&tio, B115200);
+			tcsetattr(sim.rdFd, TCSANOW, &tio);
+		}
+		sim.wrFd = sim.rdFd;
+	}
+	fcntl(sim.rdFd, F_SETFL, fcntl(sim.rdFd, F_GETFL) | O_NONBLOCK);
+	fcntl(sim.wrFd, F_SETFL, fcntl(sim.wrFd, F_GETFL) | O_NONBLOCK);
+
+	memset(&action, 0, sizeof(action));
+	action.sa_handler = sim_tick;
+	action.sa_flags   = SA_RESTART;
+	sigemptyset(&action.sa_mask);
+	sigaction(SIGALRM, &action, NULL);
+	return PASS;
+}
+
+
+/** reset the peripherals and the registers */
+void sim_reset(void)
+{
+	unsigned char data[SIM_UART_READ];
+	int count;
+
+	for ( count = 0; 12 > count; count++ ) {
+		memset((void *) &sim_dma[count], 0, sizeof(sim_dma[count]));
+		memset(&sim.chan[count], 0, sizeof(sim.chan[count]));
+	}
+	sim.chan[3].irq  = ISR_DMA3_SPORT0_RX;
+	sim.chan[4].irq  = ISR_DMA4_SPORT0_TX;
+	sim.chan[10].irq = ISR_DMA10_UART1_RX;
+	sim.chan[11].irq = ISR_DMA11_UART1_TX;
+	sim_uart1Ier = 0;
+	sim_portfFer = 0;
+	sim_portfMux = 0;
+	sim_sport0   = 0;
+	sim_tcntl    = 0;
+	sim_tperiod  = 0;
+	sim_tscale   = 0;
+	sim_tcount   = 0;
+	sim.timerOn  = 0;
+	sim.timerFn  = NULL;
+
+	while ( 0 < read(sim.rdFd, data, sizeof(data)) ) {
+	}
+}
+
+
+/** run the audio player in the simulation */
+void sim_run(sim_run_t *pRun, audioPlayer_t *pPlayer, int ms)
+{
+	struct itimerval timer;
+	unsigned int mask;
+
+	pRun->inUsed    = 0;
+	pRun->outLen    = 0;
+	pRun->uartBytes = 0;
+	pRun->uartLost  = 0;
+
+	mask = sim_cli();
+	sim.pIsrDisp = &pPlayer->isrDisp;
+	sim.pRun     = pRun;
+	sim.start    = sim_now();
+	sim.end      = sim.start + ms * 1000000LL;
+	sim.samples  = 0;
+	sim.txTime   = sim.start;
+	sim.stop     = 0;
+
+	timer.it_interval.tv_sec  = 0;
+	timer.it_interval.tv_usec = SIM_TICK_US;
+	timer.it_value            = timer.it_interval;
+	setitimer(ITIMER_REAL, &timer, NULL);
+
+	// audioPlayer_run leaves through sim_idle, signal blocked
+	if ( 0 == sigsetjmp(sim.jmp, 1) ) {
+		sim_sti(mask);
+		audioPlayer_run(pPlayer);
+	}
+
+	timer.it_value.tv_sec  = 0;
+	timer.it_value.tv_usec = 0;
+	setitimer(ITIMER_REAL, &timer, NULL);
+	sim_sti(mask);
+}
@@ -0,0 +1,182 @@
+/**
+ *@file simMain.c
+ *
+ *@brief
+ *  - the audio player on the host: the whole pipeline of the board
+ *    (capture, echo canceller, noise suppressor, AGC, VAD, encoder,
+ *    UART framing, jitter buffer, decoder, concealment, playback) on
+ *    the simulated SPORT0 and UART1 of sim.h
+ *
+ *  tincansim [-i <in.wav>] [-o <out.wav>] [-t <s>] [-f <ms>]
+ *            [-c adpcm|ulaw|alaw] [-l] [-n] [-u <tty>]
+ *
+ *  -i  capture, 16 bit PCM 8 kHz (first channel); a generated talker
+ *      without it
+ *  -o  playback recorded, 16 bit PCM 8 kHz mono
+ *  -t  duration, the input plus 1 s by default (10 s generated)
+ *  -f  frame duration [ms], AP_FRAME_MS_DEFAULT by default
+ *  -c  codec on the link, ADPCM by default
+ *  -l  latency mode (timing trailer, see latency.h)
+ *  -n  noise suppression off, 16 ms less delay
+ *  -u  terminal or pty as UART1, a loopback pipe by default: the
+ *      player talks to itself, the playback is the capture after the
+ *      link
+ *
+ *  Two simulations talk to each other through a pty pair, e.g. made
+ *  with socat -d -d pty,raw,echo=0 pty,raw,echo=0, one end each.
+ *  Runs in real time; the player reports every AP_REPORT_MS as on the
+ *  board, the counters of all paths are printed at the end.
+ *
+ *******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tll_common.h"
+#include "audioPlayer.h"
+#include "sim.h"
+#include "wav.h"
+
+/**
+ * @def SIM_SECONDS
+ * @brief length of the generated talker
+ */
+#define SIM_SECONDS	(10)
+
+/**
+ * @def SIM_TAIL_MS
+ * @brief run on after the input, the link and the jitter buffer drain
+ */
+#define SIM_TAIL_MS	(1000)
+
+/**
+ * @var audioPlayer
+ * @brief  global audio player object, as in main.c
+ */
+audioPlayer_t	audioPlayer;
+
+
+/** counters of a path */
+static void sim_telemetry(const char *pName, const telemetry_t *pStats)
+{
+	printf("[SIM]: %-8s in %5u out %5u, dropped: queue full %u, no buffer %u, corrupt %u, "
+	       "link loss %u, invalid %u; underruns %u, queue high %u\r\n",
+	       pName, pStats->in, pStats->out,
+	       pStats->drops[TELEMETRY_DROP_QUEUE_FULL], pStats->drops[TELEMETRY_DROP_NO_BUFFER],
+	       pStats->drops[TELEMETRY_DROP_CORRUPT], pStats->drops[TELEMETRY_DROP_LINK_LOSS],
+	       pStats->drops[TELEMETRY_DROP_INVALID], pStats->underruns, pStats->queueHigh);
+}
+
+
+int main(int argc, char *argv[])
+{
+	static const char *pCodecs[] = { "", "adpcm", "ulaw", "alaw" };
+	audioPlayer_telemetry_t snap;
+	sim_run_t run;
+	const char *pIn = NULL;
+	const char *pOut = NULL;
+	const char *pUart = NULL;
+	short *pData;
+	int codec = COMPRESSION_CODEC_ADPCM;
+	int frameMs = 0;
+	int ms = 0;
+	int latency = 0;
+	int ns = 1;
+	int rate = SIM_RATE;
+	int len;
+	int count;
+
+	for ( count = 1; argc > count; count++ ) {
+		if ( 0 == strcmp(argv[count], "-l") ) {
+			latency = 1;
+		} else if ( 0 == strcmp(argv[count], "-n") ) {
+			ns = 0;
+		} else if ( argc == count + 1 || '-' != argv[count][0] || 2 != strlen(argv[count]) ) {
+			codec = 0;
+			break;
+		} else if ( 'i' == argv[count][1] ) {
+			pIn = argv[++count];
+		} else if ( 'o' == argv[count][1] ) {
+			pOut = argv[++count];
+		} else if ( 'u' == argv[count][1] ) {
+			pUart = argv[++count];
+		} else if ( 't' == argv[count][1] ) {
+			ms = (int) (atof(argv[++count]) * 1000.0);
+		} else if ( 'f' == argv[count][1] ) {
+			frameMs = atoi(argv[++count]);
+		} else if ( 'c' == argv[count][1] ) {
+			count++;
+			for ( codec = COMPRESSION_CODEC_ALAW; COMPRESSION_CODEC_ADPCM <= codec; codec-- ) {
+				if ( 0 == strcmp(argv[count], pCodecs[codec]) ) {
+					break;
+				}
+			}
+		} else {
+			codec = 0;
+			break;
+		}
+	}
+	if ( COMPRESSION_CODEC_ADPCM > codec || 0 > ms ) {
+		fprintf(stderr, "usage: tincansim [-i <in.wav>] [-o <out.wav>] [-t <s>] [-f <ms>] "
+		        "[-c adpcm|ulaw|alaw] [-l] [-n] [-u <tty>]\n");
+		return 1;
+	}
+
+	if ( NULL != pIn ) {
+		pData = wav_read(pIn, &rate, &len);
+		if ( NULL == pData ) {
+			return 1;
+		}
+		if ( SIM_RATE != rate ) {
+			fprintf(stderr, "%s: %d Hz, taken as %d Hz\n", pIn, rate, SIM_RATE);
+		}
+	} else {
+		len   = SIM_SECONDS * SIM_RATE;
+		pData = sim_talker(len);
+	}
+	if ( 0 == ms ) {
+		ms = (int) (len * 1000LL / SIM_RATE) + SIM_TAIL_MS;
+	}
+
+	run.pIn    = pData;
+	run.inLen  = len;
+	run.outMax = (int) ((long long) ms * SIM_RATE / 1000) + SIM_RATE;
+	run.pOut   = calloc(run.outMax, sizeof(short));
+
+	if ( PASS != sim_init(pUart) ) {
+		return 1;
+	}
+	sim_reset();
+	if ( PASS != audioPlayer_init(&audioPlayer)
+	     || (0 != frameMs && PASS != audioPlayer_setFrameDuration(&audioPlayer, frameMs))
+	     || PASS != audioPlayer_setCodec(&audioPlayer, codec) ) {
+		fprintf(stderr, "tincansim: audio player init failed\n");
+		return 1;
+	}
+	audioPlayer_setLatencyMode(&audioPlayer, latency);
+	audioPlayer_setNoiseSuppression(&audioPlayer, ns);
+	if ( PASS != audioPlayer_start(&audioPlayer) ) {
+		fprintf(stderr, "tincansim: audio player start failed\n");
+		return 1;
+	}
+
+	sim_run(&run, &audioPlayer, ms);
+
+	printf("[SIM]: %d ms, %d samples captured, %d played, UART1 %u bytes sent, %u lost\r\n",
+	       ms, run.inUsed, run.outLen, run.uartBytes, run.uartLost);
+	audioPlayer_telemetrySnapshot(&audioPlayer, &snap);
+	sim_telemetry("audioRx", &snap.audioRx);
+	sim_telemetry("uartTx", &snap.uartTx);
+	sim_telemetry("uartRx", &snap.uartRx);
+	sim_telemetry("audioTx", &snap.audioTx);
+	event_report(&audioPlayer.event);
+	if ( latency ) {
+		audioPlayer_latencyReport(&audioPlayer);
+	}
+
+	if ( NULL != pOut && PASS != wav_write(pOut, SIM_RATE, run.pOut, run.outLen) ) {
+		return 1;
+	}
+	free(pData);
+	free(run.pOut);
+	return 0;
+}
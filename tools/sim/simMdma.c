@@ -0,0 +1,49 @@
+/**
+ *@file simMdma.c
+ *
+ *@brief
+ *  - host model of memory DMA stream 0, see tll_config.h
+ *
+ *******************************************************************************/
+#include "tll_common.h"
+#include <tll_config.h>
+
+simDma_t sim_mdmaS0;
+simDma_t sim_mdmaD0;
+
+
+/** run memory DMA stream 0
+ *   the destination starts the transfer, once both sides are enabled;
+ *   1D, 8/16/32 bit, the modify of each side taken as given
+ *
+ * @return words moved
+ */
+int sim_mdma(void)
+{
+	unsigned char *pSrc = sim_mdmaS0.startAddr;
+	unsigned char *pDst = sim_mdmaD0.startAddr;
+	int size;
+	int count;
+	int index;
+
+	if ( 0 == (sim_mdmaS0.config & DMAEN) || 0 == (sim_mdmaD0.config & DMAEN) ) {
+		return 0;
+	}
+
+	sim_mdmaD0.irqStatus &= ~DMA_DONE;
+	size = 1 << ((sim_mdmaD0.config & WDSIZE_32 ? 2 : sim_mdmaD0.config & WDSIZE_16 ? 1 : 0));
+	for ( count = 0; sim_mdmaD0.xCount > count; count++ ) {
+		for ( index = 0; size > index; index++ ) {
+			pDst[index] = pSrc[index];
+		}
+		pSrc += sim_mdmaS0.xModify;
+		pDst += sim_mdmaD0.xModify;
+	}
+
+	sim_mdmaS0.config &= ~DMAEN;
+	sim_mdmaD0.config &= ~DMAEN;
+	if ( sim_mdmaD0.config & DI_EN ) {
+		sim_mdmaD0.irqStatus |= DMA_DONE;
+	}
+	return count;
+}
@@ -0,0 +1,48 @@
+/**
+ *@file simTalker.c
+ *
+ *@brief
+ *  - generated capture for the simulation: a speech like talker, for
+ *    runs without an input file
+ *
+ *******************************************************************************/
+#include <stdlib.h>
+#include <math.h>
+#include "sim.h"
+
+
+/** speech like talker: noise through a formant, syllables and pauses */
+short *sim_talker(int len)
+{
+	short *pData = calloc(len, sizeof(short));
+	unsigned int seed = 1;
+	double r = 0.95;
+	double a1 = 2.0 * r * cos(2.0 * M_PI * 700.0 / SIM_RATE);
+	double a2 = -r * r;
+	double y1 = 0.0;
+	double y2 = 0.0;
+	double y;
+	double env = 0.0;
+	double target = 0.0;
+	int left = 0;
+	int on = 0;
+	int count;
+
+	if ( NULL == pData ) {
+		return NULL;
+	}
+	for ( count = 0; len > count; count++ ) {
+		seed = seed * 1103515245u + 12345u;
+		if ( 0 >= left-- ) {
+			on     = !on;
+			left   = (on ? 1200 : 400) + (int) ((seed >> 16) % (on ? 2000 : 1600));
+			target = on ? 20000.0 : 0.0;
+		}
+		env += 0.005 * (target - env);
+		y    = ((seed >> 8) & 0xFFFF) / 32768.0 - 1.0 + a1 * y1 + a2 * y2;
+		y2   = y1;
+		y1   = y;
+		pData[count] = (short) lrint(env * y * (1.0 - r));
+	}
+	return pData;
+}
@@ -0,0 +1,30 @@
+/**
+ *@file ssm2602.h
+ *
+ *@brief
+ *  - host stand-in for the SSM2602 codec driver of the board library:
+ *    nothing to configure, SPORT0 (simHw.c) runs at 8 kHz
+ *
+ *******************************************************************************/
+#ifndef _SSM2602_H_
+#define _SSM2602_H_
+
+#include "isrDisp.h"
+
+/** sample rates */
+typedef enum {
+  SSM2602_SR_8000  = 8000,
+  SSM2602_SR_16000 = 16000
+} eSsm2602SampleFreq;
+
+#define SSM2602_RX	(0x1)
+#define SSM2602_TX	(0x2)
+
+/** Initialize the codec
+ *
+ * @return Zero on success.
+ * Negative value on failure.
+ */
+int ssm2602_init(isrDisp_t *pIsrDisp, int volume, eSsm2602SampleFreq frequency, int flags);
+
+#endif
@@ -0,0 +1,33 @@
+/**
+ *@file exception.h
+ *
+ *@brief
+ *  - host stand-in for the VDSP++ runtime header of the core event
+ *    handlers: a handler registered for the core timer is called by
+ *    the timer model of simHw.c, see sim.h
+ *
+ *******************************************************************************/
+#ifndef _SYS_EXCEPTION_H_
+#define _SYS_EXCEPTION_H_
+
+/** core events a handler can be registered for, the modelled ones */
+typedef enum {
+  ik_timer = 6
+} interrupt_kind;
+
+/** a core event handler */
+typedef void (*ex_handler_fn)(void);
+
+/**
+ * @def EX_INTERRUPT_HANDLER
+ * @brief defines an interrupt handler, a plain function here
+ */
+#define EX_INTERRUPT_HANDLER(name)	void name(void)
+
+/** register the handler of a core event
+ *
+ * @return the handler registered before, NULL for none
+ */
+ex_handler_fn register_handler(interrupt_kind kind, ex_handler_fn fn);
+
+#endif
@@ -0,0 +1,15 @@
+/**
+ *@file tll6527_core_timer.h
+ *
+ *@brief
+ *  - host stand-in for the core timer driver of the board library,
+ *    time is the host clock (cycles.h)
+ *
+ *******************************************************************************/
+#ifndef _TLL6527_CORE_TIMER_H_
+#define _TLL6527_CORE_TIMER_H_
+
+/** Initialize the core timer, does nothing */
+void coreTimer_init(void);
+
+#endif
@@ -0,0 +1,188 @@
+/**
+ *@file tll_config.h
+ *
+ *@brief
+ *  - host stand-in for the board library register header: the
+ *    registers are plain memory, the models in simMdma.c (memory DMA)
+ *    and simHw.c (SPORT0 and UART1 with their DMA channels, the core
+ *    timer) move the data
+ *
+ *  The registers of a channel are a simDma_t, laid out in the order
+ *  of the memory mapped block. The bits are those of the BF52x.
+ *
+ *  Writing 1 to clear is not modelled (a write is a write): a channel
+ *  model clears DMA_DONE itself when it starts a transfer, and clears
+ *  DMAEN when a stop mode transfer completes, so enabling the channel
+ *  again is seen as a new start.
+ *
+ *******************************************************************************/
+#ifndef _TLL_CONFIG_H_
+#define _TLL_CONFIG_H_
+
+/***************************************************
+            DMA CONFIG BITS
+***************************************************/
+#define DMAEN		(0x0001)
+#define WNR		(0x0002)
+#define WDSIZE_8	(0x0000)
+#define WDSIZE_16	(0x0004)
+#define WDSIZE_32	(0x0008)
+#define DMA2D		(0x0010)
+#define RESTART		(0x0020)
+#define SYNC		(0x0020)
+#define DI_SEL		(0x0040)
+#define DI_EN		(0x0080)
+#define NDSIZE_0	(0x0000)
+#define NDSIZE_5	(0x0500)
+#define NDSIZE_7	(0x0700)
+#define NDSIZE		(0x0F00)
+#define FLOW_STOP	(0x0000)
+#define FLOW_AUTO	(0x1000)
+#define FLOW_ARRAY	(0x4000)
+#define FLOW_SMALL	(0x6000)
+#define FLOW_LARGE	(0x7000)
+#define FLOW		(0x7000)
+
+/***************************************************
+            DMA IRQ_STATUS BITS
+***************************************************/
+#define DMA_DONE	(0x0001)
+#define DMA_ERR		(0x0002)
+#define DFETCH		(0x0004)
+#define DMA_RUN		(0x0008)
+
+#define DISABLE_DMA(x)	((x) &= ~DMAEN)
+#define ENABLE_DMA(x)	((x) |= DMAEN)
+
+/***************************************************
+            UART AND PORT BITS
+***************************************************/
+#define ERBFI		(0x01)
+#define ETBEI		(0x02)
+#define PF14		(0x4000)
+#define PF15		(0x8000)
+
+/***************************************************
+            CORE TIMER BITS
+***************************************************/
+#define TMPWR		(0x0001)
+#define TMREN		(0x0002)
+#define TAUTORLD	(0x0004)
+#define TINT		(0x0008)
+
+
+/***************************************************
+            DATA TYPES
+***************************************************/
+
+/** registers of a DMA channel
+ */
+typedef struct {
+  void * volatile          nextDescPtr;
+  void * volatile          startAddr;
+  volatile unsigned short  config;
+  volatile unsigned short  xCount;
+  volatile short           xModify;
+  volatile unsigned short  yCount;
+  volatile short           yModify;
+  void * volatile          currDescPtr;
+  void * volatile          currAddr;
+  volatile unsigned short  irqStatus;
+  volatile unsigned short  currXCount;
+  volatile unsigned short  currYCount;
+} simDma_t;
+
+extern simDma_t sim_mdmaS0;
+extern simDma_t sim_mdmaD0;
+extern simDma_t sim_dma[12];
+extern volatile unsigned short sim_uart1Ier;
+extern volatile unsigned short sim_portfFer;
+extern volatile unsigned short sim_portfMux;
+extern volatile unsigned long sim_tcntl;
+extern volatile unsigned long sim_tperiod;
+extern volatile unsigned long sim_tscale;
+extern volatile unsigned long sim_tcount;
+
+
+/***************************************************
+            REGISTERS
+***************************************************/
+#define pDMA3_CONFIG		(&sim_dma[3].config)
+#define pDMA3_START_ADDR	(&sim_dma[3].startAddr)
+#define pDMA3_NEXT_DESC_PTR	(&sim_dma[3].nextDescPtr)
+#define pDMA3_CURR_DESC_PTR	(&sim_dma[3].currDescPtr)
+#define pDMA3_CURR_ADDR		(&sim_dma[3].currAddr)
+#define pDMA3_X_COUNT		(&sim_dma[3].xCount)
+#define pDMA3_Y_COUNT		(&sim_dma[3].yCount)
+#define pDMA3_X_MODIFY		(&sim_dma[3].xModify)
+#define pDMA3_Y_MODIFY		(&sim_dma[3].yModify)
+#define pDMA3_CURR_X_COUNT	(&sim_dma[3].currXCount)
+#define pDMA3_CURR_Y_COUNT	(&sim_dma[3].currYCount)
+#define pDMA3_IRQ_STATUS	(&sim_dma[3].irqStatus)
+#define pDMA4_CONFIG		(&sim_dma[4].config)
+#define pDMA4_START_ADDR	(&sim_dma[4].startAddr)
+#define pDMA4_NEXT_DESC_PTR	(&sim_dma[4].nextDescPtr)
+#define pDMA4_CURR_DESC_PTR	(&sim_dma[4].currDescPtr)
+#define pDMA4_CURR_ADDR		(&sim_dma[4].currAddr)
+#define pDMA4_X_COUNT		(&sim_dma[4].xCount)
+#define pDMA4_Y_COUNT		(&sim_dma[4].yCount)
+#define pDMA4_X_MODIFY		(&sim_dma[4].xModify)
+#define pDMA4_Y_MODIFY		(&sim_dma[4].yModify)
+#define pDMA4_CURR_X_COUNT	(&sim_dma[4].currXCount)
+#define pDMA4_CURR_Y_COUNT	(&sim_dma[4].currYCount)
+#define pDMA4_IRQ_STATUS	(&sim_dma[4].irqStatus)
+#define pDMA10_CONFIG		(&sim_dma[10].config)
+#define pDMA10_START_ADDR	(&sim_dma[10].startAddr)
+#define pDMA10_NEXT_DESC_PTR	(&sim_dma[10].nextDescPtr)
+#define pDMA10_CURR_DESC_PTR	(&sim_dma[10].currDescPtr)
+#define pDMA10_CURR_ADDR	(&sim_dma[10].currAddr)
+#define pDMA10_X_COUNT		(&sim_dma[10].xCount)
+#define pDMA10_Y_COUNT		(&sim_dma[10].yCount)
+#define pDMA10_X_MODIFY		(&sim_dma[10].xModify)
+#define pDMA10_Y_MODIFY		(&sim_dma[10].yModify)
+#define pDMA10_CURR_X_COUNT	(&sim_dma[10].currXCount)
+#define pDMA10_CURR_Y_COUNT	(&sim_dma[10].currYCount)
+#define pDMA10_IRQ_STATUS	(&sim_dma[10].irqStatus)
+#define pDMA11_CONFIG		(&sim_dma[11].config)
+#define pDMA11_START_ADDR	(&sim_dma[11].startAddr)
+#define pDMA11_NEXT_DESC_PTR	(&sim_dma[11].nextDescPtr)
+#define pDMA11_CURR_DESC_PTR	(&sim_dma[11].currDescPtr)
+#define pDMA11_CURR_ADDR	(&sim_dma[11].currAddr)
+#define pDMA11_X_COUNT		(&sim_dma[11].xCount)
+#define pDMA11_Y_COUNT		(&sim_dma[11].yCount)
+#define pDMA11_X_MODIFY		(&sim_dma[11].xModify)
+#define pDMA11_Y_MODIFY		(&sim_dma[11].yModify)
+#define pDMA11_CURR_X_COUNT	(&sim_dma[11].currXCount)
+#define pDMA11_CURR_Y_COUNT	(&sim_dma[11].currYCount)
+#define pDMA11_IRQ_STATUS	(&sim_dma[11].irqStatus)
+#define pUART1_IER		(&sim_uart1Ier)
+#define pPORTF_FER		(&sim_portfFer)
+#define pPORTF_MUX		(&sim_portfMux)
+#define pTCNTL			(&sim_tcntl)
+#define pTPERIOD		(&sim_tperiod)
+#define pTSCALE			(&sim_tscale)
+#define pTCOUNT			(&sim_tcount)
+#define pMDMA_S0_CONFIG		(&sim_mdmaS0.config)
+#define pMDMA_S0_START_ADDR	(&sim_mdmaS0.startAddr)
+#define pMDMA_S0_X_COUNT	(&sim_mdmaS0.xCount)
+#define pMDMA_S0_X_MODIFY	(&sim_mdmaS0.xModify)
+#define pMDMA_S0_IRQ_STATUS	(&sim_mdmaS0.irqStatus)
+#define pMDMA_D0_CONFIG		(&sim_mdmaD0.config)
+#define pMDMA_D0_START_ADDR	(&sim_mdmaD0.startAddr)
+#define pMDMA_D0_X_COUNT	(&sim_mdmaD0.xCount)
+#define pMDMA_D0_X_MODIFY	(&sim_mdmaD0.xModify)
+#define pMDMA_D0_IRQ_STATUS	(&sim_mdmaD0.irqStatus)
+
+
+/***************************************************
+            MODEL
+***************************************************/
+
+/** run memory DMA stream 0
+ *   a transfer started since the last call is done in one go
+ *
+ * @return words moved
+ */
+int sim_mdma(void);
+
+#endif
@@ -0,0 +1,23 @@
+/**
+ *@file tll_sport.h
+ *
+ *@brief
+ *  - host stand-in for the SPORT macros of the board library: SPORT0
+ *    is a model in simHw.c, fed from and recorded to WAV files
+ *
+ *******************************************************************************/
+#ifndef _TLL_SPORT_H_
+#define _TLL_SPORT_H_
+
+/** SPORT0 directions enabled, SIM_SPORT_xx bits */
+extern volatile unsigned int sim_sport0;
+
+#define SIM_SPORT_RX	(0x1)
+#define SIM_SPORT_TX	(0x2)
+
+#define ENABLE_SPORT0_RX()	(sim_sport0 |= SIM_SPORT_RX)
+#define ENABLE_SPORT0_TX()	(sim_sport0 |= SIM_SPORT_TX)
+#define DISABLE_SPORT0_RX()	(sim_sport0 &= ~SIM_SPORT_RX)
+#define DISABLE_SPORT0_TX()	(sim_sport0 &= ~SIM_SPORT_TX)
+
+#endif
@@ -0,0 +1,25 @@
+/**
+ *@file tll_common.h
+ *
+ *@brief
+ *  - host stand-in for the board library header, for the target
+ *    sources the host tools are built with
+ *
+ *******************************************************************************/
+#ifndef _TLL_COMMON_H_
+#define _TLL_COMMON_H_
+
+#include <stdio.h>
+#include <stddef.h>
+
+#define PASS	(0)
+#define FAIL	(-1)
+
+#define _1KHZ	(1000)
+
+#if defined(TLL_SIM)
+// the registers, for the sources that take them from here
+#include <tll_config.h>
+#endif
+
+#endif
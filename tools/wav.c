@@ -0,0 +1,132 @@
+/**
+ *@file wav.c
+ *
+ *@brief
+ *  - WAV file in and out for the host tools, see wav.h
+ *
+ *******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tll_common.h"
+#include "wav.h"
+
+/** little endian fields of the header */
+static unsigned int wav_get(const unsigned char *pData, int bytes)
+{
+	unsigned int value = 0;
+
+	while ( 0 < bytes-- ) {
+		value = (value << 8) | pData[bytes];
+	}
+	return value;
+}
+
+
+static void wav_put(unsigned char *pData, unsigned int value, int bytes)
+{
+	int count;
+
+	for ( count = 0; bytes > count; count++ ) {
+		pData[count] = (unsigned char) (value >> (8 * count));
+	}
+}
+
+
+/** read a 16 bit PCM WAV file, the first channel of it */
+short *wav_read(const char *pName, int *pRate, int *pLen)
+{
+	FILE *pFile = fopen(pName, "rb");
+	unsigned char hdr[16];
+	unsigned char *pRaw = NULL;
+	short *pData = NULL;
+	unsigned int size;
+	int channels = 0;
+	int bits = 0;
+	int count;
+
+	if ( NULL == pFile ) {
+		perror(pName);
+		return NULL;
+	}
+	if ( 12 != fread(hdr, 1, 12, pFile) || 0 != memcmp(hdr, "RIFF", 4) || 0 != memcmp(&hdr[8], "WAVE", 4) ) {
+		fprintf(stderr, "%s: not a WAV file\n", pName);
+		fclose(pFile);
+		return NULL;
+	}
+
+	// walk the chunks up to "data", "fmt " has to come first
+	while ( 8 == fread(hdr, 1, 8, pFile) ) {
+		size = wav_get(&hdr[4], 4);
+		if ( 0 == memcmp(hdr, "fmt ", 4) ) {
+			if ( 16 > size || 16 != fread(hdr, 1, 16, pFile) ) {
+				break;
+			}
+			fseek(pFile, (size - 16) + (size & 1), SEEK_CUR);
+			channels = wav_get(&hdr[2], 2);
+			*pRate   = wav_get(&hdr[4], 4);
+			bits     = wav_get(&hdr[14], 2);
+			if ( 1 != wav_get(hdr, 2) || 16 != bits || 0 == channels ) {
+				fprintf(stderr, "%s: only 16 bit PCM is supported\n", pName);
+				break;
+			}
+		} else if ( 0 == memcmp(hdr, "data", 4) && 0 != channels ) {
+			pRaw  = malloc(size + 2);
+			size  = fread(pRaw, 1, size, pFile);
+			*pLen = size / (2 * channels);
+			pData = calloc(*pLen + 1, sizeof(short));
+			for ( count = 0; *pLen > count; count++ ) {
+				pData[count] = (short) wav_get(&pRaw[2 * channels * count], 2);
+			}
+			free(pRaw);
+			break;
+		} else {
+			fseek(pFile, size + (size & 1), SEEK_CUR);
+		}
+	}
+	fclose(pFile);
+
+	if ( NULL == pData && 16 == bits ) {
+		fprintf(stderr, "%s: no samples\n", pName);
+	}
+	return pData;
+}
+
+
+/** write a mono 16 bit PCM WAV file */
+int wav_write(const char *pName, int rate, const short *pData, int len)
+{
+	FILE *pFile = fopen(pName, "wb");
+	unsigned char hdr[44];
+	unsigned char sample[2];
+	int count;
+
+	if ( NULL == pFile ) {
+		perror(pName);
+		return FAIL;
+	}
+
+	memcpy(hdr, "RIFF", 4);
+	wav_put(&hdr[4], 36 + 2 * len, 4);
+	memcpy(&hdr[8], "WAVEfmt ", 8);
+	wav_put(&hdr[16], 16, 4);
+	wav_put(&hdr[20], 1, 2);
+	wav_put(&hdr[22], 1, 2);
+	wav_put(&hdr[24], rate, 4);
+	wav_put(&hdr[28], 2 * rate, 4);
+	wav_put(&hdr[32], 2, 2);
+	wav_put(&hdr[34], 16, 2);
+	memcpy(&hdr[36], "data", 4);
+	wav_put(&hdr[40], 2 * len, 4);
+	fwrite(hdr, 1, sizeof(hdr), pFile);
+
+	for ( count = 0; len > count; count++ ) {
+		wav_put(sample, (unsigned short) pData[count], 2);
+		fwrite(sample, 1, 2, pFile);
+	}
+	if ( 0 != fclose(pFile) ) {
+		perror(pName);
+		return FAIL;
+	}
+	return PASS;
+}
@@ -0,0 +1,37 @@
+/**
+ *@file wav.h
+ *
+ *@brief
+ *  - WAV file in and out for the host tools: 16 bit PCM only
+ *
+ *  A file with more than one channel is read as its first channel.
+ *
+ *******************************************************************************/
+#ifndef _WAV_H_
+#define _WAV_H_
+
+/** read a 16 bit PCM WAV file
+ *
+ * Parameters:
+ * @param pName  file name
+ * @param pRate  set to the sample rate
+ * @param pLen  set to the number of samples (of the first channel)
+ *
+ * @return the samples, to free(), NULL on failure (reported on stderr)
+ */
+short *wav_read(const char *pName, int *pRate, int *pLen);
+
+/** write a mono 16 bit PCM WAV file
+ *
+ * Parameters:
+ * @param pName  file name
+ * @param rate  sample rate
+ * @param pData  samples
+ * @param len  number of samples
+ *
+ * @return Zero on success.
+ * Negative value on failure (reported on stderr).
+ */
+int wav_write(const char *pName, int rate, const short *pData, int len);
+
+#endif